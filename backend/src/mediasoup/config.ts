@@ -1,6 +1,10 @@
+import os from 'os';
 import { types as mediasoupTypes } from 'mediasoup';
 
 export const mediasoupConfig = {
+  // One worker per core unless overridden; each worker runs in its own process
+  numWorkers: parseInt(process.env.MEDIASOUP_NUM_WORKERS || '', 10) || os.cpus().length,
+
   worker: {
     rtcMinPort: 10000,
     rtcMaxPort: 10100,
@@ -59,7 +63,16 @@ export const mediasoupConfig = {
           'level-asymmetry-allowed': 1,
           'x-google-start-bitrate': 1000
         }
-      }
+      },
+      // Forward error correction for the NDI bridge's native receiver. Off by
+      // default: the mediasoup build must list these in its supported capabilities.
+      ...(process.env.MEDIASOUP_ENABLE_FEC === 'true'
+        ? [
+            { kind: 'video' as const, mimeType: 'video/red', clockRate: 90000 },
+            { kind: 'video' as const, mimeType: 'video/ulpfec', clockRate: 90000 },
+            { kind: 'video' as const, mimeType: 'video/flexfec-03', clockRate: 90000, parameters: { 'repair-window': 10000000 } }
+          ]
+        : [])
     ]
   },
 
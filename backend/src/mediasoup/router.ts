@@ -5,6 +5,7 @@ import { mediasoupConfig } from './config';
 export interface StreamInfo {
   id: string;
   producerId: string;
+  audioProducerId?: string;
   clientId: string;
   deviceId?: string;
   deviceName: string;
@@ -24,9 +25,21 @@ export interface StreamInfo {
   };
 }
 
+interface WorkerEntry {
+  index: number;
+  worker: mediasoupTypes.Worker;
+  router: mediasoupTypes.Router;
+  producerCount: number;
+  consumerCount: number;
+}
+
 export class MediasoupRouter {
-  private worker: mediasoupTypes.Worker | null = null;
+  private workers: WorkerEntry[] = [];
+  // Router of the first worker; all routers share the same codecs and capabilities
   private router: mediasoupTypes.Router | null = null;
+  private producerWorkers: Map<string, WorkerEntry> = new Map();
+  private producerTransports: Map<string, mediasoupTypes.WebRtcTransport> = new Map();
+  private pipedProducers: Map<string, Promise<void>> = new Map();
   public transports: Map<string, mediasoupTypes.WebRtcTransport | mediasoupTypes.PlainTransport> = new Map();
   private producers: Map<string, mediasoupTypes.Producer> = new Map();
   private consumers: Map<string, mediasoupTypes.Consumer> = new Map();
@@ -37,33 +50,93 @@ export class MediasoupRouter {
     producerId: string;
     createdAt: Date;
   }> = new Map();
+  // Program return feed published by the NDI bridge for the phones to watch
+  private returnFeed: {
+    transport: mediasoupTypes.PlainTransport;
+    producer: mediasoupTypes.Producer;
+    ownerId: string;
+  } | null = null;
 
   async initialize(): Promise<void> {
     try {
-      this.worker = await mediasoup.createWorker({
-        ...mediasoupConfig.worker,
-        appData: { roomId: 'main-room' }
-      });
+      for (let index = 0; index < mediasoupConfig.numWorkers; index++) {
+        const worker = await mediasoup.createWorker({
+          ...mediasoupConfig.worker,
+          appData: { roomId: 'main-room', workerIndex: index }
+        });
 
-      this.router = await this.worker.createRouter({
-        mediaCodecs: mediasoupConfig.router.mediaCodecs
-      });
+        worker.on('died', (error) => {
+          console.error(`❌ Mediasoup worker ${index} (pid ${worker.pid}) died:`, error);
+        });
+
+        const router = await worker.createRouter({
+          mediaCodecs: mediasoupConfig.router.mediaCodecs
+        });
 
-      console.log('✅ Mediasoup router initialized');
+        this.workers.push({ index, worker, router, producerCount: 0, consumerCount: 0 });
+      }
+
+      this.router = this.workers[0].router;
+
+      console.log(`✅ Mediasoup router initialized with ${this.workers.length} worker(s)`);
     } catch (error) {
       console.error('❌ Failed to initialize Mediasoup router:', error);
       throw error;
     }
   }
 
+  // Phones' transports go to the worker with the fewest producers
+  private leastProducersWorker(): WorkerEntry {
+    return this.workers.reduce((best, entry) =>
+      entry.producerCount < best.producerCount ? entry : best
+    );
+  }
+
+  // NDI bridge PlainTransports go to the worker with the fewest consumers
+  private leastConsumersWorker(): WorkerEntry {
+    return this.workers.reduce((best, entry) =>
+      entry.consumerCount < best.consumerCount ? entry : best
+    );
+  }
+
+  private workerForTransport(transport: mediasoupTypes.Transport): WorkerEntry {
+    const index = (transport.appData?.workerIndex as number) ?? 0;
+    return this.workers[index] ?? this.workers[0];
+  }
+
+  // Make a producer living on another worker available on the target router
+  private async ensureProducerOnWorker(producerId: string, target: WorkerEntry): Promise<void> {
+    const source = this.producerWorkers.get(producerId);
+    if (!source || source === target) {
+      return;
+    }
+
+    const key = `${producerId}:${target.index}`;
+    let piped = this.pipedProducers.get(key);
+    if (!piped) {
+      piped = source.router
+        .pipeToRouter({ producerId, router: target.router })
+        .then(() => {
+          console.log(`🔗 Piped producer ${producerId}: worker ${source.index} -> worker ${target.index}`);
+        })
+        .catch((error) => {
+          this.pipedProducers.delete(key);
+          throw error;
+        });
+      this.pipedProducers.set(key, piped);
+    }
+    await piped;
+  }
+
   async createWebRtcTransport(): Promise<mediasoupTypes.WebRtcTransport> {
     if (!this.router) {
       throw new Error('Router not initialized');
     }
 
-    const transport = await this.router.createWebRtcTransport({
+    const entry = this.leastProducersWorker();
+    const transport = await entry.router.createWebRtcTransport({
       ...mediasoupConfig.webRtcTransport,
-      appData: { clientId: `client-${Date.now()}` }
+      appData: { clientId: `client-${Date.now()}`, workerIndex: entry.index }
     });
 
     this.transports.set(transport.id, transport);
@@ -73,7 +146,12 @@ export class MediasoupRouter {
 
 
 
-  async createProducer(transportId: string, kind: 'audio' | 'video', rtpParameters: any): Promise<mediasoupTypes.Producer> {
+  async createProducer(
+    transportId: string,
+    kind: 'audio' | 'video',
+    rtpParameters: any,
+    source?: { width?: number; height?: number; frameRate?: number }
+  ): Promise<mediasoupTypes.Producer> {
     if (!this.router) {
       throw new Error('Router not initialized');
     }
@@ -85,6 +163,10 @@ export class MediasoupRouter {
 
     // Use transport.appData.clientId as stable identifier (we set it to deviceId upstream)
     const clientId = (transport.appData?.clientId as string) || transport.id;
+    // Capture size reported by the phone; simulcast layers are scaled from it
+    const sourceWidth = source?.width || 1280;
+    const sourceHeight = source?.height || 720;
+    const sourceFps = Math.round(source?.frameRate || 30);
     
     const producer = await transport.produce({
       kind,
@@ -94,22 +176,41 @@ export class MediasoupRouter {
 
     this.producers.set(producer.id, producer);
 
+    const entry = this.workerForTransport(transport);
+    entry.producerCount++;
+    this.producerWorkers.set(producer.id, entry);
+    this.producerTransports.set(producer.id, transport as mediasoupTypes.WebRtcTransport);
+    producer.observer.once('close', () => {
+      entry.producerCount--;
+      this.producerWorkers.delete(producer.id);
+      this.producerTransports.delete(producer.id);
+      for (const key of Array.from(this.pipedProducers.keys())) {
+        if (key.startsWith(`${producer.id}:`)) {
+          this.pipedProducers.delete(key);
+        }
+      }
+    });
+
     // Create stream metadata for video producers
     if (kind === 'video') {
       // Check if we already have a stream for this client
       let existingStream = Array.from(this.streamMetadata.values()).find(s => s.clientId === clientId);
       
       if (existingStream) {
-        // Update existing stream with new producer
+        // Update existing stream with new producer; an audio-only phone turning
+        // its camera on becomes a regular video stream keeping its audio
         existingStream.producerId = producer.id;
+        existingStream.kind = 'video';
         existingStream.connectedAt = new Date(); // Update connection time
+        existingStream.resolution = { width: sourceWidth, height: sourceHeight };
+        existingStream.fps = sourceFps;
         
         // Extract resolution from RTP parameters if available
         if (rtpParameters.encodings && rtpParameters.encodings[0]) {
           const encoding = rtpParameters.encodings[0];
           if (encoding.scaleResolutionDownBy) {
-            existingStream.resolution.width = Math.floor(1280 / encoding.scaleResolutionDownBy);
-            existingStream.resolution.height = Math.floor(720 / encoding.scaleResolutionDownBy);
+            existingStream.resolution.width = Math.floor(sourceWidth / encoding.scaleResolutionDownBy);
+            existingStream.resolution.height = Math.floor(sourceHeight / encoding.scaleResolutionDownBy);
           }
           if (encoding.maxBitrate) {
             existingStream.bitrate = encoding.maxBitrate;
@@ -122,7 +223,7 @@ export class MediasoupRouter {
           existingStream.stats.packetsLost = 0;
           existingStream.stats.rtt = 0;
           existingStream.stats.jitter = 0;
-          existingStream.stats.frameRate = 30;
+          existingStream.stats.frameRate = sourceFps;
         }
         
         console.log(`🔄 Updated existing stream for client ${clientId}`);
@@ -135,18 +236,18 @@ export class MediasoupRouter {
           clientId: clientId,
           deviceId: clientId,
           deviceName: `Device ${clientId.slice(-4)}`,
-          resolution: { width: 1280, height: 720 }, // Default, will be updated from RTP parameters
+          resolution: { width: sourceWidth, height: sourceHeight }, // Scaled below by the top encoding
           bitrate: 1000000, // Default 1Mbps
           connectedAt: new Date(),
           createdAt: new Date(),
-          fps: 30,
+          fps: sourceFps,
           kind: kind,
           stats: {
             bitrate: 0,
             packetsLost: 0,
             rtt: 0,
             jitter: 0,
-            frameRate: 30
+            frameRate: sourceFps
           }
         };
 
@@ -154,8 +255,8 @@ export class MediasoupRouter {
         if (rtpParameters.encodings && rtpParameters.encodings[0]) {
           const encoding = rtpParameters.encodings[0];
           if (encoding.scaleResolutionDownBy) {
-            streamInfo.resolution.width = Math.floor(1280 / encoding.scaleResolutionDownBy);
-            streamInfo.resolution.height = Math.floor(720 / encoding.scaleResolutionDownBy);
+            streamInfo.resolution.width = Math.floor(sourceWidth / encoding.scaleResolutionDownBy);
+            streamInfo.resolution.height = Math.floor(sourceHeight / encoding.scaleResolutionDownBy);
           }
           if (encoding.maxBitrate) {
             streamInfo.bitrate = encoding.maxBitrate;
@@ -165,6 +266,30 @@ export class MediasoupRouter {
         this.streamMetadata.set(streamId, streamInfo);
         console.log(`🆕 Created new stream for client ${clientId}`);
       }
+    } else {
+      // Audio rides along with the client's video stream into the same NDI source
+      const stream = Array.from(this.streamMetadata.values()).find(s => s.clientId === clientId);
+      if (stream) {
+        stream.audioProducerId = producer.id;
+      } else {
+        // Phone used only as a wireless mic: an audio-only stream
+        const streamId = `stream-${clientId}-${Date.now()}`;
+        this.streamMetadata.set(streamId, {
+          id: streamId,
+          producerId: producer.id,
+          audioProducerId: producer.id,
+          clientId: clientId,
+          deviceId: clientId,
+          deviceName: `Device ${clientId.slice(-4)}`,
+          resolution: { width: 0, height: 0 },
+          bitrate: rtpParameters.encodings?.[0]?.maxBitrate || 64000,
+          connectedAt: new Date(),
+          createdAt: new Date(),
+          fps: 0,
+          kind: 'audio'
+        });
+        console.log(`🎙️ Created audio-only stream for client ${clientId}`);
+      }
     }
 
     return producer;
@@ -182,6 +307,9 @@ export class MediasoupRouter {
 
     // Handle both WebRTC and Plain transports
     if ('consume' in transport) {
+      const entry = this.workerForTransport(transport);
+      await this.ensureProducerOnWorker(producerId, entry);
+
       const consumer = await transport.consume({
         producerId,
         rtpCapabilities,
@@ -189,12 +317,42 @@ export class MediasoupRouter {
         appData: { clientId: transport.appData?.clientId || 'ndi-bridge' }
       });
       this.consumers.set(consumer.id, consumer);
+
+      entry.consumerCount++;
+      consumer.observer.once('close', () => {
+        entry.consumerCount--;
+        this.consumers.delete(consumer.id);
+      });
       return consumer;
     } else {
       throw new Error('Transport does not support consumption');
     }
   }
 
+  async setConsumerPreferredLayers(consumerId: string, spatialLayer: number, temporalLayer?: number): Promise<boolean> {
+    const consumer = this.consumers.get(consumerId);
+    if (!consumer || (consumer.type !== 'simulcast' && consumer.type !== 'svc')) {
+      return false;
+    }
+
+    await consumer.setPreferredLayers({ spatialLayer, temporalLayer });
+    return true;
+  }
+
+  // Cap what a phone may send, from the NDI bridge's receiver estimate.
+  // Never raises the cap above the configured transport maximum.
+  async setProducerMaxBitrate(producerId: string, bitrate: number): Promise<number | null> {
+    const transport = this.producerTransports.get(producerId);
+    if (!transport || transport.closed) {
+      return null;
+    }
+
+    const maxBitrate = mediasoupConfig.webRtcTransport.maxIncomingBitrate;
+    const applied = Math.max(100000, Math.min(maxBitrate, Math.floor(bitrate)));
+    await transport.setMaxIncomingBitrate(applied);
+    return applied;
+  }
+
   getRouterCapabilities() {
     if (!this.router) {
       throw new Error('Router not initialized');
@@ -217,10 +375,12 @@ export class MediasoupRouter {
   }): Promise<mediasoupTypes.PlainTransport> {
     if (!this.router) throw new Error('Router not initialized');
     
-    const transport = await this.router.createPlainTransport({
+    const entry = this.leastConsumersWorker();
+    const transport = await entry.router.createPlainTransport({
       listenIp: options.listenIp,
       rtcpMux: options.rtcpMux ?? true,
-      comedia: options.comedia ?? true
+      comedia: options.comedia ?? true,
+      appData: { workerIndex: entry.index }
     });
     
     this.transports.set(transport.id, transport);
@@ -237,14 +397,17 @@ export class MediasoupRouter {
   }> {
     if (!this.router) throw new Error('Router not initialized');
     
+    // Bridge consumers are balanced by consumer count; the producer is piped
+    // over from its own worker when the consumer is created
     const config = mediasoupConfig.plainTransport;
-    const transport = await this.router.createPlainTransport({
+    const entry = this.leastConsumersWorker();
+    const transport = await entry.router.createPlainTransport({
       listenIp: config.listenIp,
       rtcpMux: config.rtcpMux,
       comedia: config.comedia,
       enableSrtp: config.enableSrtp,
       enableSctp: config.enableSctp,
-      appData: { streamId, producerId, type: 'ndi-bridge' }
+      appData: { streamId, producerId, type: 'ndi-bridge', workerIndex: entry.index }
     });
     
     // Store transport mapping
@@ -274,6 +437,101 @@ export class MediasoupRouter {
     };
   }
 
+  // The NDI bridge sends encoded program video to a comedia PlainTransport;
+  // it is not a camera, so it gets no stream metadata and is never forwarded to NDI
+  async createReturnFeedProducer(options: {
+    codec: 'VP8' | 'H264';
+    payloadType: number;
+    ssrc: number;
+    ownerId: string;
+  }): Promise<{
+    producer: mediasoupTypes.Producer;
+    tuple: { ip: string; port: number };
+  }> {
+    if (!this.router) throw new Error('Router not initialized');
+
+    this.closeReturnFeed();
+
+    const config = mediasoupConfig.plainTransport;
+    const entry = this.leastProducersWorker();
+    const transport = await entry.router.createPlainTransport({
+      listenIp: config.listenIp,
+      rtcpMux: true,
+      comedia: true,
+      enableSrtp: false,
+      enableSctp: false,
+      appData: { type: 'return-feed', workerIndex: entry.index }
+    });
+
+    const codec = options.codec === 'H264'
+      ? {
+          mimeType: 'video/H264',
+          parameters: { 'packetization-mode': 1, 'profile-level-id': '4d0032', 'level-asymmetry-allowed': 1 }
+        }
+      : { mimeType: 'video/VP8', parameters: {} };
+
+    let producer: mediasoupTypes.Producer;
+    try {
+      producer = await transport.produce({
+        kind: 'video',
+        rtpParameters: {
+          codecs: [{
+            ...codec,
+            payloadType: options.payloadType,
+            clockRate: 90000,
+            // The bridge answers keyframe requests but keeps no retransmission buffer
+            rtcpFeedback: [{ type: 'nack', parameter: 'pli' }, { type: 'ccm', parameter: 'fir' }]
+          }],
+          encodings: [{ ssrc: options.ssrc }]
+        },
+        appData: { clientId: 'return-feed' }
+      });
+    } catch (error) {
+      transport.close();
+      throw error;
+    }
+
+    this.transports.set(transport.id, transport);
+    this.producers.set(producer.id, producer);
+    entry.producerCount++;
+    this.producerWorkers.set(producer.id, entry);
+    producer.observer.once('close', () => {
+      entry.producerCount--;
+      this.producers.delete(producer.id);
+      this.producerWorkers.delete(producer.id);
+      this.transports.delete(transport.id);
+      for (const key of Array.from(this.pipedProducers.keys())) {
+        if (key.startsWith(`${producer.id}:`)) {
+          this.pipedProducers.delete(key);
+        }
+      }
+      if (this.returnFeed?.producer === producer) {
+        this.returnFeed = null;
+      }
+    });
+
+    this.returnFeed = { transport, producer, ownerId: options.ownerId };
+    return {
+      producer,
+      tuple: { ip: transport.tuple.localIp, port: transport.tuple.localPort }
+    };
+  }
+
+  getReturnFeedProducerId(): string | null {
+    return this.returnFeed?.producer.id ?? null;
+  }
+
+  // Close the return feed; with ownerId only if that bridge connection published it
+  closeReturnFeed(ownerId?: string): boolean {
+    const feed = this.returnFeed;
+    if (!feed || (ownerId !== undefined && feed.ownerId !== ownerId)) {
+      return false;
+    }
+    this.returnFeed = null;
+    feed.transport.close();
+    return true;
+  }
+
   // Stream management methods
   getActiveStreams(): StreamInfo[] {
     return Array.from(this.streamMetadata.values());
@@ -330,6 +588,13 @@ export class MediasoupRouter {
 
   // Method to handle producer close events (when devices disconnect)
   handleProducerClosed(producerId: string): void {
+    const audioOf = Array.from(this.streamMetadata.values()).find(s => s.audioProducerId === producerId);
+    if (audioOf && audioOf.kind !== 'audio') {
+      audioOf.audioProducerId = undefined;
+      this.producers.delete(producerId);
+      return;
+    }
+
     const stream = Array.from(this.streamMetadata.values()).find(s => s.producerId === producerId);
     if (stream) {
       console.log(`🔌 Stream disconnected: ${stream.id} (client: ${stream.clientId})`);
@@ -357,13 +622,25 @@ export class MediasoupRouter {
     return false;
   }
 
+  getWorkerStats() {
+    return this.workers.map(entry => ({
+      index: entry.index,
+      pid: entry.worker.pid,
+      closed: entry.worker.closed,
+      producers: entry.producerCount,
+      consumers: entry.consumerCount
+    }));
+  }
+
   // PlainTransport management methods
   getPlainTransports() {
     return Array.from(this.plainTransports.values());
   }
 
   getStreamByProducerId(producerId: string): StreamInfo | undefined {
-    return Array.from(this.streamMetadata.values()).find(s => s.producerId === producerId);
+    return Array.from(this.streamMetadata.values()).find(
+      s => s.producerId === producerId || s.audioProducerId === producerId
+    );
   }
 
   async closePlainTransportForProducer(producerId: string): Promise<boolean> {
@@ -385,11 +662,14 @@ export class MediasoupRouter {
   }
 
   async close(): Promise<void> {
-    if (this.worker) {
-      this.worker.close();
-      this.worker = null;
+    this.returnFeed = null;
+    for (const entry of this.workers) {
+      entry.worker.close();
     }
+    this.workers = [];
     this.router = null;
+    this.producerWorkers.clear();
+    this.pipedProducers.clear();
     this.transports.clear();
     this.producers.clear();
     this.consumers.clear();
@@ -163,6 +163,16 @@ app.get('/api/plain-transports', (req, res) => {
   }
 });
 
+// Mediasoup worker load
+app.get('/api/mediasoup-workers', (req, res) => {
+  try {
+    const workers = mediasoupRouter.getWorkerStats();
+    res.json({ count: workers.length, workers });
+  } catch (error) {
+    res.status(500).json({ error: 'Failed to get mediasoup workers' });
+  }
+});
+
 // In-memory device registry
 type DeviceInfo = {
   deviceId: string;
@@ -220,9 +230,11 @@ io.on('connection', (socket) => {
   socket.on('create-transport', async (data, callback) => {
     try {
       const transport = await mediasoupRouter.createWebRtcTransport();
-      // Attach deviceId (if provided) to transport appData via server-side map from socket
+      // Attach deviceId (if provided) to transport appData via server-side map from socket.
+      // Receive transports (return feed) keep their own id, so stream cleanup,
+      // which looks transports up by device, only finds the send transport
       const deviceEntry = Array.from(devices.values()).find(d => d.socketId === socket.id);
-      if (deviceEntry) {
+      if (deviceEntry && data?.direction !== 'recv') {
         (transport as any).appData = { ...(transport as any).appData, clientId: deviceEntry.deviceId };
       }
       callback({
@@ -255,7 +267,8 @@ io.on('connection', (socket) => {
       const producer = await mediasoupRouter.createProducer(
         data.transportId,
         data.kind,
-        data.rtpParameters
+        data.rtpParameters,
+        data.appData?.source
       );
       
       callback({
@@ -284,6 +297,15 @@ io.on('connection', (socket) => {
           io.emit('stream-started', { stream: { ...stream, deviceId } });
           console.log(`📡 Stream started for client ${stream.clientId}`);
         }
+      } else {
+        const stream = mediasoupRouter.getStreamByProducerId(producer.id);
+        if (stream && stream.kind === 'audio') {
+          io.emit('stream-started', { stream: { ...stream, deviceId: stream.deviceId || stream.clientId } });
+          console.log(`🎙️ Audio-only stream started for client ${stream.clientId}`);
+        } else if (stream) {
+          io.emit('stream-audio-added', { streamId: stream.id, audioProducerId: producer.id });
+          console.log(`🎙️ Audio added to stream ${stream.id}`);
+        }
       }
 
       // Listen for producer transport close events (when devices disconnect)
@@ -393,6 +415,7 @@ io.on('connection', (socket) => {
       const streamList = streams.map(stream => ({
         id: stream.id,
         producer_id: stream.producerId,
+        audio_producer_id: stream.audioProducerId,
         device_name: stream.deviceName || stream.clientId,
         resolution: stream.resolution || { width: 1280, height: 720 },
         fps: stream.fps || 30,
@@ -450,6 +473,12 @@ io.on('connection', (socket) => {
           protocol: 'udp'
         },
         rtp_parameters: consumer.rtpParameters,
+        consumer_type: consumer.type,
+        producer_encodings: producer.rtpParameters.encodings?.map(encoding => ({
+          scaleResolutionDownBy: encoding.scaleResolutionDownBy,
+          maxBitrate: encoding.maxBitrate,
+          scalabilityMode: encoding.scalabilityMode
+        })) || [],
         stream_metadata: {
           width: streamInfo?.resolution.width || 1280,
           height: streamInfo?.resolution.height || 720,
@@ -466,9 +495,95 @@ io.on('connection', (socket) => {
     }
   });
 
+  socket.on('ndi-bridge-set-preferred-layers', async (data, callback) => {
+    try {
+      const { consumer_id, spatial_layer, temporal_layer } = data;
+      const success = await mediasoupRouter.setConsumerPreferredLayers(consumer_id, spatial_layer, temporal_layer);
+
+      if (!success) {
+        return callback({ success: false, error: `Consumer ${consumer_id} not found or has no layers` });
+      }
+
+      callback({ success: true });
+    } catch (error) {
+      console.error('❌ Error setting preferred layers:', error);
+      callback({ success: false, error: error instanceof Error ? error.message : 'Unknown error' });
+    }
+  });
+
+  socket.on('ndi-bridge-bitrate-feedback', async (data, callback) => {
+    try {
+      const { producer_id, bitrate } = data;
+      const applied = await mediasoupRouter.setProducerMaxBitrate(producer_id, Number(bitrate));
+
+      if (applied === null) {
+        return callback({ success: false, error: `Producer ${producer_id} not found` });
+      }
+
+      callback({ success: true, bitrate: applied });
+    } catch (error) {
+      console.error('❌ Error applying bitrate feedback:', error);
+      callback({ success: false, error: error instanceof Error ? error.message : 'Unknown error' });
+    }
+  });
+
+  // Program return feed: the bridge publishes, phones consume it as a confidence monitor
+  socket.on('ndi-bridge-return-feed', async (data, callback) => {
+    try {
+      const { codec, payload_type, ssrc } = data;
+      const { producer, tuple } = await mediasoupRouter.createReturnFeedProducer({
+        codec: codec === 'H264' ? 'H264' : 'VP8',
+        payloadType: Number(payload_type),
+        ssrc: Number(ssrc),
+        ownerId: socket.id
+      });
+
+      callback({
+        success: true,
+        producer_id: producer.id,
+        transport: { ip: tuple.ip, port: tuple.port, protocol: 'udp' }
+      });
+
+      io.emit('return-feed-available', { producerId: producer.id });
+      console.log(`📺 Return feed published: ${tuple.ip}:${tuple.port} (${codec})`);
+    } catch (error) {
+      console.error('❌ Error creating return feed:', error);
+      callback({ success: false, error: error instanceof Error ? error.message : 'Unknown error' });
+    }
+  });
+
+  socket.on('get-return-feed', (data, callback) => {
+    callback?.({ producerId: mediasoupRouter.getReturnFeedProducerId() });
+  });
+
+  socket.on('consume-return-feed', async (data, callback) => {
+    try {
+      const producerId = mediasoupRouter.getReturnFeedProducerId();
+      if (!producerId) {
+        return callback({ error: 'No return feed' });
+      }
+
+      const consumer = await mediasoupRouter.createConsumer(data.transportId, producerId, data.rtpCapabilities);
+      callback({
+        id: consumer.id,
+        producerId,
+        kind: consumer.kind,
+        rtpParameters: consumer.rtpParameters
+      });
+    } catch (error) {
+      console.error('❌ Error consuming return feed:', error);
+      callback({ error: 'Failed to consume return feed' });
+    }
+  });
+
   socket.on('disconnect', () => {
     console.log('🔌 Client disconnected:', socket.id);
 
+    if (mediasoupRouter.closeReturnFeed(socket.id)) {
+      io.emit('return-feed-ended', {});
+      console.log('📺 Return feed closed with its bridge connection');
+    }
+
     // Mark device disconnected and schedule removal in 30s if not streaming
     const deviceEntry = Array.from(devices.values()).find(d => d.socketId === socket.id);
     if (deviceEntry) {
@@ -7,6 +7,7 @@ import CameraPreview from '../../components/CameraPreview';
 import ConnectionStatus from '../../components/ConnectionStatus';
 import StreamControls from '../../components/StreamControls';
 import QualityIndicator from '../../components/QualityIndicator';
+import ReturnFeedMonitor from '../../components/ReturnFeedMonitor';
 
 export default function StreamPage() {
   const {
@@ -14,6 +15,7 @@ export default function StreamPage() {
     isStreaming,
     currentStream,
     streamStats,
+    returnFeed,
     selectedQualityPreset,
     showControls,
     isFullscreen,
@@ -188,6 +190,12 @@ export default function StreamPage() {
           className="w-full h-full"
         />
 
+        {/* Program return feed */}
+        <ReturnFeedMonitor
+          stream={returnFeed}
+          className="absolute bottom-4 left-4"
+        />
+
         {/* Fullscreen Status Overlay */}
         {isFullscreen && (
           <div className="absolute top-4 left-4 right-4 flex justify-between items-start">
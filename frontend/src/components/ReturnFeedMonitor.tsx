@@ -0,0 +1,38 @@
+'use client';
+
+import { useEffect, useRef } from 'react';
+
+interface ReturnFeedMonitorProps {
+  stream: MediaStream | null;
+  className?: string;
+}
+
+// Picture-in-picture of the program output sent back by the NDI bridge
+export default function ReturnFeedMonitor({ stream, className = '' }: ReturnFeedMonitorProps) {
+  const videoRef = useRef<HTMLVideoElement>(null);
+
+  useEffect(() => {
+    if (videoRef.current) {
+      videoRef.current.srcObject = stream;
+    }
+  }, [stream]);
+
+  if (!stream) {
+    return null;
+  }
+
+  return (
+    <div className={`relative w-40 aspect-video bg-black rounded-lg overflow-hidden shadow-lg border border-gray-700 ${className}`}>
+      <video
+        ref={videoRef}
+        autoPlay
+        playsInline
+        muted
+        className="w-full h-full object-contain"
+      />
+      <span className="absolute top-1 left-1 bg-red-600 text-white text-[10px] font-bold px-1 rounded">
+        PGM
+      </span>
+    </div>
+  );
+}
@@ -35,7 +35,8 @@ export class CameraService {
     { name: 'Low', width: 640, height: 480, frameRate: 15, bitrate: 200000 },
     { name: 'Medium', width: 1280, height: 720, frameRate: 24, bitrate: 500000 },
     { name: 'High', width: 1920, height: 1080, frameRate: 30, bitrate: 1000000 },
-    { name: 'Ultra', width: 3840, height: 2160, frameRate: 30, bitrate: 2000000 }
+    { name: 'Ultra', width: 3840, height: 2160, frameRate: 30, bitrate: 2000000 },
+    { name: 'Ultra 60', width: 3840, height: 2160, frameRate: 60, bitrate: 20000000 }
   ];
 
   constructor() {
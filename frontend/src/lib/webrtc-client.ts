@@ -3,6 +3,7 @@ import { io, Socket } from 'socket.io-client';
 
 type Transport = types.Transport;
 type Producer = types.Producer;
+type Consumer = types.Consumer;
 
 export interface WebRTCClientConfig {
   serverUrl: string;
@@ -23,6 +24,8 @@ export class WebRTCClient {
   private sendTransport: Transport | null = null;
   private videoProducer: Producer | null = null;
   private audioProducer: Producer | null = null;
+  private recvTransport: Transport | null = null;
+  private returnFeedConsumer: Consumer | null = null;
   private config: WebRTCClientConfig;
   private isConnected = false;
   private isStreaming = false;
@@ -32,6 +35,8 @@ export class WebRTCClient {
   public onStreamingStateChange?: (streaming: boolean) => void;
   public onStatsUpdate?: (stats: StreamStats) => void;
   public onError?: (error: Error) => void;
+  // Program output sent back by the NDI bridge, null when it goes away
+  public onReturnFeed?: (stream: MediaStream | null) => void;
 
   constructor(config: WebRTCClientConfig) {
     this.config = config;
@@ -88,6 +93,11 @@ export class WebRTCClient {
       this.isConnected = true;
       (window as any).debugLogger?.addLog('success', '✅ WebRTC Client connected successfully');
       this.onConnectionStateChange?.('connected');
+
+      // A return feed that is already running; later ones are announced
+      this.startReturnFeed().catch((error) => {
+        (window as any).debugLogger?.addLog('warn', '⚠️ Return feed unavailable', error.message);
+      });
     } catch (error) {
       const errorMessage = error instanceof Error ? error.message : 'Unknown error';
       (window as any).debugLogger?.addLog('error', '❌ WebRTC Client connection failed', errorMessage);
@@ -100,6 +110,12 @@ export class WebRTCClient {
   async disconnect(): Promise<void> {
     try {
       await this.stopStream();
+      this.stopReturnFeed();
+
+      if (this.recvTransport) {
+        this.recvTransport.close();
+        this.recvTransport = null;
+      }
 
       if (this.sendTransport) {
         this.sendTransport.close();
@@ -130,16 +146,26 @@ export class WebRTCClient {
 
       // Create video producer
       if (videoTrack && this.config.enableVideo) {
+        // Report the real capture size so 4K phones are not assumed to be 720p,
+        // and scale layer bitrates with the pixel rate (1 Mbps at 720p30)
+        const settings = videoTrack.getSettings();
+        const source = {
+          width: settings.width || 1280,
+          height: settings.height || 720,
+          frameRate: settings.frameRate || 30
+        };
+        const scale = Math.max(1, (source.width * source.height * source.frameRate) / (1280 * 720 * 30));
         this.videoProducer = await this.sendTransport.produce({
           track: videoTrack,
           encodings: [
-            { maxBitrate: 1000000, scaleResolutionDownBy: 1 },
-            { maxBitrate: 500000, scaleResolutionDownBy: 2 },
-            { maxBitrate: 200000, scaleResolutionDownBy: 4 }
+            { maxBitrate: Math.round(1000000 * scale), scaleResolutionDownBy: 1 },
+            { maxBitrate: Math.round(500000 * scale), scaleResolutionDownBy: 2 },
+            { maxBitrate: Math.round(200000 * scale), scaleResolutionDownBy: 4 }
           ],
           codecOptions: {
             videoGoogleStartBitrate: 1000
-          }
+          },
+          appData: { source }
         });
 
         this.videoProducer.on('transportclose', () => {
@@ -219,6 +245,85 @@ export class WebRTCClient {
       (window as any).debugLogger?.addLog('error', '❌ Socket error', error.message);
       this.onError?.(error);
     });
+
+    this.socket.on('return-feed-available', () => {
+      if (!this.isConnected) return;
+      this.startReturnFeed().catch((error) => {
+        (window as any).debugLogger?.addLog('warn', '⚠️ Return feed unavailable', error.message);
+      });
+    });
+
+    this.socket.on('return-feed-ended', () => {
+      this.stopReturnFeed();
+    });
+  }
+
+  // Play the bridge's program return feed, if one is published
+  async startReturnFeed(): Promise<void> {
+    if (!this.socket || !this.device || !this.onReturnFeed) return;
+
+    const { producerId } = await this.request('get-return-feed', {});
+    if (!producerId || this.returnFeedConsumer?.producerId === producerId) return;
+    this.stopReturnFeed();
+
+    if (!this.recvTransport) {
+      await this.createRecvTransport();
+    }
+
+    const response = await this.request('consume-return-feed', {
+      transportId: this.recvTransport!.id,
+      rtpCapabilities: this.device.rtpCapabilities
+    });
+
+    this.returnFeedConsumer = await this.recvTransport!.consume({
+      id: response.id,
+      producerId: response.producerId,
+      kind: response.kind,
+      rtpParameters: response.rtpParameters
+    });
+    this.returnFeedConsumer.on('transportclose', () => {
+      this.returnFeedConsumer = null;
+    });
+
+    (window as any).debugLogger?.addLog('success', '📺 Return feed playing');
+    this.onReturnFeed(new MediaStream([this.returnFeedConsumer.track]));
+  }
+
+  private stopReturnFeed(): void {
+    if (this.returnFeedConsumer) {
+      this.returnFeedConsumer.close();
+      this.returnFeedConsumer = null;
+      this.onReturnFeed?.(null);
+    }
+  }
+
+  private request(event: string, data: any): Promise<any> {
+    return new Promise((resolve, reject) => {
+      this.socket!.emit(event, data, (response: any) => {
+        if (response?.error) {
+          reject(new Error(response.error));
+        } else {
+          resolve(response);
+        }
+      });
+    });
+  }
+
+  private async createRecvTransport(): Promise<void> {
+    const response = await this.request('create-transport', { direction: 'recv' });
+
+    this.recvTransport = this.device!.createRecvTransport({
+      id: response.id,
+      iceParameters: response.iceParameters,
+      iceCandidates: response.iceCandidates,
+      dtlsParameters: response.dtlsParameters
+    });
+
+    this.recvTransport.on('connect', ({ dtlsParameters }, callback, errback) => {
+      this.request('connect-transport', { transportId: this.recvTransport!.id, dtlsParameters })
+        .then(() => callback())
+        .catch(errback);
+    });
   }
 
   private async createSendTransport(): Promise<void> {
@@ -258,12 +363,13 @@ export class WebRTCClient {
             }
           });
 
-          this.sendTransport.on('produce', async ({ kind, rtpParameters }, callback, errback) => {
+          this.sendTransport.on('produce', async ({ kind, rtpParameters, appData }, callback, errback) => {
             try {
               this.socket!.emit('produce', {
                 transportId: this.sendTransport!.id,
                 kind,
-                rtpParameters
+                rtpParameters,
+                appData
               }, (response: any) => {
                 if (response.error) {
                   errback(new Error(response.error));
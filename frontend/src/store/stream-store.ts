@@ -14,6 +14,7 @@ export interface StreamState {
   // Stream data
   currentStream: MediaStream | null;
   streamStats: StreamStats | null;
+  returnFeed: MediaStream | null;
   
   // Camera settings
   cameraConstraints: CameraConstraints | null;
@@ -53,6 +54,7 @@ export const useStreamStore = create<StreamState>((set, get) => ({
   cameraService: null,
   currentStream: null,
   streamStats: null,
+  returnFeed: null,
   cameraConstraints: null,
   selectedQualityPreset: CameraService.QUALITY_PRESETS[1], // Medium quality by default
   showControls: true,
@@ -115,6 +117,10 @@ export const useStreamStore = create<StreamState>((set, get) => ({
         set({ error: error.message });
       };
 
+      webrtcClient.onReturnFeed = (returnFeed) => {
+        set({ returnFeed });
+      };
+
       // Set up fullscreen change listener
       const handleFullscreenChange = () => {
         const isCurrentlyFullscreen = !!document.fullscreenElement;
@@ -167,6 +173,7 @@ export const useStreamStore = create<StreamState>((set, get) => ({
         isStreaming: false,
         currentStream: null,
         streamStats: null,
+        returnFeed: null,
         error: null
       });
     } catch (error) {
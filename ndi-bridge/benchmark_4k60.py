@@ -0,0 +1,317 @@
+#!/usr/bin/env python3
+"""
+4K60 Pipeline Benchmark
+
+Pushes a 3840x2160@60 stream through the bridge's stages -- threaded
+H.264 decode to BGR (as the aiortc receiver delivers it), banded BGRA
+conversion on the frame scheduler and asynchronous NDI send -- with the
+stages overlapping as they do in production, and checks that 60 fps is
+sustained with every stage inside its latency budget.
+
+Stages whose dependency is missing are reported as skipped: decode needs
+GStreamer (gi, x264enc, avdec_h264), send needs the NDI SDK (NDIlib). A
+run with a skipped stage proves nothing about the host and exits with
+status 2 (inconclusive) instead of passing.
+
+Environment overrides: BENCH_WIDTH, BENCH_HEIGHT, BENCH_FPS,
+BENCH_SECONDS, BENCH_OUTPUT (e.g. "1920x1080" to also scale).
+"""
+
+import sys
+import os
+import asyncio
+import logging
+import threading
+import time
+from typing import Dict, List, Optional
+
+import numpy as np
+
+# Add the project root to Python path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), 'src'))
+
+from processing.band_pipeline import BandConverter
+from processing.scheduler import DeadlineMissed, get_frame_scheduler
+
+logger = logging.getLogger(__name__)
+logging.basicConfig(level=logging.INFO, format='%(asctime)s - %(levelname)s - %(message)s')
+
+WIDTH = int(os.getenv("BENCH_WIDTH", "3840"))
+HEIGHT = int(os.getenv("BENCH_HEIGHT", "2160"))
+FPS = int(os.getenv("BENCH_FPS", "60"))
+SECONDS = float(os.getenv("BENCH_SECONDS", "10"))
+OUTPUT = os.getenv("BENCH_OUTPUT", "")
+
+FRAME_INTERVAL_MS = 1000.0 / FPS
+# p99 budget per stage; stages overlap, so each only has to fit in one frame
+STAGE_BUDGET_MS = {
+    "decode": FRAME_INTERVAL_MS,
+    "convert": FRAME_INTERVAL_MS * 0.5,
+    "send": FRAME_INTERVAL_MS * 0.5
+}
+END_TO_END_BUDGET_MS = FRAME_INTERVAL_MS * 4
+MIN_FPS_RATIO = 0.99
+
+EXIT_PASSED = 0
+EXIT_FAILED = 1
+EXIT_INCONCLUSIVE = 2
+
+
+class StageTimes:
+    """Latency samples of one stage"""
+
+    def __init__(self, name: str):
+        self.name = name
+        self.samples: List[float] = []
+
+    def add(self, seconds: float):
+        self.samples.append(seconds * 1000.0)
+
+    def percentile(self, q: float) -> float:
+        return float(np.percentile(self.samples, q)) if self.samples else 0.0
+
+
+class GstDecoder:
+    """
+    Threaded H.264 decode through the same elements the receiver uses
+
+    Frame threading delays output by several frames, so packets are pushed
+    and frames pulled on separate threads; latency is measured per PTS.
+    """
+
+    def __init__(self, threads: int):
+        import gi
+        gi.require_version('Gst', '1.0')
+        from gi.repository import Gst
+        Gst.init(None)
+        self.Gst = Gst
+        self.threads = threads
+        self.pushed: Dict[int, float] = {}
+
+    def encode_clip(self, count: int) -> list:
+        """Encode a test clip once, outside the measured path"""
+        Gst = self.Gst
+        pipeline = Gst.parse_launch(
+            f"videotestsrc num-buffers={count} pattern=ball "
+            f"! video/x-raw,width={WIDTH},height={HEIGHT},framerate={FPS}/1 "
+            f"! x264enc tune=zerolatency speed-preset=ultrafast key-int-max={FPS} "
+            f"! video/x-h264,stream-format=byte-stream,alignment=au "
+            f"! appsink name=sink sync=false"
+        )
+        sink = pipeline.get_by_name("sink")
+        pipeline.set_state(Gst.State.PLAYING)
+        packets = []
+        while True:
+            sample = sink.emit("pull-sample")
+            if sample is None:
+                break
+            buffer = sample.get_buffer()
+            packets.append(buffer.extract_dup(0, buffer.get_size()))
+        pipeline.set_state(Gst.State.NULL)
+        return packets
+
+    def start(self):
+        Gst = self.Gst
+        self.pipeline = Gst.parse_launch(
+            f"appsrc name=src format=time caps=video/x-h264,stream-format=byte-stream,alignment=au "
+            f"! h264parse ! avdec_h264 max-threads={self.threads} "
+            f"! videoconvert n-threads={self.threads} ! video/x-raw,format=BGR "
+            f"! appsink name=sink sync=false max-buffers=4"
+        )
+        self.appsrc = self.pipeline.get_by_name("src")
+        self.appsink = self.pipeline.get_by_name("sink")
+        self.pipeline.set_state(Gst.State.PLAYING)
+
+    def push(self, index: int, packet: bytes):
+        buffer = self.Gst.Buffer.new_wrapped(packet)
+        buffer.pts = index * self.Gst.SECOND // FPS
+        self.pushed[buffer.pts] = time.perf_counter()
+        self.appsrc.emit("push-buffer", buffer)
+
+    def pull(self):
+        """Next decoded frame as (BGR array, push time), None at the end"""
+        sample = self.appsink.emit("try-pull-sample", self.Gst.SECOND)
+        if sample is None:
+            return None
+        buffer = sample.get_buffer()
+        structure = sample.get_caps().get_structure(0)
+        width, height = structure.get_value("width"), structure.get_value("height")
+        frame = np.frombuffer(buffer.extract_dup(0, buffer.get_size()), dtype=np.uint8)
+        return frame.reshape(height, width, 3), self.pushed.pop(buffer.pts, time.perf_counter())
+
+    def stop(self):
+        self.appsrc.emit("end-of-stream")
+        self.pipeline.set_state(self.Gst.State.NULL)
+
+
+def synthetic_frames(count: int = 8) -> List[np.ndarray]:
+    """Decoder-shaped BGR frames when GStreamer is not installed"""
+    frames = []
+    y, x = np.mgrid[:HEIGHT, :WIDTH]
+    for index in range(count):
+        frame = np.empty((HEIGHT, WIDTH, 3), dtype=np.uint8)
+        frame[..., 0] = (x + index * 16) & 0xFF
+        frame[..., 1] = (y + index * 8) & 0xFF
+        frame[..., 2] = ((x ^ y) + index) & 0xFF
+        frames.append(frame)
+    return frames
+
+
+def create_sender(width: int, height: int):
+    """Async NDI sender, or None without the SDK"""
+    try:
+        from ndi.sender import NDI_AVAILABLE, NDISender
+    except Exception:
+        return None
+    if not NDI_AVAILABLE:
+        return None
+    return NDISender("Benchmark_4K60", width, height, FPS, clock_video=False, async_send=True)
+
+
+async def run_benchmark() -> int:
+    out_width, out_height = WIDTH, HEIGHT
+    if OUTPUT:
+        out_width, out_height = (int(value) for value in OUTPUT.lower().split("x"))
+
+    frame_count = int(SECONDS * FPS)
+    cpus = os.cpu_count() or 1
+    stages = {name: StageTimes(name) for name in ("decode", "convert", "send", "end_to_end")}
+    skipped = []
+
+    logger.info(f"🎬 {WIDTH}x{HEIGHT}@{FPS} -> {out_width}x{out_height}, {frame_count} frames, {cpus} CPUs")
+
+    # Decode stage
+    decoder: Optional[GstDecoder] = None
+    try:
+        decoder = GstDecoder(threads=cpus)
+        logger.info("Encoding test clip...")
+        packets = decoder.encode_clip(min(frame_count, FPS * 2))
+        decoder.start()
+    except Exception as e:
+        logger.warning(f"⚠️ Decode stage skipped (GStreamer unavailable: {e})")
+        decoder = None
+        skipped.append("decode")
+        frames = synthetic_frames()
+
+    # Send stage
+    sender = create_sender(out_width, out_height)
+    if sender is None or not await sender.initialize():
+        logger.warning("⚠️ Send stage skipped (NDI SDK unavailable)")
+        sender = None
+        skipped.append("send")
+
+    converter = BandConverter(bands=4, scheduler=get_frame_scheduler(cpus))
+    loop = asyncio.get_running_loop()
+    decoded: asyncio.Queue = asyncio.Queue(maxsize=3)
+    converted: asyncio.Queue = asyncio.Queue(maxsize=3)
+    start = time.perf_counter()
+
+    def feed():
+        # Paced source: one frame per interval, like a camera
+        for index in range(frame_count):
+            due = start + index / FPS
+            delay = due - time.perf_counter()
+            if delay > 0:
+                time.sleep(delay)
+            if decoder:
+                decoder.push(index, packets[index % len(packets)])
+            else:
+                asyncio.run_coroutine_threadsafe(
+                    decoded.put((frames[index % len(frames)], time.perf_counter())), loop
+                ).result()
+        if not decoder:
+            asyncio.run_coroutine_threadsafe(decoded.put(None), loop).result()
+
+    def drain_decoder():
+        while True:
+            result = decoder.pull()
+            if result is None:
+                break
+            frame, pushed = result
+            stages["decode"].add(time.perf_counter() - pushed)
+            asyncio.run_coroutine_threadsafe(decoded.put((frame, pushed)), loop).result()
+        asyncio.run_coroutine_threadsafe(decoded.put(None), loop).result()
+
+    async def convert_stage():
+        while (item := await decoded.get()) is not None:
+            frame, origin = item
+            began = time.perf_counter()
+            deadline = time.monotonic() + FRAME_INTERVAL_MS / 1000.0
+            try:
+                output = await converter.convert_async(frame, out_width, out_height, deadline=deadline)
+            except DeadlineMissed:
+                # Dropped like the pipeline would; counts against sustained fps
+                continue
+            if output is frame and "convert" not in skipped:
+                # Passed through unchanged: nothing was measured
+                skipped.append("convert")
+            stages["convert"].add(time.perf_counter() - began)
+            await converted.put((output, origin))
+        await converted.put(None)
+
+    sent = 0
+
+    async def send_stage():
+        nonlocal sent
+        while (item := await converted.get()) is not None:
+            frame, origin = item
+            began = time.perf_counter()
+            if sender:
+                await sender.send_frame(frame)
+                stages["send"].add(time.perf_counter() - began)
+            stages["end_to_end"].add(time.perf_counter() - origin)
+            sent += 1
+
+    threads = [threading.Thread(target=feed, daemon=True)]
+    if decoder:
+        threads.append(threading.Thread(target=drain_decoder, daemon=True))
+    for thread in threads:
+        thread.start()
+
+    await asyncio.gather(convert_stage(), send_stage())
+    elapsed = time.perf_counter() - start
+    if decoder:
+        decoder.stop()
+    if sender:
+        sender.close()
+
+    # Report
+    achieved = sent / elapsed
+    passed = achieved >= FPS * MIN_FPS_RATIO and sent >= frame_count * MIN_FPS_RATIO
+    logger.info(f"Sustained: {achieved:.2f} fps ({sent}/{frame_count} frames in {elapsed:.2f}s)")
+
+    for name, stage in stages.items():
+        if name in skipped:
+            logger.info(f"  {name:<11} skipped")
+            continue
+        budget = STAGE_BUDGET_MS.get(name, END_TO_END_BUDGET_MS)
+        p99 = stage.percentile(99)
+        within = p99 <= budget
+        passed = passed and within
+        logger.info(
+            f"  {'✅' if within else '❌'} {name:<11} p50 {stage.percentile(50):6.2f} ms  "
+            f"p99 {p99:6.2f} ms  max {max(stage.samples, default=0):6.2f} ms  budget {budget:5.2f} ms"
+        )
+
+    scheduler_stats = get_frame_scheduler().get_stats()
+    logger.info(f"Scheduler: {scheduler_stats['dropped_late']} dropped, {scheduler_stats['missed']} missed")
+
+    if not passed:
+        logger.error(f"❌ {WIDTH}x{HEIGHT}@{FPS} not sustained within budget")
+        return EXIT_FAILED
+    if skipped:
+        logger.warning(f"⚠️ {WIDTH}x{HEIGHT}@{FPS} inconclusive: {', '.join(skipped)} not measured")
+        return EXIT_INCONCLUSIVE
+    logger.info(f"✅ {WIDTH}x{HEIGHT}@{FPS} sustained within budget")
+    return EXIT_PASSED
+
+
+def main() -> int:
+    try:
+        return asyncio.run(run_benchmark())
+    except KeyboardInterrupt:
+        return EXIT_FAILED
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -5,11 +5,15 @@
 #include <cmath>
 #include <vector>
 #include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
 #include <curl/curl.h>
 #include <json/json.h>
 
 // Include NDI SDK headers
 #include "Processing.NDI.Lib.h"
+#include "glyph_atlas.h"
 
 class RealMobileCameraConnector {
 private:
@@ -170,7 +174,22 @@ public:
         std::cout << "📱 This should show your ACTUAL mobile camera feed!" << std::endl;
         std::cout << "Press Ctrl+C to stop" << std::endl;
         
+        // Status slate: glyphs are pre-rasterized once and only changed cells are redrawn
+        GlyphAtlas atlas(3, 255, 255, 255, 32, 32, 32);
+        const size_t columns = 24;
+        const bool burn_in = std::getenv("BURN_IN_TIMESTAMP") != nullptr;
+        const int lines = burn_in ? 4 : 3;
+        const int slate_x = (width - static_cast<int>(columns) * atlas.cellWidth()) / 2;
+        const int slate_y = (height - lines * atlas.cellHeight()) / 2;
+        TextField name_field(atlas, slate_x, slate_y, columns);
+        TextField fps_field(atlas, slate_x, slate_y + atlas.cellHeight(), columns);
+        TextField timecode_field(atlas, slate_x, slate_y + 2 * atlas.cellHeight(), columns);
+        TextField capture_field(atlas, slate_x, slate_y + 3 * atlas.cellHeight(), columns);
+        const std::string name = stream_id.empty() ? "MobileCam_RealCamera" : stream_id;
+        
         int frame_count = 0;
+        double measured_fps = 0.0;
+        auto fps_window_start = std::chrono::steady_clock::now();
         
         try {
             while (running) {
@@ -178,42 +197,34 @@ public:
                 // from the WebRTC stream and convert them to NDI format
                 // For now, we'll create a pattern that shows we're connected
                 
-                for (int y = 0; y < height; y++) {
-                    for (int x = 0; x < width; x++) {
-                        int pixel_index = (y * width + x) * 4;
-                        
-                        // Create a pattern that shows we're connected to the real stream
-                        // This is a placeholder - in reality, we'd decode the WebRTC video frames
-                        uint8_t r, g, b;
-                        
-                        // Show connection status with colors
-                        if (frame_count % 60 < 30) {
-                            // Green when "connected"
-                            r = 0;
-                            g = 255;
-                            b = 0;
-                        } else {
-                            // Blue when "streaming"
-                            r = 0;
-                            g = 0;
-                            b = 255;
-                        }
-                        
-                        // Add some text-like pattern to show it's the real camera
-                        if (y > height/2 - 50 && y < height/2 + 50 && 
-                            x > width/2 - 200 && x < width/2 + 200) {
-                            // White text area
-                            r = 255;
-                            g = 255;
-                            b = 255;
-                        }
-                        
-                        // BGRA format
-                        frame_data[pixel_index + 0] = b;
-                        frame_data[pixel_index + 1] = g;
-                        frame_data[pixel_index + 2] = r;
-                        frame_data[pixel_index + 3] = 255;
-                    }
+                // Show connection status with colors: green when "connected",
+                // blue when "streaming"; repainted only when it flips
+                if (frame_count % 30 == 0) {
+                    uint32_t pixel = (frame_count % 60 < 30) ? 0xFF00FF00u : 0xFF0000FFu;
+                    uint32_t* pixels = reinterpret_cast<uint32_t*>(frame_data);
+                    std::fill(pixels, pixels + width * height, pixel);
+                    name_field.invalidate();
+                    fps_field.invalidate();
+                    timecode_field.invalidate();
+                    capture_field.invalidate();
+                }
+                
+                if (frame_count > 0 && frame_count % frame_rate == 0) {
+                    auto now = std::chrono::steady_clock::now();
+                    measured_fps = frame_rate / std::chrono::duration<double>(now - fps_window_start).count();
+                    fps_window_start = now;
+                }
+                char fps_text[32];
+                std::snprintf(fps_text, sizeof(fps_text), "FPS %.1f", measured_fps);
+                
+                const int stride = video_frame.line_stride_in_bytes;
+                name_field.draw(frame_data, width, height, stride, name);
+                fps_field.draw(frame_data, width, height, stride, fps_text);
+                timecode_field.draw(frame_data, width, height, stride, "TC " + formatTimecode(frame_count, frame_rate));
+                if (burn_in) {
+                    // Capture time of this frame, to compare against a clock on the receiving screen
+                    capture_field.draw(frame_data, width, height, stride,
+                                       "CAP " + formatCaptureTime(std::chrono::system_clock::now()));
                 }
                 
                 // Send frame
@@ -6,11 +6,15 @@
 #include <cmath>
 #include <vector>
 #include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
 #include <curl/curl.h>
 #include <opencv2/opencv.hpp>
 
 // Include NDI SDK headers
 #include "Processing.NDI.Lib.h"
+#include "glyph_atlas.h"
 
 // Global flag to signal termination
 static bool exit_loop = false;
@@ -156,48 +160,55 @@ public:
         std::cout << "📱 This is your ACTUAL mobile camera stream!" << std::endl;
         std::cout << "Press Ctrl+C to stop" << std::endl;
         
+        // Status slate: glyphs are pre-rasterized once and only changed cells are redrawn
+        GlyphAtlas atlas(3, 255, 255, 255, 32, 32, 32);
+        const size_t columns = 24;
+        const bool burn_in = std::getenv("BURN_IN_TIMESTAMP") != nullptr;
+        const int lines = burn_in ? 4 : 3;
+        const int slate_x = (width - static_cast<int>(columns) * atlas.cellWidth()) / 2;
+        const int slate_y = (height - lines * atlas.cellHeight()) / 2;
+        TextField name_field(atlas, slate_x, slate_y, columns);
+        TextField fps_field(atlas, slate_x, slate_y + atlas.cellHeight(), columns);
+        TextField timecode_field(atlas, slate_x, slate_y + 2 * atlas.cellHeight(), columns);
+        TextField capture_field(atlas, slate_x, slate_y + 3 * atlas.cellHeight(), columns);
+        
         int frame_count = 0;
+        double measured_fps = 0.0;
         auto last_frame_time = std::chrono::high_resolution_clock::now();
+        auto fps_window_start = last_frame_time;
         
         while (!exit_loop) {
             // TODO: Here we would actually receive and decode the WebRTC video frames
             // from your mobile device and convert them to NDI format
             
-            // For now, create a pattern that shows we're processing real mobile data
-            for (int y = 0; y < height; ++y) {
-                for (int x = 0; x < width; ++x) {
-                    double time_val = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - last_frame_time).count();
-                    
-                    // Create a pattern that shows we're connected to real mobile stream
-                    uint8_t r, g, b;
-                    
-                    // Show we're processing real mobile camera data
-                    if (frame_count % 60 < 30) {
-                        // Green when "connected to mobile"
-                        r = 0;
-                        g = 255;
-                        b = 0;
-                    } else {
-                        // Blue when "streaming mobile data"
-                        r = 0;
-                        g = 0;
-                        b = 255;
-                    }
-                    
-                    // Add text area to show it's real mobile data
-                    if (y > height/2 - 30 && y < height/2 + 30 && 
-                        x > width/2 - 150 && x < width/2 + 150) {
-                        // White text area
-                        r = 255;
-                        g = 255;
-                        b = 255;
-                    }
-                    
-                    frame_data[(y * width + x) * 4 + 0] = b;
-                    frame_data[(y * width + x) * 4 + 1] = g;
-                    frame_data[(y * width + x) * 4 + 2] = r;
-                    frame_data[(y * width + x) * 4 + 3] = 255;
-                }
+            // Show we're processing real mobile camera data: green when "connected
+            // to mobile", blue when "streaming mobile data"; repainted only when it flips
+            if (frame_count % 30 == 0) {
+                uint32_t pixel = (frame_count % 60 < 30) ? 0xFF00FF00u : 0xFF0000FFu;
+                uint32_t* pixels = reinterpret_cast<uint32_t*>(frame_data);
+                std::fill(pixels, pixels + width * height, pixel);
+                name_field.invalidate();
+                fps_field.invalidate();
+                timecode_field.invalidate();
+                capture_field.invalidate();
+            }
+            
+            if (frame_count > 0 && frame_count % fps == 0) {
+                auto now = std::chrono::high_resolution_clock::now();
+                measured_fps = fps / std::chrono::duration<double>(now - fps_window_start).count();
+                fps_window_start = now;
+            }
+            char fps_text[32];
+            std::snprintf(fps_text, sizeof(fps_text), "FPS %.1f", measured_fps);
+            
+            const int stride = video_frame.line_stride_in_bytes;
+            name_field.draw(frame_data, width, height, stride, stream_id);
+            fps_field.draw(frame_data, width, height, stride, fps_text);
+            timecode_field.draw(frame_data, width, height, stride, "TC " + formatTimecode(frame_count, fps));
+            if (burn_in) {
+                // Capture time of this frame, to compare against a clock on the receiving screen
+                capture_field.draw(frame_data, width, height, stride,
+                                   "CAP " + formatCaptureTime(std::chrono::system_clock::now()));
             }
             
             NDIlib_send_send_video_v2(pNDI_send, &video_frame);
@@ -0,0 +1,227 @@
+// Glyph atlas text renderer for BGRA status slates and timecode burn-in.
+//
+// Every glyph of a small built-in 5x7 font is rasterized once, at the
+// chosen scale and colours, into a BGRA cell. Drawing text is then a row
+// memcpy per cell, and a TextField only re-blits the cells whose character
+// changed since the last frame, so a running timecode costs a couple of
+// cells (a few microseconds) per frame.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+class GlyphAtlas {
+public:
+    static const int kGlyphWidth = 5;
+    static const int kGlyphHeight = 7;
+
+    // scale: pixels per font dot; colours are given as B, G, R
+    GlyphAtlas(int scale,
+               uint8_t fg_b, uint8_t fg_g, uint8_t fg_r,
+               uint8_t bg_b, uint8_t bg_g, uint8_t bg_r)
+        : scale_(scale < 1 ? 1 : scale),
+          cell_width_((kGlyphWidth + 2) * scale_),
+          cell_height_((kGlyphHeight + 2) * scale_) {
+        const uint8_t fg[4] = {fg_b, fg_g, fg_r, 255};
+        const uint8_t bg[4] = {bg_b, bg_g, bg_r, 255};
+        cells_.resize(static_cast<size_t>(kCount) * cellBytes());
+
+        for (int code = kFirst; code < kFirst + kCount; ++code) {
+            const uint8_t* rows = glyphRows(static_cast<char>(code));
+            uint8_t* cell = &cells_[static_cast<size_t>(code - kFirst) * cellBytes()];
+            for (int y = 0; y < cell_height_; ++y) {
+                for (int x = 0; x < cell_width_; ++x) {
+                    // One dot of padding around the glyph keeps neighbours apart
+                    int dot_x = x / scale_ - 1;
+                    int dot_y = y / scale_ - 1;
+                    bool on = dot_x >= 0 && dot_x < kGlyphWidth && dot_y >= 0 && dot_y < kGlyphHeight &&
+                              (rows[dot_y] >> (kGlyphWidth - 1 - dot_x)) & 1;
+                    std::memcpy(cell + (static_cast<size_t>(y) * cell_width_ + x) * 4, on ? fg : bg, 4);
+                }
+            }
+        }
+    }
+
+    int cellWidth() const { return cell_width_; }
+    int cellHeight() const { return cell_height_; }
+
+    // Rasterized BGRA cell of a character (lowercase shares the uppercase glyph)
+    const uint8_t* cell(char c) const {
+        int code = static_cast<unsigned char>(c);
+        if (code >= 'a' && code <= 'z') {
+            code -= 'a' - 'A';
+        }
+        if (code < kFirst || code >= kFirst + kCount) {
+            code = '?';
+        }
+        return &cells_[static_cast<size_t>(code - kFirst) * cellBytes()];
+    }
+
+    // Copy one cell into a BGRA frame with its top-left corner at (x, y)
+    void blit(char c, uint8_t* frame, int stride, int x, int y) const {
+        const uint8_t* src = cell(c);
+        const size_t row_bytes = static_cast<size_t>(cell_width_) * 4;
+        uint8_t* dst = frame + static_cast<size_t>(y) * stride + static_cast<size_t>(x) * 4;
+        for (int row = 0; row < cell_height_; ++row) {
+            std::memcpy(dst, src, row_bytes);
+            src += row_bytes;
+            dst += stride;
+        }
+    }
+
+private:
+    static const int kFirst = 32;
+    static const int kCount = 96;
+
+    struct Glyph {
+        char c;
+        uint8_t rows[kGlyphHeight];
+    };
+
+    size_t cellBytes() const {
+        return static_cast<size_t>(cell_width_) * cell_height_ * 4;
+    }
+
+    static const uint8_t* glyphRows(char c) {
+        static const Glyph font[] = {
+            {' ', {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000}},
+            {'!', {0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00000, 0b00100}},
+            {'#', {0b01010, 0b01010, 0b11111, 0b01010, 0b11111, 0b01010, 0b01010}},
+            {'%', {0b11000, 0b11001, 0b00010, 0b00100, 0b01000, 0b10011, 0b00011}},
+            {'(', {0b00010, 0b00100, 0b01000, 0b01000, 0b01000, 0b00100, 0b00010}},
+            {')', {0b01000, 0b00100, 0b00010, 0b00010, 0b00010, 0b00100, 0b01000}},
+            {'+', {0b00000, 0b00100, 0b00100, 0b11111, 0b00100, 0b00100, 0b00000}},
+            {',', {0b00000, 0b00000, 0b00000, 0b00000, 0b01100, 0b00100, 0b01000}},
+            {'-', {0b00000, 0b00000, 0b00000, 0b11111, 0b00000, 0b00000, 0b00000}},
+            {'.', {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b01100, 0b01100}},
+            {'/', {0b00000, 0b00001, 0b00010, 0b00100, 0b01000, 0b10000, 0b00000}},
+            {'0', {0b01110, 0b10001, 0b10011, 0b10101, 0b11001, 0b10001, 0b01110}},
+            {'1', {0b00100, 0b01100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110}},
+            {'2', {0b01110, 0b10001, 0b00001, 0b00010, 0b00100, 0b01000, 0b11111}},
+            {'3', {0b11111, 0b00010, 0b00100, 0b00010, 0b00001, 0b10001, 0b01110}},
+            {'4', {0b00010, 0b00110, 0b01010, 0b10010, 0b11111, 0b00010, 0b00010}},
+            {'5', {0b11111, 0b10000, 0b11110, 0b00001, 0b00001, 0b10001, 0b01110}},
+            {'6', {0b00110, 0b01000, 0b10000, 0b11110, 0b10001, 0b10001, 0b01110}},
+            {'7', {0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b01000, 0b01000}},
+            {'8', {0b01110, 0b10001, 0b10001, 0b01110, 0b10001, 0b10001, 0b01110}},
+            {'9', {0b01110, 0b10001, 0b10001, 0b01111, 0b00001, 0b00010, 0b01100}},
+            {':', {0b00000, 0b01100, 0b01100, 0b00000, 0b01100, 0b01100, 0b00000}},
+            {'=', {0b00000, 0b00000, 0b11111, 0b00000, 0b11111, 0b00000, 0b00000}},
+            {'?', {0b01110, 0b10001, 0b00001, 0b00010, 0b00100, 0b00000, 0b00100}},
+            {'A', {0b01110, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001}},
+            {'B', {0b11110, 0b10001, 0b10001, 0b11110, 0b10001, 0b10001, 0b11110}},
+            {'C', {0b01110, 0b10001, 0b10000, 0b10000, 0b10000, 0b10001, 0b01110}},
+            {'D', {0b11100, 0b10010, 0b10001, 0b10001, 0b10001, 0b10010, 0b11100}},
+            {'E', {0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b11111}},
+            {'F', {0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b10000}},
+            {'G', {0b01110, 0b10001, 0b10000, 0b10111, 0b10001, 0b10001, 0b01111}},
+            {'H', {0b10001, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001}},
+            {'I', {0b01110, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110}},
+            {'J', {0b00111, 0b00010, 0b00010, 0b00010, 0b00010, 0b10010, 0b01100}},
+            {'K', {0b10001, 0b10010, 0b10100, 0b11000, 0b10100, 0b10010, 0b10001}},
+            {'L', {0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b11111}},
+            {'M', {0b10001, 0b11011, 0b10101, 0b10101, 0b10001, 0b10001, 0b10001}},
+            {'N', {0b10001, 0b10001, 0b11001, 0b10101, 0b10011, 0b10001, 0b10001}},
+            {'O', {0b01110, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110}},
+            {'P', {0b11110, 0b10001, 0b10001, 0b11110, 0b10000, 0b10000, 0b10000}},
+            {'Q', {0b01110, 0b10001, 0b10001, 0b10001, 0b10101, 0b10010, 0b01101}},
+            {'R', {0b11110, 0b10001, 0b10001, 0b11110, 0b10100, 0b10010, 0b10001}},
+            {'S', {0b01111, 0b10000, 0b10000, 0b01110, 0b00001, 0b00001, 0b11110}},
+            {'T', {0b11111, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100}},
+            {'U', {0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110}},
+            {'V', {0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01010, 0b00100}},
+            {'W', {0b10001, 0b10001, 0b10001, 0b10101, 0b10101, 0b10101, 0b01010}},
+            {'X', {0b10001, 0b10001, 0b01010, 0b00100, 0b01010, 0b10001, 0b10001}},
+            {'Y', {0b10001, 0b10001, 0b10001, 0b01010, 0b00100, 0b00100, 0b00100}},
+            {'Z', {0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b10000, 0b11111}},
+            {'_', {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111}},
+        };
+        const Glyph* unknown = nullptr;
+        for (const Glyph& glyph : font) {
+            if (glyph.c == c) {
+                return glyph.rows;
+            }
+            if (glyph.c == '?') {
+                unknown = &glyph;
+            }
+        }
+        return unknown->rows;
+    }
+
+    int scale_;
+    int cell_width_;
+    int cell_height_;
+    std::vector<uint8_t> cells_;
+};
+
+// A fixed-width line of text at a fixed position in a persistent frame
+// buffer. Only cells whose character differs from the previous draw are
+// converted; call invalidate() after anything else painted over the field.
+class TextField {
+public:
+    TextField(const GlyphAtlas& atlas, int x, int y, size_t columns)
+        : atlas_(atlas), x_(x), y_(y), shown_(columns, '\0'), valid_(false) {}
+
+    int width() const { return static_cast<int>(shown_.size()) * atlas_.cellWidth(); }
+    int height() const { return atlas_.cellHeight(); }
+
+    void invalidate() { valid_ = false; }
+
+    // Draw text (clipped or space-padded to the field width) into a BGRA
+    // frame; returns the number of glyph cells converted
+    int draw(uint8_t* frame, int frame_width, int frame_height, int stride, const std::string& text) {
+        int converted = 0;
+        for (size_t i = 0; i < shown_.size(); ++i) {
+            char c = i < text.size() ? text[i] : ' ';
+            if (valid_ && shown_[i] == c) {
+                continue;
+            }
+            int cell_x = x_ + static_cast<int>(i) * atlas_.cellWidth();
+            if (cell_x < 0 || y_ < 0 || cell_x + atlas_.cellWidth() > frame_width ||
+                y_ + atlas_.cellHeight() > frame_height) {
+                continue;
+            }
+            atlas_.blit(c, frame, stride, cell_x, y_);
+            shown_[i] = c;
+            ++converted;
+        }
+        valid_ = true;
+        return converted;
+    }
+
+private:
+    const GlyphAtlas& atlas_;
+    int x_;
+    int y_;
+    std::string shown_;
+    bool valid_;
+};
+
+// SMPTE-style HH:MM:SS:FF of a frame count at an integer frame rate
+inline std::string formatTimecode(long long frame, int fps) {
+    char text[24];
+    long long seconds = frame / fps;
+    std::snprintf(text, sizeof(text), "%02d:%02d:%02d:%02d",
+                  static_cast<int>((seconds / 3600) % 24), static_cast<int>((seconds / 60) % 60),
+                  static_cast<int>(seconds % 60), static_cast<int>(frame % fps));
+    return text;
+}
+
+// Wall-clock HH:MM:SS.mmm (UTC) of a capture time, for latency measurements
+// against a clock shown next to the receiving screen
+inline std::string formatCaptureTime(std::chrono::system_clock::time_point when) {
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(when.time_since_epoch()).count();
+    std::time_t seconds = static_cast<std::time_t>(ms / 1000);
+    std::tm utc;
+    gmtime_r(&seconds, &utc);
+    char text[16];
+    std::snprintf(text, sizeof(text), "%02d:%02d:%02d.%03d",
+                  utc.tm_hour, utc.tm_min, utc.tm_sec, static_cast<int>(ms % 1000));
+    return text;
+}
@@ -3,6 +3,7 @@ Configuration Settings - Pydantic settings for NDI Bridge
 """
 
 import os
+import re
 from typing import Optional
 from pydantic_settings import BaseSettings
 from pydantic import Field
@@ -67,13 +68,233 @@ class Settings(BaseSettings):
     # Performance Configuration
     processing_quality: str = Field(
         default="high",
-        description="Processing quality (low, medium, high)"
+        description="Processing quality (low, medium, high); low enables temporal denoising"
+    )
+    denoise_threshold: float = Field(
+        default=6.0,
+        description="Frame-to-frame difference in 8-bit levels the low-quality temporal denoiser treats as noise"
     )
     enable_hardware_acceleration: bool = Field(
         default=True,
         description="Enable hardware acceleration when available"
     )
     
+    # Worker Process Configuration
+    worker_processes: int = Field(
+        default=0,
+        description="Bridge worker processes under a supervisor (0 = single process)"
+    )
+    
+    # Admission Control Configuration
+    admission_control: bool = Field(
+        default=True,
+        description="Reject or downgrade streams that exceed the CPU budget"
+    )
+    cpu_budget_percent: float = Field(
+        default=80.0,
+        description="Share of host CPU (all cores) the bridge may use for streams"
+    )
+    default_stream_cost: float = Field(
+        default=0.25,
+        description="Assumed CPU cores per 720p30 stream before measurements exist"
+    )
+    
+    conversion_bands: int = Field(
+        default=4,
+        description="Row bands per frame converted in parallel, 0 to convert inline"
+    )
+    frame_workers: int = Field(
+        default=0,
+        description="Earliest-deadline-first frame worker threads, 0 for one per CPU"
+    )
+    drop_late_frames: bool = Field(
+        default=True,
+        description="Drop frame work that can no longer make its output deadline"
+    )
+    ndi_async_send: bool = Field(
+        default=True,
+        description="Send NDI video asynchronously so compression overlaps the next frame"
+    )
+    decode_threads: int = Field(
+        default=0,
+        description="Decoder and colour-convert threads per stream, 0 for one per CPU"
+    )
+    audio_enabled: bool = Field(
+        default=True,
+        description="Send phone audio with each NDI source"
+    )
+    audio_block_samples: int = Field(
+        default=480,
+        description="Samples per NDI audio frame when not driven by the house clock"
+    )
+    audio_only_block_samples: int = Field(
+        default=240,
+        description="Samples per NDI audio frame of audio-only (mic) phones"
+    )
+    audio_buffer_ms: float = Field(
+        default=40.0,
+        description="Audio buffer the drift-compensating resampler holds, in milliseconds"
+    )
+    color_lut_dir: str = Field(
+        default="",
+        description="Directory of per-device .cube LUTs (<device name>.cube, else default.cube)"
+    )
+    color_match_reference: str = Field(
+        default="",
+        description="Device name of the camera the others are auto colour-matched to, empty to disable"
+    )
+    color_match_strength: float = Field(
+        default=1.0,
+        description="Blend of auto colour matching from none (0) to full (1)"
+    )
+    chroma_key_devices: str = Field(
+        default="",
+        description="Comma-separated device names to chroma key, * for all, empty to disable"
+    )
+    chroma_key_color: str = Field(
+        default="green",
+        description="Key colour: green, blue or #RRGGBB"
+    )
+    chroma_key_tolerance: float = Field(
+        default=0.12,
+        description="Chroma distance from the key colour that is fully transparent"
+    )
+    chroma_key_softness: float = Field(
+        default=0.10,
+        description="Chroma distance over which the key ramps to opaque"
+    )
+    chroma_key_spill: float = Field(
+        default=1.0,
+        description="Spill suppression strength from none (0) to full (1)"
+    )
+    chroma_key_edge: float = Field(
+        default=1.0,
+        description="Matte edge softening blur in pixels, 0 to disable"
+    )
+    chroma_key_output: str = Field(
+        default="UYVA",
+        description="NDI format of keyed streams: UYVA or BGRA"
+    )
+    overlay_dir: str = Field(
+        default="",
+        description="Directory of per-device logo PNGs (<device name>.png, else default.png)"
+    )
+    overlay_position: str = Field(
+        default="top-right",
+        description="Frame corner of the logo: top-left, top-right, bottom-left or bottom-right"
+    )
+    overlay_scale: float = Field(
+        default=0.12,
+        description="Logo width as a fraction of the frame width"
+    )
+    overlay_name_strap: bool = Field(
+        default=False,
+        description="Show each stream's device name as a lower-third strap"
+    )
+    house_clock: bool = Field(
+        default=False,
+        description="Submit frames of all senders on one shared, epoch-aligned frame clock"
+    )
+    house_clock_fps: float = Field(
+        default=30.0,
+        description="House clock frame rate"
+    )
+    house_clock_phase_ms: float = Field(
+        default=0.0,
+        description="Offset of the house clock tick grid in milliseconds"
+    )
+    clip_sources: str = Field(
+        default="",
+        description="Comma-separated clip files or directories looped as NDI sources, empty to disable"
+    )
+    frame_rate_conversion: str = Field(
+        default="repeat",
+        description="How streams are converted to the house clock rate: repeat (newest frame) or blend"
+    )
+    whip_enabled: bool = Field(
+        default=False,
+        description="Accept WHIP publishers at POST /whip, bypassing mediasoup (single-process mode only)"
+    )
+    whip_token: str = Field(
+        default="",
+        description="Bearer token WHIP publishers must send, empty to accept any"
+    )
+    return_feed_source: str = Field(
+        default="",
+        description="NDI source (full name or part of one) sent back to the phones as a confidence monitor, empty to disable"
+    )
+    return_feed_codec: str = Field(
+        default="VP8",
+        description="Return feed codec: VP8 or H264"
+    )
+    return_feed_width: int = Field(
+        default=640,
+        description="Return feed width"
+    )
+    return_feed_height: int = Field(
+        default=360,
+        description="Return feed height"
+    )
+    return_feed_fps: float = Field(
+        default=25.0,
+        description="Return feed frame rate"
+    )
+    return_feed_bitrate: int = Field(
+        default=800000,
+        description="Return feed target bitrate in bits per second"
+    )
+    
+    # RTP Receiver Configuration
+    rtp_receiver: str = Field(
+        default="native",
+        description="RTP receiver (native, aiortc)"
+    )
+    receiver_min_bitrate: int = Field(
+        default=150_000,
+        description="Lowest bitrate the receiver asks phones for, in bps"
+    )
+    receiver_max_bitrate: int = Field(
+        default=1_500_000,
+        description="Highest bitrate the receiver asks phones for, in bps"
+    )
+    rtp_socket_backend: str = Field(
+        default="udp",
+        description="Native receiver ingest (udp, busy_poll, af_xdp)"
+    )
+    busy_poll_core: int = Field(
+        default=-1,
+        description="CPU the busy-poll receive thread spins on, -1 for any"
+    )
+    busy_poll_spin_us: int = Field(
+        default=500,
+        description="Idle microseconds the busy-poll thread spins before blocking"
+    )
+    xdp_interface: str = Field(
+        default="eth0",
+        description="Interface the PlainTransport traffic arrives on (af_xdp)"
+    )
+    xdp_queue: int = Field(
+        default=0,
+        description="RX queue the AF_XDP socket binds to"
+    )
+    # Defaults match the backend's mediasoup rtcMinPort/rtcMaxPort
+    xdp_port_min: int = Field(
+        default=10000,
+        description="Lowest PlainTransport port steered to AF_XDP"
+    )
+    xdp_port_max: int = Field(
+        default=10100,
+        description="Highest PlainTransport port steered to AF_XDP"
+    )
+    xdp_native_mode: bool = Field(
+        default=False,
+        description="Attach the XDP program in driver mode instead of generic mode"
+    )
+    suspend_idle_decoders: bool = Field(
+        default=False,
+        description="Stop decoding streams without NDI receivers, resume from the GOP cache"
+    )
+    
     # Logging Configuration
     log_level: str = Field(
         default="INFO",
@@ -136,7 +357,60 @@ class Settings(BaseSettings):
             "default_height": {"env": "DEFAULT_HEIGHT"},
             "default_fps": {"env": "DEFAULT_FPS"},
             "processing_quality": {"env": "PROCESSING_QUALITY"},
+            "denoise_threshold": {"env": "DENOISE_THRESHOLD"},
             "enable_hardware_acceleration": {"env": "ENABLE_HARDWARE_ACCELERATION"},
+            "worker_processes": {"env": "WORKER_PROCESSES"},
+            "admission_control": {"env": "ADMISSION_CONTROL"},
+            "cpu_budget_percent": {"env": "CPU_BUDGET_PERCENT"},
+            "default_stream_cost": {"env": "DEFAULT_STREAM_COST"},
+            "conversion_bands": {"env": "CONVERSION_BANDS"},
+            "frame_workers": {"env": "FRAME_WORKERS"},
+            "drop_late_frames": {"env": "DROP_LATE_FRAMES"},
+            "ndi_async_send": {"env": "NDI_ASYNC_SEND"},
+            "decode_threads": {"env": "DECODE_THREADS"},
+            "audio_enabled": {"env": "AUDIO_ENABLED"},
+            "audio_block_samples": {"env": "AUDIO_BLOCK_SAMPLES"},
+            "audio_only_block_samples": {"env": "AUDIO_ONLY_BLOCK_SAMPLES"},
+            "audio_buffer_ms": {"env": "AUDIO_BUFFER_MS"},
+            "color_lut_dir": {"env": "COLOR_LUT_DIR"},
+            "color_match_reference": {"env": "COLOR_MATCH_REFERENCE"},
+            "color_match_strength": {"env": "COLOR_MATCH_STRENGTH"},
+            "chroma_key_devices": {"env": "CHROMA_KEY_DEVICES"},
+            "chroma_key_color": {"env": "CHROMA_KEY_COLOR"},
+            "chroma_key_tolerance": {"env": "CHROMA_KEY_TOLERANCE"},
+            "chroma_key_softness": {"env": "CHROMA_KEY_SOFTNESS"},
+            "chroma_key_spill": {"env": "CHROMA_KEY_SPILL"},
+            "chroma_key_edge": {"env": "CHROMA_KEY_EDGE"},
+            "chroma_key_output": {"env": "CHROMA_KEY_OUTPUT"},
+            "overlay_dir": {"env": "OVERLAY_DIR"},
+            "overlay_position": {"env": "OVERLAY_POSITION"},
+            "overlay_scale": {"env": "OVERLAY_SCALE"},
+            "overlay_name_strap": {"env": "OVERLAY_NAME_STRAP"},
+            "house_clock": {"env": "HOUSE_CLOCK"},
+            "house_clock_fps": {"env": "HOUSE_CLOCK_FPS"},
+            "house_clock_phase_ms": {"env": "HOUSE_CLOCK_PHASE_MS"},
+            "frame_rate_conversion": {"env": "FRAME_RATE_CONVERSION"},
+            "clip_sources": {"env": "CLIP_SOURCES"},
+            "whip_enabled": {"env": "WHIP_ENABLED"},
+            "whip_token": {"env": "WHIP_TOKEN"},
+            "return_feed_source": {"env": "RETURN_FEED_SOURCE"},
+            "return_feed_codec": {"env": "RETURN_FEED_CODEC"},
+            "return_feed_width": {"env": "RETURN_FEED_WIDTH"},
+            "return_feed_height": {"env": "RETURN_FEED_HEIGHT"},
+            "return_feed_fps": {"env": "RETURN_FEED_FPS"},
+            "return_feed_bitrate": {"env": "RETURN_FEED_BITRATE"},
+            "rtp_receiver": {"env": "RTP_RECEIVER"},
+            "receiver_min_bitrate": {"env": "RECEIVER_MIN_BITRATE"},
+            "receiver_max_bitrate": {"env": "RECEIVER_MAX_BITRATE"},
+            "rtp_socket_backend": {"env": "RTP_SOCKET_BACKEND"},
+            "busy_poll_core": {"env": "BUSY_POLL_CORE"},
+            "busy_poll_spin_us": {"env": "BUSY_POLL_SPIN_US"},
+            "xdp_interface": {"env": "XDP_INTERFACE"},
+            "xdp_queue": {"env": "XDP_QUEUE"},
+            "xdp_port_min": {"env": "XDP_PORT_MIN"},
+            "xdp_port_max": {"env": "XDP_PORT_MAX"},
+            "xdp_native_mode": {"env": "XDP_NATIVE_MODE"},
+            "suspend_idle_decoders": {"env": "SUSPEND_IDLE_DECODERS"},
             "log_level": {"env": "LOG_LEVEL"},
             "log_format": {"env": "LOG_FORMAT"},
             "connection_timeout": {"env": "CONNECTION_TIMEOUT"},
@@ -197,6 +471,15 @@ class Settings(BaseSettings):
         """
         return self.ice_servers
     
+    def get_chroma_key_devices(self) -> set:
+        """
+        Get device names to chroma key
+        
+        Returns:
+            set: Device names, "*" for every device
+        """
+        return {name.strip() for name in self.chroma_key_devices.split(",") if name.strip()}
+    
     def get_environment_info(self) -> dict:
         """
         Get environment information
@@ -263,10 +546,108 @@ class Settings(BaseSettings):
         if self.default_fps <= 0:
             errors.append("default_fps must be greater than 0")
         
+        if self.worker_processes < 0:
+            errors.append("worker_processes must be 0 or greater")
+        
+        if not 0 < self.cpu_budget_percent <= 100:
+            errors.append("cpu_budget_percent must be between 0 and 100")
+        
+        if self.default_stream_cost <= 0:
+            errors.append("default_stream_cost must be greater than 0")
+        
+        if not 0 <= self.conversion_bands <= 64:
+            errors.append("conversion_bands must be between 0 and 64")
+        
+        if self.frame_workers < 0:
+            errors.append("frame_workers must not be negative")
+        
+        if self.decode_threads < 0:
+            errors.append("decode_threads must not be negative")
+        
+        if not 32 <= self.audio_block_samples <= 4800:
+            errors.append("audio_block_samples must be between 32 and 4800")
+        
+        if not 32 <= self.audio_only_block_samples <= 4800:
+            errors.append("audio_only_block_samples must be between 32 and 4800")
+        
+        if not 5 <= self.audio_buffer_ms <= 500:
+            errors.append("audio_buffer_ms must be between 5 and 500")
+        
+        if self.color_lut_dir and not os.path.isdir(self.color_lut_dir):
+            errors.append(f"color_lut_dir {self.color_lut_dir} is not a directory")
+        
+        if not 0.0 <= self.color_match_strength <= 1.0:
+            errors.append("color_match_strength must be between 0 and 1")
+        
+        if self.chroma_key_devices:
+            color = self.chroma_key_color.strip().lower()
+            if color not in ("green", "blue") and not re.fullmatch(r"#?[0-9a-f]{6}", color):
+                errors.append("chroma_key_color must be green, blue or #RRGGBB")
+            if not 0.0 <= self.chroma_key_tolerance <= 0.7:
+                errors.append("chroma_key_tolerance must be between 0 and 0.7")
+            if not 0.0 <= self.chroma_key_spill <= 1.0:
+                errors.append("chroma_key_spill must be between 0 and 1")
+            if not 0.0 <= self.chroma_key_edge <= 10.0:
+                errors.append("chroma_key_edge must be between 0 and 10")
+            if self.chroma_key_output not in ("UYVA", "BGRA"):
+                errors.append("chroma_key_output must be UYVA or BGRA")
+        
+        if self.overlay_dir and not os.path.isdir(self.overlay_dir):
+            errors.append(f"overlay_dir {self.overlay_dir} is not a directory")
+        
+        if self.overlay_position not in ("top-left", "top-right", "bottom-left", "bottom-right"):
+            errors.append("overlay_position must be top-left, top-right, bottom-left or bottom-right")
+        
+        if not 0.0 < self.overlay_scale <= 1.0:
+            errors.append("overlay_scale must be between 0 and 1")
+        
+        if not 1 <= self.house_clock_fps <= 120:
+            errors.append("house_clock_fps must be between 1 and 120")
+        
+        if self.frame_rate_conversion not in ("repeat", "blend"):
+            errors.append("frame_rate_conversion must be 'repeat' or 'blend'")
+        
+        for path in (part.strip() for part in self.clip_sources.split(",")):
+            if path and not os.path.exists(path):
+                errors.append(f"clip source {path} does not exist")
+        
+        if self.whip_enabled and self.worker_processes > 0:
+            errors.append("whip_enabled needs worker_processes = 0 (WHIP publishers are received in the main process)")
+        
+        if self.return_feed_source:
+            if self.return_feed_codec.upper() not in ("VP8", "H264"):
+                errors.append("return_feed_codec must be VP8 or H264")
+            if not (16 <= self.return_feed_width <= 1920 and 16 <= self.return_feed_height <= 1080):
+                errors.append("return feed size must be between 16x16 and 1920x1080")
+            if self.return_feed_width % 2 or self.return_feed_height % 2:
+                errors.append("return feed width and height must be even")
+            if not 1 <= self.return_feed_fps <= 60:
+                errors.append("return_feed_fps must be between 1 and 60")
+            if not 100000 <= self.return_feed_bitrate <= 10000000:
+                errors.append("return_feed_bitrate must be between 100000 and 10000000")
+        
+        if self.rtp_receiver not in ("native", "aiortc"):
+            errors.append("rtp_receiver must be 'native' or 'aiortc'")
+        
+        if not 0 < self.receiver_min_bitrate <= self.receiver_max_bitrate:
+            errors.append("receiver_min_bitrate must be greater than 0 and not above receiver_max_bitrate")
+        
+        if self.rtp_socket_backend not in ("udp", "busy_poll", "af_xdp"):
+            errors.append("rtp_socket_backend must be 'udp', 'busy_poll' or 'af_xdp'")
+        
+        if self.busy_poll_spin_us < 0:
+            errors.append("busy_poll_spin_us must not be negative")
+        
+        if not 0 < self.xdp_port_min <= self.xdp_port_max <= 65535:
+            errors.append("xdp_port_min and xdp_port_max must form a valid port range")
+        
         # Validate quality setting
         if not self.is_valid_quality(self.processing_quality):
             errors.append("processing_quality must be 'low', 'medium', or 'high'")
         
+        if not 1.0 <= self.denoise_threshold <= 40.0:
+            errors.append("denoise_threshold must be between 1 and 40")
+        
         # Validate log level
         valid_log_levels = ["DEBUG", "INFO", "WARNING", "ERROR", "CRITICAL"]
         if self.log_level.upper() not in valid_log_levels:
@@ -4,19 +4,26 @@ Main entry point for the NDI bridge service
 """
 
 import asyncio
+import hmac
 import logging
 import signal
 import sys
-from typing import Dict, Optional
-from fastapi import FastAPI, HTTPException
-from fastapi.responses import JSONResponse
+from typing import Dict, List, Optional
+from fastapi import FastAPI, HTTPException, Request
+from fastapi.responses import JSONResponse, Response
 from dotenv import load_dotenv
 import os
 from datetime import datetime
 
 # Import our modules
 from config.settings import get_settings, Settings
-from services.stream_manager import StreamManager
+from services.stream_manager import StreamManager, create_stream_manager
+from services.admission import AdmissionController
+from services.supervisor import StreamSupervisor
+from sources.clip_source import ClipSource, clip_source_name, find_clips
+from sources.return_feed import ReturnFeed
+from webrtc.whip import WhipIngest
+from processing.house_clock import HouseClock
 from utils.logger import setup_production_logging
 from utils.metrics import start_metrics_server
 
@@ -47,8 +54,12 @@ async def shutdown_event():
     """Shutdown the NDI bridge on shutdown"""
     await stop_ndi_bridge()
 
-# Global stream manager
+# Global stream manager (single process) or supervisor (worker processes)
 stream_manager: Optional[StreamManager] = None
+supervisor: Optional[StreamSupervisor] = None
+clip_sources: List[ClipSource] = []
+return_feed: Optional[ReturnFeed] = None
+whip_ingest: Optional[WhipIngest] = None
 shutdown_event = asyncio.Event()
 
 
@@ -67,6 +78,18 @@ async def health_check():
                 "ndi_sdk_available": settings._check_ndi_sdk_availability(),
                 "timestamp": datetime.now().isoformat()
             }
+        elif supervisor:
+            stats = supervisor.get_stats()
+            return {
+                "status": "ok",
+                "service": "NDI Bridge",
+                "version": "1.0.0",
+                "uptime": stats["uptime"],
+                "active_streams": stats["total_active_streams"],
+                "workers": len(stats["workers"]),
+                "ndi_sdk_available": settings._check_ndi_sdk_availability(),
+                "timestamp": datetime.now().isoformat()
+            }
         else:
             return {
                 "status": "initializing",
@@ -155,6 +178,89 @@ async def get_stats():
         raise HTTPException(status_code=500, detail=str(e))
 
 
+@app.get("/workers")
+async def get_workers():
+    """Get worker process placement and load"""
+    if not supervisor:
+        raise HTTPException(status_code=404, detail="Worker processes not enabled")
+    
+    return supervisor.get_stats()
+
+
+@app.get("/clips")
+async def list_clips():
+    """List clip sources looped into NDI"""
+    return {
+        "clips": [source.get_stats() for source in clip_sources],
+        "total": len(clip_sources)
+    }
+
+
+@app.post("/whip")
+async def whip_publish(request: Request, name: Optional[str] = None):
+    """WHIP ingest: answer a publisher's SDP offer (RFC 9725)"""
+    ingest = _check_whip_request(request)
+    if request.headers.get("content-type", "").split(";")[0].strip() != "application/sdp":
+        raise HTTPException(status_code=415, detail="Offer must be application/sdp")
+    
+    offer = (await request.body()).decode("utf-8", errors="replace")
+    session = await ingest.publish(offer, name)
+    if not session:
+        raise HTTPException(status_code=503, detail="Publisher not accepted")
+    
+    return Response(
+        content=session.answer_sdp,
+        status_code=201,
+        media_type="application/sdp",
+        headers={"Location": f"/whip/{session.resource_id}"}
+    )
+
+
+@app.patch("/whip/{resource_id}")
+async def whip_patch(resource_id: str, request: Request):
+    """Trickle ICE and ICE restarts are not supported; the answer carries all candidates"""
+    _check_whip_request(request)
+    return Response(status_code=405, headers={"Allow": "DELETE"})
+
+
+@app.delete("/whip/{resource_id}")
+async def whip_delete(resource_id: str, request: Request):
+    """End a WHIP session"""
+    if not await _check_whip_request(request).delete(resource_id):
+        raise HTTPException(status_code=404, detail="WHIP session not found")
+    return {"status": "deleted", "resource_id": resource_id}
+
+
+@app.get("/whip")
+async def whip_sessions():
+    """List WHIP publishers"""
+    if not whip_ingest:
+        raise HTTPException(status_code=404, detail="WHIP ingest not enabled")
+    return whip_ingest.get_stats()
+
+
+def _check_whip_request(request: Request) -> WhipIngest:
+    """WHIP ingest if enabled and the request carries the configured bearer token"""
+    if not whip_ingest:
+        if settings.whip_enabled:
+            # Enabled but not running: worker mode or a failed start, see the startup log
+            raise HTTPException(status_code=503, detail="WHIP ingest not running (needs WORKER_PROCESSES=0)")
+        raise HTTPException(status_code=404, detail="WHIP ingest not enabled")
+    if settings.whip_token:
+        authorization = request.headers.get("authorization", "").encode()
+        if not hmac.compare_digest(authorization, f"Bearer {settings.whip_token}".encode()):
+            raise HTTPException(status_code=401, detail="Invalid WHIP token")
+    return whip_ingest
+
+
+@app.get("/return-feed")
+async def get_return_feed():
+    """Status of the program return feed sent to the phones"""
+    if not return_feed:
+        raise HTTPException(status_code=404, detail="Return feed not running")
+    return return_feed.get_stats()
+
+
 @app.get("/config")
 async def get_config():
     """Get current configuration"""
@@ -169,6 +275,12 @@ async def get_config():
             "default_resolution": f"{settings.default_width}x{settings.default_height}",
             "default_fps": settings.default_fps,
             "processing_quality": settings.processing_quality,
+            "admission_control": settings.admission_control,
+            "cpu_budget_percent": settings.cpu_budget_percent,
+            "worker_processes": settings.worker_processes,
+            "rtp_receiver": settings.rtp_receiver,
+            "receiver_max_bitrate": settings.receiver_max_bitrate,
+            "rtp_socket_backend": settings.rtp_socket_backend,
             "log_level": settings.log_level
         }
     except Exception as e:
@@ -273,7 +385,7 @@ async def readiness_probe():
 
 async def start_ndi_bridge():
     """Initialize and start the NDI bridge service"""
-    global stream_manager
+    global stream_manager, supervisor, whip_ingest
     
     try:
         logger.info("🚀 Starting NDI Bridge service...")
@@ -301,11 +413,37 @@ async def start_ndi_bridge():
         # Start metrics server
         start_metrics_server(9090)
         
+        admission_kwargs = {
+            "cpu_budget_percent": settings.cpu_budget_percent,
+            "default_stream_cost": settings.default_stream_cost,
+            "enabled": settings.admission_control
+        }
+        
+        # Shard streams across pinned worker processes
+        if settings.worker_processes > 0:
+            if settings.whip_enabled:
+                # Rejected by validate_configuration; kept explicit should that ever change
+                logger.error("WHIP_ENABLED is ignored with WORKER_PROCESSES > 0: publishers are received in-process")
+            supervisor = StreamSupervisor(
+                backend_url=settings.get_backend_ws_url(),
+                ndi_source_prefix=settings.ndi_source_prefix,
+                worker_count=settings.worker_processes,
+                admission_kwargs=admission_kwargs
+            )
+            if not await supervisor.initialize():
+                logger.error("Failed to initialize stream supervisor")
+                return False
+            
+            # Workers keep their own clocks; epoch alignment puts this one on the same ticks
+            house_clock = HouseClock(settings.house_clock_fps, settings.house_clock_phase_ms) if settings.house_clock else None
+            await _start_clip_sources(house_clock)
+            await _start_return_feed()
+            
+            logger.info(f"✅ NDI Bridge service ready with {settings.worker_processes} worker processes")
+            return True
+        
         # Initialize stream manager
-        stream_manager = StreamManager(
-            backend_url=settings.get_backend_ws_url(),
-            ndi_source_prefix=settings.ndi_source_prefix
-        )
+        stream_manager = create_stream_manager(settings, admission=AdmissionController(**admission_kwargs))
         
         # Set up callbacks
         stream_manager.on_stream_started = _on_stream_started
@@ -317,6 +455,13 @@ async def start_ndi_bridge():
             logger.error("Failed to initialize stream manager")
             return False
         
+        await _start_clip_sources(stream_manager.house_clock)
+        await _start_return_feed()
+        
+        if settings.whip_enabled:
+            whip_ingest = WhipIngest(stream_manager)
+            logger.info("📥 WHIP ingest ready at POST /whip")
+        
         logger.info("✅ NDI Bridge service ready")
         logger.info("🎥 Waiting for mobile camera streams...")
         
@@ -329,21 +474,69 @@ async def start_ndi_bridge():
 
 async def stop_ndi_bridge():
     """Stop the NDI bridge service"""
-    global stream_manager
+    global stream_manager, supervisor, return_feed, whip_ingest
     
     try:
         logger.info("🛑 Stopping NDI Bridge service...")
         
+        for source in clip_sources:
+            await source.stop()
+        clip_sources.clear()
+        
+        if return_feed:
+            await return_feed.stop()
+            return_feed = None
+        
+        if whip_ingest:
+            await whip_ingest.close()
+            whip_ingest = None
+        
         if stream_manager:
             await stream_manager.shutdown()
             stream_manager = None
         
+        if supervisor:
+            await supervisor.shutdown()
+            supervisor = None
+        
         logger.info("✅ NDI Bridge service stopped")
         
     except Exception as e:
         logger.error(f"Error stopping NDI Bridge: {e}")
 
 
+async def _start_clip_sources(house_clock: Optional[HouseClock]):
+    """Loop the CLIP_SOURCES files into NDI, paced by the house clock when one runs"""
+    for path in find_clips(settings.clip_sources):
+        source = ClipSource(
+            path,
+            clip_source_name(settings.ndi_source_prefix, path),
+            house_clock=house_clock,
+            async_send=settings.ndi_async_send,
+            default_fps=settings.house_clock_fps if house_clock else settings.default_fps
+        )
+        if await source.start():
+            clip_sources.append(source)
+
+
+async def _start_return_feed():
+    """Send RETURN_FEED_SOURCE back to the phones as a confidence monitor"""
+    global return_feed
+    if not settings.return_feed_source:
+        return
+    feed = ReturnFeed(
+        settings.return_feed_source,
+        settings.get_backend_ws_url(),
+        width=settings.return_feed_width,
+        height=settings.return_feed_height,
+        fps=settings.return_feed_fps,
+        bitrate=settings.return_feed_bitrate,
+        codec=settings.return_feed_codec
+    )
+    if await feed.start():
+        return_feed = feed
+
+
 def _on_stream_started(stream_id: str, stream_info: dict):
     """Handle stream started event"""
     device_name = stream_info.get("device_name", "Unknown")
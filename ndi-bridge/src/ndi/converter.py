@@ -7,8 +7,17 @@ import cv2
 import logging
 from typing import Tuple, Optional
 
+from processing.denoise import TemporalDenoiser
+
 logger = logging.getLogger(__name__)
 
+# 8-bit BGR -> limited-range BT.709 Y, Cb, Cr (the matrix NDI assumes for HD)
+BGR_TO_YCBCR_709 = np.array([
+    [0.0722 * 219 / 255, 0.7152 * 219 / 255, 0.2126 * 219 / 255, 16.0],
+    [0.5 * 224 / 255, -0.7152 / 1.8556 * 224 / 255, -0.2126 / 1.8556 * 224 / 255, 128.0],
+    [-0.0722 / 1.5748 * 224 / 255, -0.7152 / 1.5748 * 224 / 255, 0.5 * 224 / 255, 128.0]
+], dtype=np.float32)
+
 class NDIConverter:
     """
     Handles video format conversion for NDI output
@@ -80,7 +89,35 @@ class NDIConverter:
             return None
     
     @staticmethod
-    def optimize_for_ndi(frame: np.ndarray, target_width: int, target_height: int, quality: str = "high") -> np.ndarray:
+    def bgra_to_uyva(frame: np.ndarray, out: Optional[np.ndarray] = None) -> np.ndarray:
+        """
+        Convert a BGRA frame to NDI UYVA: a 4:2:2 UYVY plane followed by an
+        8-bit alpha plane
+        
+        Args:
+            frame: BGRA frame with even width
+            out: Destination buffer of width * height * 3 bytes (new if None)
+            
+        Returns:
+            np.ndarray: Flat uint8 UYVA buffer (UYVY stride = width * 2)
+        """
+        height, width = frame.shape[:2]
+        if out is None:
+            out = np.empty(width * height * 3, dtype=np.uint8)
+        uyvy = out[:width * height * 2].reshape(height, width, 2)
+        
+        ycbcr = cv2.transform(frame[..., :3], BGR_TO_YCBCR_709)
+        # Horizontal 2:1 chroma subsampling, averaging each pixel pair
+        chroma = cv2.resize(ycbcr[..., 1:], (width // 2, height), interpolation=cv2.INTER_AREA)
+        uyvy[..., 1] = ycbcr[..., 0]
+        uyvy[:, 0::2, 0] = chroma[..., 0]
+        uyvy[:, 1::2, 0] = chroma[..., 1]
+        out[width * height * 2:].reshape(height, width)[:] = frame[..., 3]
+        return out
+    
+    @staticmethod
+    def optimize_for_ndi(frame: np.ndarray, target_width: int, target_height: int, quality: str = "high",
+                         denoiser: Optional[TemporalDenoiser] = None) -> np.ndarray:
         """
         Optimize frame for NDI transmission
         
@@ -89,6 +126,7 @@ class NDIConverter:
             target_width: Target width
             target_height: Target height
             quality: Quality setting ("low", "medium", "high")
+            denoiser: Temporal denoiser of the stream, used for "low" quality
             
         Returns:
             np.ndarray: Optimized BGRA frame
@@ -101,8 +139,9 @@ class NDIConverter:
             
             # Apply quality optimizations
             if quality == "low":
-                # Reduce quality for lower bandwidth
-                bgra_frame = cv2.GaussianBlur(bgra_frame, (3, 3), 0)
+                # Lower bandwidth by removing frame-to-frame noise, not detail
+                if denoiser is not None:
+                    bgra_frame = denoiser.apply(bgra_frame, out=bgra_frame)
             elif quality == "high":
                 # Apply sharpening for better quality
                 kernel = np.array([[-1,-1,-1], [-1,9,-1], [-1,-1,-1]])
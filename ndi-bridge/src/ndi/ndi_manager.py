@@ -20,11 +20,17 @@ class NDIManager:
     Manages NDI output with automatic method selection
     """
     
-    def __init__(self, source_name: str, width: int = 1280, height: int = 720, fps: int = 30):
+    def __init__(self, source_name: str, width: int = 1280, height: int = 720, fps: float = 30,
+                 clock_video: bool = True, async_send: bool = True, video: bool = True,
+                 pixel_format: str = "BGRA"):
         self.source_name = source_name
         self.width = width
         self.height = height
         self.fps = fps
+        self.clock_video = clock_video
+        self.async_send = async_send
+        self.video = video  # False for audio-only sources
+        self.pixel_format = pixel_format  # BGRX for opaque, BGRA/UYVA for keyed video
         
         self.method: NDIMethod = NDIMethod.NONE
         self.sender = None
@@ -39,8 +45,8 @@ class NDIManager:
             logger.info(f"✅ Using ndi-python for {self.source_name}")
             return True
         
-        # Fall back to FFmpeg
-        if await self._try_ffmpeg():
+        # Fall back to FFmpeg (video only, it carries no audio)
+        if self.video and await self._try_ffmpeg():
             self.method = NDIMethod.FFMPEG
             logger.info(f"⚠️ Using FFmpeg fallback for {self.source_name}")
             return True
@@ -57,7 +63,11 @@ class NDIManager:
                 source_name=self.source_name,
                 width=self.width,
                 height=self.height,
-                fps=self.fps
+                fps=self.fps,
+                clock_video=self.clock_video,
+                async_send=self.async_send,
+                video=self.video,
+                pixel_format=self.pixel_format
             )
             
             if await self.sender.initialize():
@@ -83,7 +93,7 @@ class NDIManager:
                 source_name=self.source_name,
                 width=self.width,
                 height=self.height,
-                fps=self.fps
+                fps=int(round(self.fps))
             )
             
             if await self.sender.initialize():
@@ -97,18 +107,49 @@ class NDIManager:
             logger.error(f"FFmpeg error: {e}")
             return False
     
-    async def send_frame(self, frame) -> bool:
-        """Send frame using active method"""
+    async def send_frame(self, frame, timecode: Optional[float] = None) -> bool:
+        """Send frame using active method, stamped with a house clock tick if given"""
         if not self.sender:
             logger.error("No NDI sender available")
             return False
         
         try:
+            if timecode is not None and self.method == NDIMethod.NDI_PYTHON:
+                return await self.sender.send_frame(frame, timecode=timecode)
             return await self.sender.send_frame(frame)
         except Exception as e:
             logger.error(f"Error sending frame via {self.method.value}: {e}")
             return False
     
+    async def send_audio(self, samples, sample_rate: int = 48000, timecode: Optional[float] = None) -> bool:
+        """Send audio; only the NDI SDK sender carries audio"""
+        if self.method != NDIMethod.NDI_PYTHON:
+            return False
+        try:
+            return await self.sender.send_audio(samples, sample_rate, timecode=timecode)
+        except Exception as e:
+            logger.error(f"Error sending audio via {self.method.value}: {e}")
+            return False
+    
+    def update_dimensions(self, width: int, height: int):
+        """Update output dimensions on the active sender"""
+        self.width = width
+        self.height = height
+        if self.sender and hasattr(self.sender, 'update_dimensions'):
+            self.sender.update_dimensions(width, height)
+
+    def get_tally(self) -> Optional[dict]:
+        """Get NDI tally state, None if the sender cannot report it"""
+        if self.sender and hasattr(self.sender, 'get_tally'):
+            return self.sender.get_tally()
+        return None
+
+    def get_connection_count(self) -> Optional[int]:
+        """Get connected NDI receivers, None if the sender cannot report it"""
+        if self.sender and hasattr(self.sender, 'get_connection_count'):
+            return self.sender.get_connection_count()
+        return None
+
     def get_stats(self) -> dict:
         """Get sender statistics"""
         if self.sender:
@@ -9,6 +9,8 @@ import asyncio
 import time
 from datetime import datetime
 
+from ndi.converter import NDIConverter
+
 logger = logging.getLogger(__name__)
 
 # Try to import NDI library, fall back to C++ executable if not available
@@ -25,12 +27,33 @@ except ImportError:
 # We'll use a C++ executable approach to create NDI sources
 # This bypasses the ndi-python installation issues
 
+# NTSC-family rates, as the exact N/1001 fractions receivers expect
+NTSC_FRAME_RATES = {23.976: (24000, 1001), 29.97: (30000, 1001), 59.94: (60000, 1001)}
+
+
+def ndi_frame_rate(fps: float) -> Tuple[int, int]:
+    """
+    NDI frame rate numerator and denominator for a frame rate
+
+    Args:
+        fps: Frames per second, e.g. 30 or 29.97
+
+    Returns:
+        tuple: (frame_rate_N, frame_rate_D)
+    """
+    for rate, fraction in NTSC_FRAME_RATES.items():
+        if abs(fps - rate) < 0.01:
+            return fraction
+    return max(1, round(fps)), 1
+
 class NDISender:
     """
     NDI Sender for publishing video streams to NDI network
     """
     
-    def __init__(self, source_name: str, width: int = 1280, height: int = 720, fps: int = 30):
+    def __init__(self, source_name: str, width: int = 1280, height: int = 720, fps: float = 30,
+                 clock_video: bool = True, async_send: bool = True, video: bool = True,
+                 pixel_format: str = "BGRA"):
         """
         Initialize NDI sender
 
@@ -38,13 +61,28 @@ class NDISender:
             source_name: Name of the NDI source (e.g., "MobileCam_DeviceName")
             width: Video width in pixels
             height: Video height in pixels
-            fps: Frames per second
+            fps: Frames per second (29.97 and 59.94 are sent as NTSC rates)
+            clock_video: Let the SDK pace sends; off when a house clock drives us
+            async_send: Hand frames to the SDK's compression threads and return
+                at once instead of waiting for each frame to be encoded
+            video: False for an audio-only source that never sends video frames
+            pixel_format: "BGRA" or "UYVA" to carry alpha, "BGRX" for opaque video,
+                "UYVY" or "I420" for buffers already in that layout (see send_buffer)
         """
         self.source_name = source_name
         self.width = width
         self.height = height
         self.fps = fps
+        self.clock_video = clock_video
+        self.async_send = async_send
+        self.video = video
+        self.pixel_format = pixel_format
         self.frame_duration = 1.0 / fps  # Duration of one frame in seconds
+        
+        # Async sends read the buffer until the next send, keep it alive
+        self.in_flight_frame: Optional[np.ndarray] = None
+        self.ndi_audio_frame = None
+        self.audio_blocks = 0
 
         # NDI objects (will be initialized when NDI SDK is available)
         self.ndi_send = None
@@ -59,7 +97,10 @@ class NDISender:
         self.last_frame_time = 0
         self.frame_count = 0
 
-        logger.info(f"NDI Sender initialized: {source_name} ({width}x{height}@{fps}fps)")
+        if video:
+            logger.info(f"NDI Sender initialized: {source_name} ({width}x{height}@{fps}fps)")
+        else:
+            logger.info(f"NDI Sender initialized: {source_name} (audio only)")
         if self.use_cpp_executable:
             logger.info("Using C++ executable approach for NDI")
     
@@ -72,6 +113,9 @@ class NDISender:
         """
         try:
             if not NDI_AVAILABLE:
+                if not self.video:
+                    logger.warning("NDI library not available, audio-only sources need the SDK")
+                    return False
                 logger.warning("NDI library not available, using C++ executable approach")
                 return await self._initialize_cpp_executable()
             
@@ -87,7 +131,7 @@ class NDISender:
             # Create NDI send settings
             send_settings = ndi.SendCreate()
             send_settings.ndi_name = self.source_name
-            send_settings.clock_video = True
+            send_settings.clock_video = self.clock_video
             send_settings.clock_audio = False
             
             # Create NDI sender
@@ -96,17 +140,21 @@ class NDISender:
                 logger.error(f"Failed to create NDI sender: {self.source_name}")
                 return False
             
+            if not self.video:
+                self.is_initialized = True
+                logger.info(f"NDI audio-only sender '{self.source_name}' initialized successfully")
+                return True
+            
             # Create video frame structure
             self.ndi_video_frame = ndi.VideoFrameV2()
             self.ndi_video_frame.xres = self.width
             self.ndi_video_frame.yres = self.height
-            self.ndi_video_frame.FourCC = ndi.FOURCC_VIDEO_TYPE_BGRA
-            self.ndi_video_frame.frame_rate_N = self.fps
-            self.ndi_video_frame.frame_rate_D = 1
+            self.ndi_video_frame.FourCC = getattr(ndi, f"FOURCC_VIDEO_TYPE_{self.pixel_format}")
+            self.ndi_video_frame.frame_rate_N, self.ndi_video_frame.frame_rate_D = ndi_frame_rate(self.fps)
             self.ndi_video_frame.picture_aspect_ratio = self.width / self.height
             self.ndi_video_frame.frame_format_type = ndi.FRAME_FORMAT_TYPE_PROGRESSIVE
             self.ndi_video_frame.timecode = ndi.SEND_TIMECODE_SYNTHESIZE
-            self.ndi_video_frame.line_stride_in_bytes = self.width * 4  # BGRA = 4 bytes per pixel
+            self.ndi_video_frame.line_stride_in_bytes = self._line_stride(self.width)
             
             # Allocate data buffer
             self.frame_data = None
@@ -169,12 +217,13 @@ class NDISender:
             logger.error(f"Failed to initialize C++ NDI executable: {e}")
             return False
     
-    async def send_frame(self, frame: np.ndarray) -> bool:
+    async def send_frame(self, frame: np.ndarray, timecode: Optional[float] = None) -> bool:
         """
         Send video frame to NDI network
 
         Args:
             frame: Video frame as numpy array (BGR format, uint8)
+            timecode: Wall-clock time of the house clock tick, None to let NDI synthesize
 
         Returns:
             bool: True if frame sent successfully
@@ -192,11 +241,11 @@ class NDISender:
             return False
         
         try:
+            import cv2
+            
             # Convert BGR to BGRA if needed
             if frame.shape[2] == 3:  # BGR
-                bgra_frame = np.zeros((self.height, self.width, 4), dtype=np.uint8)
-                bgra_frame[:, :, :3] = frame  # Copy BGR channels
-                bgra_frame[:, :, 3] = 255     # Set alpha to 255 (opaque)
+                bgra_frame = cv2.cvtColor(frame, cv2.COLOR_BGR2BGRA)
             elif frame.shape[2] == 4:  # BGRA
                 bgra_frame = frame
             else:
@@ -207,15 +256,15 @@ class NDISender:
             if bgra_frame.shape[:2] != (self.height, self.width):
                 logger.warning(f"Frame size mismatch: expected {(self.height, self.width)}, got {bgra_frame.shape[:2]}")
                 # Resize frame to match expected dimensions
-                import cv2
                 bgra_frame = cv2.resize(bgra_frame, (self.width, self.height))
             
-            # Allocate data buffer if needed
-            if self.frame_data is None or self.frame_data.shape != bgra_frame.shape:
-                self.frame_data = bgra_frame.copy()
-            
-            # Copy frame data
-            self.frame_data[:] = bgra_frame
+            if self.pixel_format == "UYVA":
+                # Keyed frames: 4:2:2 plus alpha plane, NDI's native alpha format
+                self.frame_data = NDIConverter.bgra_to_uyva(bgra_frame)
+            else:
+                # Pipelines hand over a fresh BGRA frame each time, so it is sent
+                # in place; a 4K copy alone costs several milliseconds
+                self.frame_data = np.ascontiguousarray(bgra_frame)
             
             # Set frame data pointer
             self.ndi_video_frame.data = self.frame_data.ctypes.data
@@ -223,9 +272,18 @@ class NDISender:
             # Set timestamp
             current_time = datetime.now()
             self.ndi_video_frame.timestamp = int(current_time.timestamp() * 1000000)  # Microseconds
+            if timecode is not None:
+                # Shared tick timecode (100 ns units) so receivers see aligned sources
+                self.ndi_video_frame.timecode = int(timecode * 10_000_000)
             
             # Send frame
-            ndi.send_send_video_v2(self.ndi_send, self.ndi_video_frame)
+            if self.async_send:
+                # Returns once the previous async frame is released; the SDK
+                # compresses this one on its own threads while we prepare the next
+                ndi.send_send_video_async_v2(self.ndi_send, self.ndi_video_frame)
+                self.in_flight_frame = self.frame_data
+            else:
+                ndi.send_send_video_v2(self.ndi_send, self.ndi_video_frame)
             
             self.frame_count += 1
             self.last_frame_time = current_time.timestamp()
@@ -240,6 +298,88 @@ class NDISender:
             logger.error(f"Failed to send frame: {e}")
             return False
 
+    async def send_buffer(self, buffer: np.ndarray, timecode: Optional[float] = None) -> bool:
+        """
+        Send a frame already laid out in the sender's pixel format, without
+        conversion or copy: the SDK reads straight from `buffer`, e.g. the
+        memory-mapped pages of a clip file
+
+        Args:
+            buffer: Contiguous frame data (line stride as for the pixel format)
+            timecode: Wall-clock time of the house clock tick, None to let NDI synthesize
+
+        Returns:
+            bool: True if frame sent successfully
+        """
+        if not self.is_initialized:
+            logger.warning("NDI sender not initialized")
+            return False
+
+        if not NDI_AVAILABLE:
+            # The C++ executable only takes BGRA frames, not pre-laid-out buffers
+            logger.warning("NDI library not available, send_buffer needs the SDK")
+            return False
+
+        try:
+            self.frame_data = buffer
+            self.ndi_video_frame.data = buffer.ctypes.data
+            current_time = datetime.now()
+            self.ndi_video_frame.timestamp = int(current_time.timestamp() * 1000000)
+            if timecode is not None:
+                self.ndi_video_frame.timecode = int(timecode * 10_000_000)
+
+            if self.async_send:
+                # The buffer must stay readable until the next send
+                ndi.send_send_video_async_v2(self.ndi_send, self.ndi_video_frame)
+                self.in_flight_frame = buffer
+            else:
+                ndi.send_send_video_v2(self.ndi_send, self.ndi_video_frame)
+
+            self.frame_count += 1
+            self.last_frame_time = current_time.timestamp()
+            return True
+
+        except Exception as e:
+            logger.error(f"Failed to send buffer: {e}")
+            return False
+
+    async def send_audio(self, samples: np.ndarray, sample_rate: int = 48000,
+                         timecode: Optional[float] = None) -> bool:
+        """
+        Send audio to the NDI network
+
+        Args:
+            samples: float32 (frames, channels)
+            sample_rate: Sample rate in Hz
+            timecode: Wall-clock time of the house clock tick, None to let NDI synthesize
+
+        Returns:
+            bool: True if the audio was sent
+        """
+        if not NDI_AVAILABLE or not self.ndi_send:
+            return False
+
+        try:
+            if self.ndi_audio_frame is None:
+                self.ndi_audio_frame = ndi.AudioFrameV2()
+            frame = self.ndi_audio_frame
+            # NDI audio is planar float, one channel after the other
+            planar = np.ascontiguousarray(samples.T, dtype=np.float32)
+            frame.sample_rate = sample_rate
+            frame.no_channels = planar.shape[0]
+            frame.no_samples = planar.shape[1]
+            frame.channel_stride_in_bytes = planar.shape[1] * 4
+            frame.timecode = int(timecode * 10_000_000) if timecode is not None else ndi.SEND_TIMECODE_SYNTHESIZE
+            frame.data = planar
+
+            ndi.send_send_audio_v2(self.ndi_send, frame)
+            self.audio_blocks += 1
+            return True
+
+        except Exception as e:
+            logger.error(f"Failed to send audio: {e}")
+            return False
+
     async def _send_frame_cpp_executable(self, frame: np.ndarray) -> bool:
         """
         Send frame using C++ executable
@@ -281,9 +421,55 @@ class NDISender:
             self.height = height
             self.ndi_video_frame.xres = width
             self.ndi_video_frame.yres = height
-            self.ndi_video_frame.line_stride_in_bytes = width * 4
+            self.ndi_video_frame.line_stride_in_bytes = self._line_stride(width)
             self.ndi_video_frame.picture_aspect_ratio = width / height
     
+    def _line_stride(self, width: int) -> int:
+        """Bytes per row: UYVY is 2 per pixel (UYVA's alpha follows as its own plane),
+        I420 gives the luma plane stride, BGRA/BGRX 4"""
+        if self.pixel_format in ("UYVA", "UYVY"):
+            return width * 2
+        if self.pixel_format == "I420":
+            return width
+        return width * 4
+    
+    def get_tally(self) -> Optional[dict]:
+        """
+        Get tally state reported by NDI receivers
+        
+        Returns:
+            dict: on_program / on_preview flags, or None if unavailable
+        """
+        if not NDI_AVAILABLE or not self.ndi_send:
+            return None
+        
+        try:
+            result = ndi.send_get_tally(self.ndi_send, 0)
+            tally = result[1] if isinstance(result, tuple) else result
+            return {
+                "on_program": bool(tally.on_program),
+                "on_preview": bool(tally.on_preview)
+            }
+        except Exception as e:
+            logger.debug(f"Failed to get tally for {self.source_name}: {e}")
+            return None
+    
+    def get_connection_count(self) -> Optional[int]:
+        """
+        Get the number of NDI receivers connected to this source
+        
+        Returns:
+            int: Connection count, or None if unavailable
+        """
+        if not NDI_AVAILABLE or not self.ndi_send:
+            return None
+        
+        try:
+            return int(ndi.send_get_no_connections(self.ndi_send, 0))
+        except Exception as e:
+            logger.debug(f"Failed to get connections for {self.source_name}: {e}")
+            return None
+    
     def get_stats(self) -> dict:
         """
         Get sender statistics
@@ -364,7 +550,10 @@ class NDISender:
                 self.is_initialized = False
                 logger.info(f"C++ NDI sender '{self.source_name}' closed")
             elif self.ndi_send and self.is_initialized:
-                self.ndi.send_destroy(self.ndi_send)
+                # Destroy waits for a pending async frame, release its buffer after
+                ndi.send_destroy(self.ndi_send)
+                self.in_flight_frame = None
+                self.frame_data = None
                 self.ndi_send = None
                 self.is_initialized = False
                 logger.info(f"NDI sender '{self.source_name}' closed")
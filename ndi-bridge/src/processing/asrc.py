@@ -0,0 +1,303 @@
+"""
+ASRC - Asynchronous sample-rate conversion that locks a phone's audio clock
+to the bridge clock
+"""
+
+import logging
+import math
+import threading
+from collections import deque
+from typing import Deque, Optional, Tuple
+
+import numpy as np
+
+logger = logging.getLogger(__name__)
+
+
+class PolyphaseResampler:
+    """
+    Windowed-sinc polyphase resampler with a continuously variable ratio.
+
+    The filter bank holds `phases` sub-sample shifts of a Kaiser-windowed
+    sinc; coefficients between two phases are linearly interpolated, so
+    any ratio near 1 is supported without recomputing filters. All output
+    samples of a read are computed at once as one gathered multiply-add
+    (numpy dispatches it to SIMD kernels), not sample by sample.
+
+    Input is written in, output is read at a step of `ratio` input samples
+    per output sample; the unread input doubles as the ASRC FIFO.
+    """
+
+    def __init__(self, channels: int = 2, taps: int = 32, phases: int = 128,
+                 cutoff: float = 0.45, beta: float = 8.0):
+        """
+        Initialize resampler
+
+        Args:
+            channels: Interleaved channel count
+            taps: Filter length in input samples (even)
+            phases: Sub-sample resolution of the filter bank
+            cutoff: Passband edge as a fraction of the input rate (0.5 = Nyquist)
+            beta: Kaiser window shape
+        """
+        self.channels = channels
+        self.taps = taps
+        self.phases = phases
+        self.half = taps // 2
+
+        # bank[p, k] weights input sample (n - half + 1 + k) for an output at n + p / phases
+        offsets = np.arange(phases + 1)[:, None] / phases + self.half - 1 - np.arange(taps)[None, :]
+        window = np.kaiser(2 * self.half * phases + 1, beta)
+        window_index = np.clip(np.round((offsets + self.half) * phases).astype(int), 0, len(window) - 1)
+        bank = 2 * cutoff * np.sinc(2 * cutoff * offsets) * window[window_index]
+        self.bank = (bank / bank.sum(axis=1, keepdims=True)).astype(np.float32)
+        self._tap_offsets = np.arange(taps) - self.half + 1
+
+        self.reset()
+
+    def reset(self):
+        """Drop buffered input; the next output starts on silence history"""
+        self._buffer = np.zeros((self.half - 1, self.channels), dtype=np.float32)
+        self._time = float(self.half - 1)  # input position of the next output sample
+
+    def write(self, samples: np.ndarray):
+        """
+        Append input samples
+
+        Args:
+            samples: float32 array (frames, channels)
+        """
+        self._buffer = np.concatenate((self._buffer, samples.astype(np.float32, copy=False)))
+
+    def available(self) -> float:
+        """Unread input in samples, the FIFO level"""
+        return len(self._buffer) - self._time
+
+    def drop(self, count: int):
+        """Skip input samples (overflow recovery)"""
+        self._time += count
+        self._compact()
+
+    def read(self, count: int, ratio: float = 1.0) -> np.ndarray:
+        """
+        Produce up to `count` output samples
+
+        Args:
+            count: Output samples wanted
+            ratio: Input samples consumed per output sample
+
+        Returns:
+            np.ndarray: float32 (n, channels), n < count when input runs out
+        """
+        last_center = len(self._buffer) - self.half - 1
+        possible = int(math.floor((last_center - self._time) / ratio)) + 1
+        count = max(0, min(count, possible))
+        if count == 0:
+            return np.zeros((0, self.channels), dtype=np.float32)
+
+        positions = self._time + ratio * np.arange(count)
+        centers = np.floor(positions).astype(np.int64)
+        phase = (positions - centers) * self.phases
+        lower = phase.astype(np.int64)
+        weight = (phase - lower).astype(np.float32)[:, None]
+        coefficients = self.bank[lower] * (1 - weight) + self.bank[lower + 1] * weight
+
+        frames = self._buffer[centers[:, None] + self._tap_offsets[None, :]]
+        output = np.einsum('kt,ktc->kc', coefficients, frames, optimize=True)
+
+        self._time += ratio * count
+        self._compact()
+        return output.astype(np.float32, copy=False)
+
+    def _compact(self):
+        # Keep the history the next output's filter still reaches back into
+        keep_from = int(math.floor(self._time)) - self.half + 1
+        if keep_from > 4096:
+            self._buffer = self._buffer[keep_from:]
+            self._time -= keep_from
+
+
+class DriftEstimator:
+    """
+    Estimates how fast a sender's media clock runs against the local clock.
+
+    Transit time (arrival minus RTP time) drifts linearly with the clock
+    offset. Network jitter only ever adds delay, so the minimum transit of
+    each bucket is a clean sample; a least-squares line through the bucket
+    minima of the last `window` seconds gives the drift in ppm.
+    """
+
+    def __init__(self, clock_rate: int = 48000, bucket: float = 1.0, window: float = 60.0,
+                 min_buckets: int = 5):
+        """
+        Initialize drift estimator
+
+        Args:
+            clock_rate: RTP clock rate
+            bucket: Seconds per minimum-transit bucket
+            window: Seconds of history in the fit
+            min_buckets: Buckets needed before an estimate is reported
+        """
+        self.clock_rate = clock_rate
+        self.bucket = bucket
+        self.min_buckets = min_buckets
+        self.buckets: Deque[Tuple[float, float]] = deque(maxlen=max(min_buckets, int(window / bucket)))
+
+        self._base_rtp: Optional[int] = None
+        self._last_rtp = 0
+        self._unwrapped = 0
+        self._bucket_start: Optional[float] = None
+        self._bucket_min: Optional[Tuple[float, float]] = None
+        self.ppm = 0.0
+
+    def observe(self, rtp_timestamp: int, arrival: float):
+        """
+        Add one packet's timing
+
+        Args:
+            rtp_timestamp: 32-bit RTP timestamp
+            arrival: Local arrival time in seconds (kernel timestamp preferred)
+        """
+        if self._base_rtp is None:
+            self._base_rtp = self._last_rtp = rtp_timestamp
+        delta = (rtp_timestamp - self._last_rtp) & 0xFFFFFFFF
+        if delta >= 0x80000000:
+            delta -= 0x100000000  # reordered packet
+        self._unwrapped += delta
+        self._last_rtp = rtp_timestamp
+
+        media_time = self._unwrapped / self.clock_rate
+        transit = arrival - media_time
+        if self._bucket_start is None:
+            self._bucket_start = arrival
+
+        if self._bucket_min is None or transit < self._bucket_min[1]:
+            self._bucket_min = (arrival, transit)
+
+        if arrival - self._bucket_start >= self.bucket:
+            self.buckets.append(self._bucket_min)
+            self._bucket_start = arrival
+            self._bucket_min = None
+            self._fit()
+
+    def _fit(self):
+        if len(self.buckets) < self.min_buckets:
+            return
+        points = np.array(self.buckets)
+        times = points[:, 0] - points[0, 0]
+        slope = np.polyfit(times, points[:, 1], 1)[0]
+        # Transit growing means the sender's clock is slow
+        self.ppm = float(-slope / (1.0 + slope) * 1e6)
+
+    @property
+    def ready(self) -> bool:
+        return len(self.buckets) >= self.min_buckets
+
+
+class AudioClockConverter:
+    """
+    ASRC between a remote audio clock and local output pacing.
+
+    Decoded samples are pushed as they arrive; the output side pulls fixed
+    blocks on the local clock. The resample ratio is the measured drift
+    (feed-forward) plus a small correction that holds FIFO occupancy at
+    the target, so the buffer neither creeps toward an underrun nor grows
+    latency over a long show and never needs a reset.
+    """
+
+    def __init__(self, sample_rate: int = 48000, channels: int = 2, target_ms: float = 40.0,
+                 max_correction_ppm: float = 2000.0, gain_ppm: float = 500.0):
+        """
+        Initialize converter
+
+        Args:
+            sample_rate: Input and output sample rate
+            channels: Channel count
+            target_ms: FIFO occupancy held by the control loop
+            max_correction_ppm: Limit of the ratio away from 1
+            gain_ppm: Ratio correction per 100% occupancy error
+        """
+        self.sample_rate = sample_rate
+        self.channels = channels
+        self.target = sample_rate * target_ms / 1000.0
+        self.max_correction = max_correction_ppm * 1e-6
+        self.gain = gain_ppm * 1e-6
+
+        self.resampler = PolyphaseResampler(channels)
+        self.drift = DriftEstimator(sample_rate)
+        self._lock = threading.Lock()
+        self._priming = True
+        self._smoothed_level = self.target
+
+        self.stats = {
+            "underruns": 0,
+            "overflows": 0,
+            "ratio_ppm": 0.0,
+            "drift_ppm": 0.0,
+            "level_ms": 0.0
+        }
+
+    def observe(self, rtp_timestamp: int, arrival: float):
+        """Feed RTP timing of a received packet to the drift estimate"""
+        with self._lock:
+            self.drift.observe(rtp_timestamp, arrival)
+
+    def push(self, samples: np.ndarray):
+        """
+        Queue decoded samples (any thread)
+
+        Args:
+            samples: float32 (frames, channels)
+        """
+        with self._lock:
+            self.resampler.write(samples)
+            # Way past target (e.g. after a sender stall and burst): cut back
+            excess = self.resampler.available() - 4 * self.target
+            if excess > 0:
+                self.resampler.drop(int(excess + self.target))
+                self.stats["overflows"] += 1
+
+    def ratio(self) -> float:
+        """Input samples per output sample for the next block"""
+        error = (self._smoothed_level - self.target) / self.target
+        correction = self.drift.ppm * 1e-6 + self.gain * error
+        correction = max(-self.max_correction, min(self.max_correction, correction))
+        return 1.0 + correction
+
+    def pull(self, count: int) -> np.ndarray:
+        """
+        Take one output block on the local clock
+
+        Args:
+            count: Samples wanted
+
+        Returns:
+            np.ndarray: float32 (count, channels); silence while priming
+        """
+        with self._lock:
+            level = self.resampler.available()
+            if self._priming:
+                if level < self.target:
+                    return np.zeros((count, self.channels), dtype=np.float32)
+                self._priming = False
+                self._smoothed_level = level
+
+            # Block-to-block level is sawtoothed by packet arrival; smooth it
+            self._smoothed_level += (level - self._smoothed_level) * 0.05
+            ratio = self.ratio()
+            output = self.resampler.read(count, ratio)
+
+            self.stats["ratio_ppm"] = (ratio - 1.0) * 1e6
+            self.stats["drift_ppm"] = self.drift.ppm
+            self.stats["level_ms"] = self.resampler.available() * 1000.0 / self.sample_rate
+
+            if len(output) < count:
+                # Ran dry: pad, then rebuild the cushion before resuming
+                self.stats["underruns"] += 1
+                self._priming = True
+                output = np.concatenate((output, np.zeros((count - len(output), self.channels), dtype=np.float32)))
+            return output
+
+    def get_stats(self) -> dict:
+        """Get converter statistics"""
+        return {**self.stats, "target_ms": self.target * 1000.0 / self.sample_rate, "drift_ready": self.drift.ready}
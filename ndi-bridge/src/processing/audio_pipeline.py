@@ -0,0 +1,134 @@
+"""
+Audio Pipeline - Paces a phone's decoded audio out to NDI on the local clock
+through the ASRC
+"""
+
+import asyncio
+import logging
+import time
+from typing import Optional
+
+import numpy as np
+
+from processing.asrc import AudioClockConverter
+from utils.metrics import record_audio_clock
+
+logger = logging.getLogger(__name__)
+
+
+class AudioPipeline:
+    """
+    Audio path of one stream: decoder -> ASRC FIFO -> fixed NDI audio blocks.
+
+    Blocks leave on the bridge's clock (the house clock when one runs,
+    otherwise a monotonic pacer), never on the phone's, and the ASRC
+    absorbs the difference between the two.
+    """
+
+    def __init__(self, stream_id: str, ndi_sender, sample_rate: int = 48000, channels: int = 2,
+                 block_samples: int = 480, target_ms: float = 40.0):
+        """
+        Initialize audio pipeline
+
+        Args:
+            stream_id: Stream identifier
+            ndi_sender: NDI manager/sender with send_audio()
+            sample_rate: Sample rate of decoder and NDI output
+            channels: Channel count
+            block_samples: Samples per NDI audio frame when self-paced
+            target_ms: ASRC buffer occupancy
+        """
+        self.stream_id = stream_id
+        self.ndi_sender = ndi_sender
+        self.sample_rate = sample_rate
+        self.channels = channels
+        self.block_samples = block_samples
+
+        self.converter = AudioClockConverter(sample_rate, channels, target_ms)
+        self.house_clock = None
+        self.clock_subscription: Optional[int] = None
+        self.task: Optional[asyncio.Task] = None
+        self.is_running = False
+        self._tick_remainder = 0.0
+        self._last_report = 0.0
+        self._reported_underruns = 0
+
+        self.stats = {
+            "blocks_sent": 0,
+            "send_failures": 0,
+            "samples_received": 0
+        }
+
+    def push(self, samples: np.ndarray):
+        """Queue decoded samples (called on the decoder thread)"""
+        self.stats["samples_received"] += len(samples)
+        self.converter.push(samples)
+
+    def observe(self, rtp_timestamp: int, arrival: float):
+        """RTP timing of a received packet (called on the receive thread)"""
+        self.converter.observe(rtp_timestamp, arrival)
+
+    async def start(self):
+        """Start sending audio"""
+        self.is_running = True
+        if self.house_clock:
+            self.clock_subscription = self.house_clock.subscribe(self._on_tick)
+        else:
+            self.task = asyncio.create_task(self._run())
+        logger.info(f"🎙️ Audio pipeline started for {self.stream_id}")
+
+    async def stop(self):
+        """Stop sending audio"""
+        self.is_running = False
+        if self.house_clock and self.clock_subscription is not None:
+            self.house_clock.unsubscribe(self.clock_subscription)
+            self.clock_subscription = None
+        if self.task:
+            self.task.cancel()
+            try:
+                await self.task
+            except asyncio.CancelledError:
+                pass
+            self.task = None
+
+    async def _run(self):
+        """Send one block per block interval on the monotonic clock"""
+        interval = self.block_samples / self.sample_rate
+        next_time = time.monotonic()
+        while self.is_running:
+            next_time += interval
+            delay = next_time - time.monotonic()
+            if delay > 0:
+                await asyncio.sleep(delay)
+            elif delay < -4 * interval:
+                # Event loop stalled: resume the grid instead of bursting
+                next_time = time.monotonic()
+            await self._send(self.block_samples)
+
+    async def _on_tick(self, index: int, tick_time: float):
+        """Send the audio of one video frame period on a house clock tick"""
+        exact = self.sample_rate / self.house_clock.fps + self._tick_remainder
+        count = int(exact)
+        self._tick_remainder = exact - count
+        await self._send(count, tick_time)
+
+    async def _send(self, count: int, timecode: Optional[float] = None):
+        block = self.converter.pull(count)
+        if await self.ndi_sender.send_audio(block, self.sample_rate, timecode=timecode):
+            self.stats["blocks_sent"] += 1
+        else:
+            self.stats["send_failures"] += 1
+
+        now = time.monotonic()
+        if now - self._last_report >= 1.0:
+            self._last_report = now
+            stats = self.converter.stats
+            record_audio_clock(
+                self.stream_id, stats["drift_ppm"], stats["level_ms"] / 1000.0,
+                stats["underruns"] - self._reported_underruns
+            )
+            self._reported_underruns = stats["underruns"]
+
+    def get_stats(self) -> dict:
+        """Get audio statistics"""
+        return {**self.stats, "asrc": self.converter.get_stats()}
@@ -0,0 +1,285 @@
+"""
+Band Pipeline - Scales, converts, colour-corrects, denoises and keys
+frames to BGRA in row bands on a thread pool, starting on each band as
+soon as its source rows are available
+"""
+
+import asyncio
+import logging
+import math
+import threading
+from concurrent.futures import Future
+from typing import List, Optional, Set, Tuple
+
+import cv2
+import numpy as np
+
+from processing.denoise import TemporalDenoiser
+from processing.keyer import ChromaKeyer
+from processing.lut3d import LUT3D
+from processing.scheduler import CpuMeter, DeadlineScheduler, get_frame_scheduler
+
+logger = logging.getLogger(__name__)
+
+LARGE_FRAME_PIXELS = 1920 * 1080
+
+
+class BandConverter:
+    """
+    Row-banded BGR(A) -> BGRA scaler/converter.
+
+    Band edges fall on rows where output and source grids line up, and
+    each band is resized from its own source slice plus one aligned step
+    of margin, so the stitched frame is identical to a full-frame
+    cv2.resize. Bands are handed out as soon as the source rows they
+    sample from are ready: a decoder that reports row progress overlaps
+    conversion with decode, a whole frame simply makes every band ready
+    at once. An optional 3D LUT and temporal denoiser are applied to each
+    band right after it is converted, while the band is still in cache.
+
+    An optional chroma keyer runs in the same band step. Its matte blur
+    reads a few rows of the neighbouring bands, so a band is keyed by
+    whichever worker converts the last band it depends on.
+    """
+
+    def __init__(self, bands: int = 4, interpolation: int = cv2.INTER_AREA,
+                 scheduler: Optional[DeadlineScheduler] = None, cpu_meter: Optional[CpuMeter] = None):
+        """
+        Initialize band converter
+
+        Args:
+            bands: Number of row bands per output frame
+            interpolation: OpenCV interpolation used for scaling
+            scheduler: Worker pool (defaults to the shared frame scheduler);
+                OpenCV releases the GIL, so bands run truly in parallel
+            cpu_meter: Charged with the workers' CPU time of every band, None for none
+        """
+        self.bands = max(1, bands)
+        self.interpolation = interpolation
+        self.scheduler = scheduler or get_frame_scheduler()
+        self.cpu_meter = cpu_meter
+
+        self._geometry: Optional[Tuple[int, int, int, int]] = None
+        # (out_y0, out_y1, src_y0, src_y1, crop_top) per band, src rows include margin
+        self._band_plan: List[Tuple[int, int, int, int, int]] = []
+
+        # Per-frame state
+        self._source: Optional[np.ndarray] = None
+        self._output: Optional[np.ndarray] = None
+        self._width = 0
+        self._deadline: Optional[float] = None
+        self._lut: Optional[LUT3D] = None
+        self._denoiser: Optional[TemporalDenoiser] = None
+        self._denoise_fresh = False
+        self._keyer: Optional[ChromaKeyer] = None
+        self._keyed: Optional[np.ndarray] = None
+        # Bands each band's key reads from, and the bands waiting on each band
+        self._key_sources: List[Set[int]] = []
+        self._key_dependents: List[List[int]] = []
+        self._converted: Set[int] = set()
+        self._key_lock = threading.Lock()
+        self._kind = "convert"
+        self._next_band = 0
+        self._futures: List[Future] = []
+
+    def _plan(self, src_width: int, src_height: int, width: int, height: int):
+        """Split output rows into bands aligned to the source grid"""
+        geometry = (src_width, src_height, width, height)
+        if geometry == self._geometry:
+            return
+
+        # Above 1080p one band per worker, so a 4K frame uses every core
+        bands = self.bands
+        if max(src_width * src_height, width * height) > LARGE_FRAME_PIXELS:
+            bands = max(bands, self.scheduler.workers)
+
+        common = math.gcd(src_height, height)
+        out_step, src_step = height // common, src_height // common
+        rows_per_band = -(-height // bands)
+        rows_per_band = max(out_step, -(-rows_per_band // out_step) * out_step)
+
+        plan = []
+        for y0 in range(0, height, rows_per_band):
+            y1 = min(height, y0 + rows_per_band)
+            # One aligned step of context on each side keeps the filter
+            # taps at band edges identical to a full-frame resize
+            margin_top = out_step if y0 > 0 else 0
+            margin_bottom = out_step if y1 < height else 0
+            src_y0 = (y0 - margin_top) * src_height // height
+            src_y1 = (y1 + margin_bottom) * src_height // height
+            plan.append((y0, y1, src_y0, src_y1, margin_top))
+
+        self._geometry = geometry
+        self._band_plan = plan
+
+    def begin_frame(self, src_shape: Tuple[int, ...], width: int, height: int,
+                    deadline: Optional[float] = None, lut: Optional[LUT3D] = None,
+                    denoiser: Optional[TemporalDenoiser] = None,
+                    keyer: Optional[ChromaKeyer] = None) -> np.ndarray:
+        """
+        Start a frame
+
+        Args:
+            src_shape: Shape of the source frame (height, width, channels)
+            width: Output width
+            height: Output height
+            deadline: time.monotonic() by which the frame must be converted
+            lut: Colour correction applied to every band, None for none
+            denoiser: Temporal denoiser of the stream applied to every band, None for none
+            keyer: Chroma keyer applied to every band, None for none
+
+        Returns:
+            np.ndarray: BGRA output buffer that bands are written into (keyed
+                bands go to a second buffer, returned by finish)
+        """
+        self._plan(src_shape[1], src_shape[0], width, height)
+        self._output = np.empty((height, width, 4), dtype=np.uint8)
+        self._width = width
+        self._deadline = deadline
+        self._lut = lut
+        self._denoiser = denoiser
+        if denoiser is not None:
+            self._denoise_fresh = not denoiser.prepare((height, width, 4))
+        self._keyer = keyer
+        if keyer is not None:
+            self._keyed = np.empty_like(self._output)
+            self._plan_key(keyer.margin)
+        self._converted = set()
+        self._kind = f"convert:{src_shape[1]}x{src_shape[0]}->{width}x{height}"
+        self._next_band = 0
+        self._futures = []
+        return self._output
+
+    def _plan_key(self, margin: int):
+        """Work out which bands the key of each band reads rows from"""
+        plan = self._band_plan
+        self._key_sources = [
+            {j for j, other in enumerate(plan) if other[0] < y1 + margin and other[1] > y0 - margin}
+            for y0, y1, *_ in plan
+        ]
+        self._key_dependents = [
+            [i for i, sources in enumerate(self._key_sources) if j in sources] for j in range(len(plan))
+        ]
+
+    def rows_ready(self, source: np.ndarray, rows: int):
+        """
+        Schedule every band whose source rows have been decoded
+
+        Args:
+            source: Source frame buffer (rows below `rows` may still be in flight)
+            rows: Number of complete source rows from the top
+        """
+        self._source = source
+        while self._next_band < len(self._band_plan) and self._band_plan[self._next_band][3] <= rows:
+            band = self._band_plan[self._next_band]
+            self._futures.append(self.scheduler.submit(
+                self._convert_band, source, self._next_band, deadline=self._deadline, kind=self._kind,
+                meter=self.cpu_meter
+            ))
+            self._next_band += 1
+
+    def finish(self) -> np.ndarray:
+        """
+        Wait for all bands of the current frame
+
+        Returns:
+            np.ndarray: Complete BGRA frame
+
+        Raises:
+            DeadlineMissed: If a band was dropped for the frame deadline
+        """
+        self.rows_ready(self._source, self._source.shape[0])
+        try:
+            for future in self._futures:
+                future.result()
+        except BaseException:
+            # Bands read the converter's per-frame state, so none of this
+            # frame's bands may still run once the next frame begins
+            for future in self._cancel_pending():
+                future.exception()
+            raise
+        return self._keyed if self._keyer is not None else self._output
+
+    async def finish_async(self) -> np.ndarray:
+        """Wait for all bands without blocking the event loop"""
+        self.rows_ready(self._source, self._source.shape[0])
+        try:
+            await asyncio.gather(*(asyncio.wrap_future(future) for future in self._futures))
+        except BaseException:
+            running = self._cancel_pending()
+            if running:
+                await asyncio.wait([asyncio.wrap_future(future) for future in running])
+            raise
+        return self._keyed if self._keyer is not None else self._output
+
+    def _cancel_pending(self) -> List[Future]:
+        """Cancel the current frame's queued bands, returning those already running"""
+        return [future for future in self._futures if not future.cancel() and not future.done()]
+
+    def _convert_band(self, source: np.ndarray, index: int):
+        y0, y1, src_y0, src_y1, crop_top = self._band_plan[index]
+        band_source = source[src_y0:src_y1]
+        if source.shape[:2] != self._output.shape[:2]:
+            band_height = (src_y1 - src_y0) * self._output.shape[0] // source.shape[0]
+            band_source = cv2.resize(band_source, (self._width, band_height), interpolation=self.interpolation)
+        band_source = band_source[crop_top:crop_top + y1 - y0]
+
+        output = self._output[y0:y1]
+        channels = band_source.shape[2] if band_source.ndim == 3 else 1
+        if channels == 4:
+            output[:] = band_source
+        elif channels == 3:
+            cv2.cvtColor(band_source, cv2.COLOR_BGR2BGRA, dst=output)
+        else:
+            cv2.cvtColor(band_source, cv2.COLOR_GRAY2BGRA, dst=output)
+        if self._lut is not None:
+            self._lut.apply(output, out=output)
+        if self._denoiser is not None:
+            self._denoiser.apply_rows(output, output, y0, y1, self._denoise_fresh)
+        if self._keyer is not None:
+            self._key_bands(index)
+
+    def _key_bands(self, converted: int):
+        """Key every band whose blur context is complete now that `converted` is"""
+        with self._key_lock:
+            self._converted.add(converted)
+            ready = [i for i in self._key_dependents[converted] if self._key_sources[i] <= self._converted]
+        # Exactly one worker sees each band's last source convert, so no band is keyed twice
+        for index in ready:
+            y0, y1 = self._band_plan[index][:2]
+            self._keyer.apply(self._output, self._keyed, (y0, y1))
+
+    def convert(self, frame: np.ndarray, width: int, height: int, deadline: Optional[float] = None,
+                lut: Optional[LUT3D] = None, denoiser: Optional[TemporalDenoiser] = None,
+                keyer: Optional[ChromaKeyer] = None) -> np.ndarray:
+        """
+        Scale and convert a whole frame
+
+        Args:
+            frame: BGR, BGRA or grayscale frame
+            width: Output width
+            height: Output height
+            deadline: time.monotonic() by which the frame must be converted
+            lut: Colour correction applied in the same pass, None for none
+            denoiser: Temporal denoiser applied in the same pass, None for none
+            keyer: Chroma keyer applied in the same pass, None for none
+
+        Returns:
+            np.ndarray: BGRA frame (the input itself when it already is one and there is nothing to apply)
+        """
+        if frame.shape == (height, width, 4) and lut is None and denoiser is None and keyer is None:
+            return frame
+        self.begin_frame(frame.shape, width, height, deadline, lut, denoiser, keyer)
+        self.rows_ready(frame, frame.shape[0])
+        return self.finish()
+
+    async def convert_async(self, frame: np.ndarray, width: int, height: int,
+                            deadline: Optional[float] = None, lut: Optional[LUT3D] = None,
+                            denoiser: Optional[TemporalDenoiser] = None,
+                            keyer: Optional[ChromaKeyer] = None) -> np.ndarray:
+        """Scale, convert, colour-correct, denoise and key a whole frame without blocking the event loop"""
+        if frame.shape == (height, width, 4) and lut is None and denoiser is None and keyer is None:
+            return frame
+        self.begin_frame(frame.shape, width, height, deadline, lut, denoiser, keyer)
+        self.rows_ready(frame, frame.shape[0])
+        return await self.finish_async()
@@ -0,0 +1,174 @@
+"""
+Frame Rate - Blend-based frame-rate conversion between frame-rate families
+(e.g. 29.97/30 fps phones into a 25/50 fps house clock)
+"""
+
+import asyncio
+import logging
+from collections import deque
+from typing import Deque, Optional, Tuple
+
+import cv2
+import numpy as np
+
+from processing.scheduler import CpuMeter, DeadlineScheduler
+
+logger = logging.getLogger(__name__)
+
+
+class FrameRateConverter:
+    """
+    Converts a stream's frame rate to the output clock by blending.
+
+    Drop/repeat between 30 and 25 fps shows a visible judder every fifth
+    frame. Here every output tick is placed on the source timeline one
+    source frame behind real time, so the two frames around it have
+    normally arrived, and the output is their mix weighted by where the
+    tick falls between them. Weights are quantized to `steps` phases; a
+    phase of 0 or 1 reuses the source frame as is, so a frame costs at
+    most one blend (reading both neighbours, one SIMD addWeighted pass).
+
+    Arrival times are smoothed onto a steady cadence first, so network
+    jitter does not turn into weight flicker. When source and output run
+    at the same rate blending would only soften the picture; then the
+    nearest frame is taken, like plain repeat.
+    """
+
+    def __init__(self, output_fps: float, source_fps: float = 30.0, steps: int = 16, history: int = 4):
+        """
+        Initialize frame-rate converter
+
+        Args:
+            output_fps: Output (house clock) frame rate
+            source_fps: Initial guess of the source rate; refined from arrivals
+            steps: Number of blend phases between two source frames
+            history: Source frames kept for selection
+        """
+        self.output_fps = output_fps
+        self.steps = max(1, steps)
+        self.interval = 1.0 / source_fps
+        self._frames: Deque[Tuple[np.ndarray, float]] = deque(maxlen=max(2, history))
+        self._last_arrival: Optional[float] = None
+        self.stats = {"frames_blended": 0, "frames_copied": 0}
+
+    @property
+    def same_rate(self) -> bool:
+        """Source and output run at the same rate (within 2%)"""
+        return abs(self.interval * self.output_fps - 1.0) < 0.02
+
+    def push(self, frame: np.ndarray, timestamp: float):
+        """
+        Add a processed source frame
+
+        Args:
+            frame: Frame ready for output
+            timestamp: Arrival time (time.time())
+        """
+        last = self._last_arrival
+        self._last_arrival = timestamp
+        if not self._frames or last is None or not 0.0 < timestamp - last < 5.0 * self.interval:
+            # First frame or a gap: restart the timeline at the arrival time
+            self._frames.clear()
+            self._frames.append((frame, timestamp))
+            return
+
+        delta = timestamp - last
+        self.interval += 0.02 * (min(delta, 2.0 * self.interval) - self.interval)
+        pts = self._frames[-1][1] + self.interval
+        # Follow arrivals slowly so the cadence cannot drift away from them
+        pts += 0.1 * (timestamp - pts)
+        self._frames.append((frame, pts))
+
+    def select(self, tick_time: float) -> Optional[Tuple[np.ndarray, np.ndarray, float]]:
+        """
+        Source frames and blend weight for an output tick
+
+        Args:
+            tick_time: Wall-clock time of the output frame
+
+        Returns:
+            tuple: (earlier frame, later frame, weight of the later frame), None without frames
+        """
+        if not self._frames:
+            return None
+        target = tick_time - self.interval
+        frames = self._frames
+        if target <= frames[0][1]:
+            return frames[0][0], frames[0][0], 0.0
+        if target >= frames[-1][1]:
+            return frames[-1][0], frames[-1][0], 0.0
+
+        for (earlier, start), (later, end) in zip(frames, list(frames)[1:]):
+            if start <= target <= end:
+                weight = (target - start) / max(end - start, 1e-6)
+                if self.same_rate:
+                    weight = float(weight >= 0.5)
+                else:
+                    weight = round(weight * self.steps) / self.steps
+                return earlier, later, weight
+        return frames[-1][0], frames[-1][0], 0.0
+
+    @staticmethod
+    def blend(earlier: np.ndarray, later: np.ndarray, weight: float, out: np.ndarray,
+              rows: Optional[Tuple[int, int]] = None) -> np.ndarray:
+        """
+        Blend two frames, or a band of them, into `out`
+
+        Args:
+            earlier: Frame before the output time
+            later: Frame after the output time
+            weight: Weight of the later frame (0..1)
+            out: Destination
+            rows: (first, end) rows to blend, all rows if None
+        """
+        y0, y1 = rows or (0, out.shape[0])
+        cv2.addWeighted(earlier[y0:y1], 1.0 - weight, later[y0:y1], weight, 0.0, dst=out[y0:y1])
+        return out
+
+    async def render(self, tick_time: float, scheduler: Optional[DeadlineScheduler] = None,
+                     bands: int = 4, deadline: Optional[float] = None,
+                     meter: Optional[CpuMeter] = None) -> Optional[np.ndarray]:
+        """
+        Output frame for a tick
+
+        Args:
+            tick_time: Wall-clock time of the output frame
+            scheduler: Frame worker pool for banded blending, None to blend inline
+            bands: Number of row bands
+            deadline: time.monotonic() by which the frame must be ready
+            meter: Charged with the blend's CPU time, None for none
+
+        Returns:
+            np.ndarray: Output frame, None before the first source frame
+
+        Raises:
+            DeadlineMissed: If a band was dropped for the frame deadline
+        """
+        selection = self.select(tick_time)
+        if selection is None:
+            return None
+        earlier, later, weight = selection
+        if weight <= 0.0 or earlier.shape != later.shape:
+            self.stats["frames_copied"] += 1
+            return earlier if weight <= 0.0 else later
+        if weight >= 1.0:
+            self.stats["frames_copied"] += 1
+            return later
+
+        self.stats["frames_blended"] += 1
+        # A fresh buffer: the previous output may still be in flight to NDI
+        out = np.empty_like(earlier)
+        if scheduler is None:
+            if meter is None:
+                return self.blend(earlier, later, weight, out)
+            with meter.measure():
+                return self.blend(earlier, later, weight, out)
+        height = out.shape[0]
+        rows_per_band = -(-height // max(1, bands))
+        futures = [
+            scheduler.submit(self.blend, earlier, later, weight, out, (y0, min(height, y0 + rows_per_band)),
+                             deadline=deadline, kind="blend", meter=meter)
+            for y0 in range(0, height, rows_per_band)
+        ]
+        await asyncio.gather(*(asyncio.wrap_future(future) for future in futures))
+        return out
@@ -0,0 +1,143 @@
+"""
+House Clock - One frame clock for every NDI sender of the bridge
+
+Ticks sit on a grid anchored to the Unix epoch (CLOCK_REALTIME) plus a
+configurable phase, so every worker process, and every host synced by
+NTP/PTP, ticks at the same instants without talking to each other.
+"""
+
+import asyncio
+import itertools
+import logging
+import math
+import time
+from typing import Awaitable, Callable, Dict, Optional, Tuple
+
+from utils.metrics import record_house_clock_skew
+
+logger = logging.getLogger(__name__)
+
+TickCallback = Callable[[int, float], Awaitable[None]]
+
+
+class HouseClock:
+    """
+    Shared frame clock that drives all senders of a process.
+
+    Subscribers are called together on every tick with the tick index and
+    its wall-clock time; they submit their latest frame instead of pacing
+    themselves, so frame boundaries of all sources line up and frame-syncing
+    switchers buffer less.
+    """
+
+    def __init__(self, fps: float = 30.0, phase_ms: float = 0.0):
+        """
+        Initialize house clock
+
+        Args:
+            fps: Tick rate (e.g. 30, 29.97, 59.94)
+            phase_ms: Offset of the tick grid from the epoch second, in milliseconds
+        """
+        self.fps = fps
+        self.interval = 1.0 / fps
+        self.phase = (phase_ms / 1000.0) % self.interval
+
+        self.subscribers: Dict[int, TickCallback] = {}
+        self._ids = itertools.count()
+        self.task: Optional[asyncio.Task] = None
+
+        self.stats = {
+            "ticks": 0,
+            "missed_ticks": 0,
+            "last_wake_delay_ms": 0.0,
+            "last_spread_ms": 0.0
+        }
+
+    def tick_time(self, index: int) -> float:
+        """Wall-clock time of a tick"""
+        return self.phase + index * self.interval
+
+    def next_tick(self, now: Optional[float] = None) -> Tuple[int, float]:
+        """
+        First tick after a point in time
+
+        Args:
+            now: Wall-clock time (defaults to time.time())
+
+        Returns:
+            tuple: (tick index, tick time)
+        """
+        now = time.time() if now is None else now
+        index = math.floor((now - self.phase) / self.interval) + 1
+        return index, self.tick_time(index)
+
+    def subscribe(self, callback: TickCallback) -> int:
+        """
+        Call a coroutine function on every tick; starts the clock if needed
+
+        Args:
+            callback: async callback(tick_index, tick_time)
+
+        Returns:
+            int: Subscription id for unsubscribe()
+        """
+        subscription = next(self._ids)
+        self.subscribers[subscription] = callback
+        if self.task is None or self.task.done():
+            self.task = asyncio.create_task(self._run())
+            logger.info(f"🕐 House clock running at {self.fps:g} fps, phase {self.phase * 1000:.2f} ms")
+        return subscription
+
+    def unsubscribe(self, subscription: int):
+        """Stop calling a subscriber; the clock stops with the last one"""
+        self.subscribers.pop(subscription, None)
+        if not self.subscribers and self.task:
+            self.task.cancel()
+            self.task = None
+
+    async def _run(self):
+        index, tick = self.next_tick()
+        try:
+            while self.subscribers:
+                await asyncio.sleep(max(0.0, tick - time.time()))
+                woke = time.time()
+                self.stats["ticks"] += 1
+                self.stats["last_wake_delay_ms"] = (woke - tick) * 1000.0
+
+                await asyncio.gather(
+                    *(self._deliver(callback, index, tick) for callback in list(self.subscribers.values())),
+                    return_exceptions=True
+                )
+                self.stats["last_spread_ms"] = (time.time() - woke) * 1000.0
+
+                # Skip ticks we overslept instead of bursting to catch up
+                next_index, next_time = self.next_tick()
+                if next_index > index + 1:
+                    self.stats["missed_ticks"] += next_index - index - 1
+                index, tick = next_index, next_time
+
+        except asyncio.CancelledError:
+            pass
+
+    async def _deliver(self, callback: TickCallback, index: int, tick: float):
+        record_house_clock_skew(time.time() - tick)
+        try:
+            await callback(index, tick)
+        except Exception as e:
+            logger.error(f"House clock subscriber failed on tick {index}: {e}")
+
+    def get_stats(self) -> dict:
+        """Get clock statistics"""
+        return {
+            **self.stats,
+            "fps": self.fps,
+            "phase_ms": self.phase * 1000.0,
+            "subscribers": len(self.subscribers)
+        }
+
+    def stop(self):
+        """Stop ticking"""
+        self.subscribers.clear()
+        if self.task:
+            self.task.cancel()
+            self.task = None
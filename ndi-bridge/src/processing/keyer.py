@@ -0,0 +1,159 @@
+"""
+Keyer - Chroma keying of green/blue-screen phone shots into BGRA with a
+real alpha channel
+"""
+
+import logging
+import math
+from typing import Optional, Tuple
+
+import cv2
+import numpy as np
+
+logger = logging.getLogger(__name__)
+
+# BT.709 luma weights; chroma is keyed in Y'CbCr as the receiving NDI codec sees it
+KR, KB = 0.2126, 0.0722
+KG = 1.0 - KR - KB
+# Rows are Y', Cb, Cr (Cb/Cr centred on 0) from normalised B, G, R columns
+BGR_TO_YCBCR = np.array([
+    [KB, KG, KR],
+    [0.5, -0.5 * KG / (1 - KB), -0.5 * KR / (1 - KB)],
+    [-0.5 * KB / (1 - KR), -0.5 * KG / (1 - KR), 0.5]
+], dtype=np.float32)
+YCBCR_TO_BGR = np.linalg.inv(BGR_TO_YCBCR).astype(np.float32)
+
+
+def parse_key_color(color: str) -> Tuple[int, int, int]:
+    """
+    Parse a key colour
+
+    Args:
+        color: "#RRGGBB", "green" or "blue"
+
+    Returns:
+        tuple: (R, G, B)
+    """
+    presets = {"green": "#00b140", "blue": "#0047bb"}
+    value = presets.get(color.strip().lower(), color).lstrip("#")
+    if len(value) != 6:
+        raise ValueError(f"Invalid key colour: {color}")
+    return tuple(int(value[i:i + 2], 16) for i in (0, 2, 4))
+
+
+class ChromaKeyer:
+    """
+    Chroma keyer working in Y'CbCr.
+
+    Alpha comes from each pixel's distance to the key colour in the CbCr
+    plane, so shadows and highlights on the screen key out as cleanly as
+    its well-lit parts. Spill is suppressed by removing the chroma that
+    points toward the key colour, and the matte edge is softened with a
+    small Gaussian.
+
+    Both the matte and the spill only depend on (Cb, Cr), so they are
+    precomputed for all 256x256 8-bit chroma pairs: per pixel the keyer
+    runs one SIMD colour transform to CbCr, two table lookups, the blur
+    and one SIMD transform that adds the spill correction -- pixels
+    without spill come out bit-exact. A band of rows can be keyed on its
+    own, read with enough margin that the stitched result equals keying
+    the whole frame (BandConverter keys each band as it converts).
+    """
+
+    def __init__(self, key_color: str = "green", tolerance: float = 0.12, softness: float = 0.10,
+                 spill: float = 1.0, edge: float = 1.0):
+        """
+        Initialize chroma keyer
+
+        Args:
+            key_color: "#RRGGBB", "green" or "blue"
+            tolerance: Chroma distance up to which a pixel is fully transparent (0..0.7)
+            softness: Chroma distance over which alpha ramps up to opaque
+            spill: Strength of spill suppression (0 = off, 1 = full)
+            edge: Sigma in pixels of the matte softening blur (0 = off)
+        """
+        red, green, blue = parse_key_color(key_color)
+        _, key_cb, key_cr = BGR_TO_YCBCR @ (np.array([blue, green, red], dtype=np.float32) / 255.0)
+        magnitude = math.hypot(key_cb, key_cr)
+        if magnitude < 0.05:
+            raise ValueError(f"Key colour {key_color} has too little chroma to key on")
+        dx, dy = key_cb / magnitude, key_cr / magnitude
+
+        self.key_color = key_color
+        self.tolerance = tolerance
+        self.softness = max(softness, 1e-3)
+        self.spill = spill
+        self.edge = edge
+        self.blur_size = 2 * math.ceil(3 * edge) + 1 if edge > 0 else 0
+
+        # 8-bit BGR -> (Cb, Cr) + 128
+        self._to_chroma = np.hstack((BGR_TO_YCBCR[1:], np.full((2, 1), 128.0, dtype=np.float32)))
+
+        chroma = (np.arange(256, dtype=np.float32) - 128.0) / 255.0
+        cb, cr = np.meshgrid(chroma, chroma, indexing="ij")
+        alpha = (np.hypot(cb - key_cb, cr - key_cr) - tolerance) / self.softness
+        self._alpha = np.round(np.clip(alpha, 0.0, 1.0) * 255.0).astype(np.uint8).ravel()
+
+        # Spill: chroma toward the key, removed along the key direction with
+        # luma held; in BGR that is a fixed vector scaled per pixel
+        toward_key = np.maximum(cb * dx + cr * dy, 0.0) * spill
+        self._spill = np.round(np.clip(toward_key * 255.0, 0, 255)).astype(np.uint8).ravel()
+        direction = -(YCBCR_TO_BGR[:, 1] * dx + YCBCR_TO_BGR[:, 2] * dy)
+        self._despill = np.hstack((np.eye(3), direction[:, None])).astype(np.float32)
+
+    @property
+    def margin(self) -> int:
+        """Rows of context a band needs on each side for an exact blur"""
+        return self.blur_size // 2
+
+    def apply(self, frame: np.ndarray, out: Optional[np.ndarray] = None,
+              rows: Optional[Tuple[int, int]] = None) -> np.ndarray:
+        """
+        Key a frame, or a band of it
+
+        Args:
+            frame: uint8 BGR or BGRA frame
+            out: BGRA destination (a new array if None; must not be `frame`)
+            rows: (first, end) output rows to produce, all rows if None
+
+        Returns:
+            np.ndarray: BGRA frame with the key as alpha
+        """
+        height = frame.shape[0]
+        if out is None:
+            out = np.empty(frame.shape[:2] + (4,), dtype=np.uint8)
+        y0, y1 = rows or (0, height)
+        # Read the band with blur context, clipped at the real frame edges
+        src_y0, src_y1 = max(0, y0 - self.margin), min(height, y1 + self.margin)
+        bgr = frame[src_y0:src_y1, :, :3]
+
+        chroma = cv2.transform(bgr, self._to_chroma)
+        key = (chroma[..., 0].astype(np.uint16) << 8) | chroma[..., 1]
+
+        alpha = np.take(self._alpha, key)
+        if self.blur_size:
+            alpha = cv2.GaussianBlur(alpha, (self.blur_size, self.blur_size), self.edge,
+                                     borderType=cv2.BORDER_REPLICATE)
+
+        crop = slice(y0 - src_y0, y0 - src_y0 + (y1 - y0))
+        band = out[y0:y1]
+        if self.spill > 0:
+            # BGR plus spill amount in the alpha slot, then one transform adds it
+            band[..., :3] = bgr[crop]
+            band[..., 3] = np.take(self._spill, key[crop])
+            band[..., :3] = cv2.transform(band, self._despill)
+        else:
+            band[..., :3] = bgr[crop]
+        band[..., 3] = alpha[crop]
+        return out
+
+
+def create_chroma_keyer(settings) -> ChromaKeyer:
+    """Build the keyer configured by CHROMA_KEY_* settings"""
+    return ChromaKeyer(
+        key_color=settings.chroma_key_color,
+        tolerance=settings.chroma_key_tolerance,
+        softness=settings.chroma_key_softness,
+        spill=settings.chroma_key_spill,
+        edge=settings.chroma_key_edge
+    )
@@ -0,0 +1,442 @@
+"""
+3D LUT - Per-stream colour matching with .cube LUTs and tetrahedral
+interpolation, plus LUTs derived from colour statistics
+"""
+
+import logging
+import os
+import threading
+import time
+from concurrent.futures import ThreadPoolExecutor
+from typing import Dict, Optional, Set, Tuple
+
+import cv2
+import numpy as np
+
+logger = logging.getLogger(__name__)
+
+
+class LUT3D:
+    """
+    3D colour lookup table applied to 8-bit BGR(A) frames.
+
+    Interpolation is tetrahedral: the lattice cell around a colour is split
+    into six tetrahedra along its grey diagonal and the colour is weighted
+    between the four corners of its tetrahedron, which keeps neutrals neutral
+    and needs four table reads instead of trilinear's eight.
+
+    Frames never run the interpolation: it is evaluated once for all 2^24
+    8-bit colours into a dense table (64 MB, about a second of CPU), and a
+    BGRA pixel, read as one little-endian uint32, is mapped with a single
+    gather on its low 24 bits. Call prepare() off the frame path; the first
+    apply() builds the table otherwise.
+    """
+
+    CHUNK_PIXELS = 16384
+    ALPHA_MASK = np.uint32(0xFF000000)
+    COLOR_MASK = np.uint32(0x00FFFFFF)
+
+    def __init__(self, table: np.ndarray, title: str = ""):
+        """
+        Initialize LUT
+
+        Args:
+            table: float RGB output, shape (size, size, size, 3), indexed [b, g, r]
+                as in a .cube file (red varies fastest), values 0..1
+            title: Name for logs
+        """
+        self.size = table.shape[0]
+        self.title = title
+        self.table = np.ascontiguousarray(table, dtype=np.float32)
+
+        size = self.size
+        # Lattice packed B | G << 16 | R << 32: the three channels are weighted
+        # by one 64-bit multiply-add (SIMD within a register); 8-bit values
+        # times weights summing to 256 never carry into the next lane
+        corners = np.round(self.table.reshape(-1, 3) * 255.0).astype(np.uint64)
+        self._packed = corners[:, 2] | (corners[:, 1] << 16) | (corners[:, 0] << 32)
+
+        levels = np.arange(256, dtype=np.float64) * (size - 1) / 255.0
+        cell = np.minimum(levels.astype(np.int64), size - 2)
+        self._fraction = np.round((levels - cell) * 256).astype(np.uint16)  # 1/256 steps
+        strides = np.array([1, size, size * size], dtype=np.int64)  # r, g, b
+        self._index = [(cell * stride).astype(np.int32) for stride in strides]
+
+        # Tetrahedron of each fraction ordering, keyed by
+        # (r >= g) | (g >= b) << 1 | (r >= b) << 2: offsets of its second
+        # corner (+largest axis) and third corner (+all but the smallest);
+        # codes 3 and 4 cannot occur
+        high = np.zeros(8, dtype=np.int32)
+        middle = np.zeros(8, dtype=np.int32)
+        r, g, b = strides
+        for code, order in {
+            0b111: (r, g, b), 0b101: (r, b, g), 0b001: (b, r, g),
+            0b000: (b, g, r), 0b010: (g, b, r), 0b110: (g, r, b)
+        }.items():
+            high[code] = order[0]
+            middle[code] = order[0] + order[1]
+        self._second, self._third = high, middle
+        self._far = np.int32(r + g + b)
+
+        self._dense: Optional[np.ndarray] = None
+        self._dense_lock = threading.Lock()
+
+    @classmethod
+    def identity(cls, size: int = 17) -> "LUT3D":
+        """LUT that leaves colours unchanged"""
+        axis = np.linspace(0.0, 1.0, size, dtype=np.float32)
+        b, g, r = np.meshgrid(axis, axis, axis, indexing="ij")
+        return cls(np.stack((r, g, b), axis=-1), "identity")
+
+    @classmethod
+    def load_cube(cls, path: str) -> "LUT3D":
+        """
+        Load an Adobe/Resolve .cube file
+
+        Args:
+            path: File path
+
+        Returns:
+            LUT3D: Loaded LUT
+
+        Raises:
+            ValueError: If the file is not a valid 3D .cube LUT
+        """
+        size = None
+        title = os.path.splitext(os.path.basename(path))[0]
+        domain_min = np.zeros(3, dtype=np.float32)
+        domain_max = np.ones(3, dtype=np.float32)
+        values = []
+
+        with open(path, "r", encoding="utf-8") as cube:
+            for line in cube:
+                line = line.strip()
+                if not line or line.startswith("#"):
+                    continue
+                keyword = line.split()[0].upper()
+                if keyword == "TITLE":
+                    title = line[5:].strip().strip('"') or title
+                elif keyword == "LUT_3D_SIZE":
+                    size = int(line.split()[1])
+                elif keyword == "LUT_1D_SIZE":
+                    raise ValueError(f"{path}: 1D LUTs are not supported")
+                elif keyword == "DOMAIN_MIN":
+                    domain_min = np.array(line.split()[1:4], dtype=np.float32)
+                elif keyword == "DOMAIN_MAX":
+                    domain_max = np.array(line.split()[1:4], dtype=np.float32)
+                elif keyword[0].isdigit() or keyword[0] in "-.":
+                    values.append(line.split()[:3])
+
+        if not size or size < 2:
+            raise ValueError(f"{path}: missing LUT_3D_SIZE")
+        if len(values) != size ** 3:
+            raise ValueError(f"{path}: expected {size ** 3} entries, found {len(values)}")
+
+        table = np.array(values, dtype=np.float32).reshape(size, size, size, 3)
+        if not (np.all(domain_min == 0) and np.all(domain_max == 1)):
+            table = (table - domain_min) / (domain_max - domain_min)
+        return cls(np.clip(table, 0.0, 1.0), title)
+
+    @classmethod
+    def from_statistics(cls, source_mean: np.ndarray, source_std: np.ndarray,
+                        reference_mean: np.ndarray, reference_std: np.ndarray,
+                        size: int = 17, strength: float = 1.0) -> "LUT3D":
+        """
+        LUT moving one camera's colour statistics onto a reference camera's
+
+        Means and standard deviations are matched per channel in CIELAB,
+        where the channels are close to decorrelated, so a colour cast and
+        a contrast difference are corrected without skewing hues.
+
+        Args:
+            source_mean: Lab mean of the camera to correct
+            source_std: Lab standard deviation of the camera to correct
+            reference_mean: Lab mean of the reference camera
+            reference_std: Lab standard deviation of the reference camera
+            size: Lattice points per axis; the match is smooth, so a small
+                lattice suffices and rebuilds in about a millisecond
+            strength: 0..1 blend from identity to the full match
+
+        Returns:
+            LUT3D: Matching LUT
+        """
+        identity = cls.identity(size).table
+        lattice = identity.reshape(1, -1, 3)  # float RGB "image" for cvtColor
+        lab = cv2.cvtColor(lattice, cv2.COLOR_RGB2Lab)
+
+        scale = np.clip(np.asarray(reference_std) / np.maximum(np.asarray(source_std), 1e-3), 0.5, 2.0)
+        matched = (lab - source_mean) * scale + reference_mean
+        matched = lab + (matched - lab) * strength
+        rgb = cv2.cvtColor(matched.astype(np.float32), cv2.COLOR_Lab2RGB)
+        return cls(np.clip(rgb.reshape(identity.shape), 0.0, 1.0), "auto-match")
+
+    def prepare(self) -> "LUT3D":
+        """Build the dense 8-bit table now (idempotent, thread safe)"""
+        if self._dense is None:
+            with self._dense_lock:
+                if self._dense is None:
+                    started = time.perf_counter()
+                    # Every BGRX colour once, in uint32 index order
+                    colors = np.arange(1 << 24, dtype=np.uint32).view(np.uint8).reshape(-1, 4)
+                    table = np.empty_like(colors)
+                    # Chunks small enough that the temporaries stay in cache
+                    for start in range(0, len(colors), self.CHUNK_PIXELS):
+                        chunk = slice(start, start + self.CHUNK_PIXELS)
+                        self._interpolate(colors[chunk], table[chunk])
+                    table[:, 3] = 0
+                    self._dense = table.view(np.uint32).ravel()
+                    logger.debug(
+                        f"Built dense table of LUT '{self.title}' in "
+                        f"{(time.perf_counter() - started) * 1000:.0f} ms"
+                    )
+        return self
+
+    def apply(self, frame: np.ndarray, out: Optional[np.ndarray] = None) -> np.ndarray:
+        """
+        Apply the LUT to a BGR or BGRA frame
+
+        Args:
+            frame: uint8 BGR(A) frame or band; alpha is left untouched
+            out: Destination (may be `frame` itself for in-place), new array if None
+
+        Returns:
+            np.ndarray: Colour-corrected frame
+        """
+        dense = self.prepare()._dense
+        if out is None:
+            out = np.empty_like(frame)
+
+        if frame.shape[-1] == 4 and frame.flags.c_contiguous and out.flags.c_contiguous:
+            pixels = frame.view(np.uint32)
+            # Gathers take intp indices; producing them directly saves a cast pass
+            index = np.empty(pixels.shape, dtype=np.intp)
+            np.bitwise_and(pixels, self.COLOR_MASK, out=index, casting="unsafe")
+            alpha = pixels & self.ALPHA_MASK
+            target = out.view(np.uint32)
+            np.take(dense, index, out=target, mode="clip")  # in range; "clip" skips the bounds check
+            target |= alpha
+            return out
+
+        # BGR or strided: assemble the index from the channels
+        index = frame[..., 0].astype(np.intp)
+        index |= frame[..., 1].astype(np.intp) << 8
+        index |= frame[..., 2].astype(np.intp) << 16
+        mapped = np.take(dense, index, mode="clip").view(np.uint8).reshape(*index.shape, 4)
+        out[..., :3] = mapped[..., :3]
+        if frame.shape[-1] == 4 and out is not frame:
+            out[..., 3] = frame[..., 3]
+        return out
+
+    def _interpolate(self, pixels: np.ndarray, target: np.ndarray):
+        b, g, r = pixels[:, 0], pixels[:, 1], pixels[:, 2]
+        fr = np.take(self._fraction, r)
+        fg = np.take(self._fraction, g)
+        fb = np.take(self._fraction, b)
+        base = np.take(self._index[0], r) + np.take(self._index[1], g) + np.take(self._index[2], b)
+
+        high = np.maximum(np.maximum(fr, fg), fb)
+        low = np.minimum(np.minimum(fr, fg), fb)
+        middle = fr + fg + fb - high - low
+
+        code = (fr >= fg).view(np.uint8) | ((fg >= fb).view(np.uint8) << 1) | ((fr >= fb).view(np.uint8) << 2)
+        packed = self._packed
+        result = np.take(packed, base) * (256 - high).astype(np.uint64)
+        result += np.take(packed, base + np.take(self._second, code)) * (high - middle).astype(np.uint64)
+        result += np.take(packed, base + np.take(self._third, code)) * (middle - low).astype(np.uint64)
+        result += np.take(packed, base + self._far) * low.astype(np.uint64)
+        result += np.uint64(0x0080_0080_0080)  # round each lane
+
+        target[:, 0] = result >> np.uint64(8)
+        target[:, 1] = result >> np.uint64(24)
+        target[:, 2] = result >> np.uint64(40)
+
+
+class ColorStatistics:
+    """Running CIELAB mean and spread of a camera, from sparse thumbnails"""
+
+    def __init__(self, smoothing: float = 0.1, sample_interval: float = 1.0):
+        """
+        Initialize colour statistics
+
+        Args:
+            smoothing: Weight of each new sample in the running average
+            sample_interval: Seconds between sampled frames
+        """
+        self.smoothing = smoothing
+        self.sample_interval = sample_interval
+        self.mean: Optional[np.ndarray] = None
+        self.std: Optional[np.ndarray] = None
+        self.samples = 0
+        self._last_sample = 0.0
+
+    def update(self, frame: np.ndarray, now: Optional[float] = None) -> bool:
+        """
+        Sample a frame if the interval has passed
+
+        Args:
+            frame: uint8 BGR(A) frame
+            now: time.monotonic() (defaults to now)
+
+        Returns:
+            bool: True if the frame was sampled
+        """
+        now = time.monotonic() if now is None else now
+        if now - self._last_sample < self.sample_interval:
+            return False
+        self._last_sample = now
+
+        thumbnail = cv2.resize(frame[..., :3], (64, 36), interpolation=cv2.INTER_AREA)
+        lab = cv2.cvtColor(thumbnail.astype(np.float32) / 255.0, cv2.COLOR_BGR2Lab).reshape(-1, 3)
+        mean, std = lab.mean(axis=0), lab.std(axis=0)
+        if self.mean is None:
+            self.mean, self.std = mean, std
+        else:
+            self.mean += (mean - self.mean) * self.smoothing
+            self.std += (std - self.std) * self.smoothing
+        self.samples += 1
+        return True
+
+    @property
+    def ready(self) -> bool:
+        return self.samples >= 5
+
+
+class ColorMatcher:
+    """
+    Auto-matching of every stream to a reference camera.
+
+    Streams report sampled statistics; each non-reference stream gets a LUT
+    derived from its statistics and the reference's, rebuilt every
+    `rebuild_interval` seconds so it follows slow changes (white balance,
+    lighting) without visible stepping.
+    """
+
+    # Lab change of either side's mean or spread that is worth a rebuild
+    REBUILD_DELTA = 1.0
+
+    def __init__(self, reference: str, rebuild_interval: float = 5.0, strength: float = 1.0,
+                 size: int = 17):
+        """
+        Initialize colour matcher
+
+        Args:
+            reference: Device name of the reference camera
+            rebuild_interval: Seconds between LUT rebuild checks per stream
+            strength: 0..1 blend from identity to the full match
+            size: Lattice points per axis of derived LUTs
+        """
+        self.reference = reference
+        self.rebuild_interval = rebuild_interval
+        self.strength = strength
+        self.size = size
+        self.statistics: Dict[str, ColorStatistics] = {}
+        self.luts: Dict[str, LUT3D] = {}
+        self._built_at: Dict[str, float] = {}
+        self._built_from: Dict[str, np.ndarray] = {}
+        self._building: Set[str] = set()
+        self._lock = threading.Lock()
+        # Dense tables take about a second; build them off the frame path, one at a time
+        self._builder = ThreadPoolExecutor(max_workers=1, thread_name_prefix="lut-build")
+
+    def observe(self, device_name: str, frame: np.ndarray):
+        """Sample a stream's frame into its statistics (rate limited)"""
+        with self._lock:
+            statistics = self.statistics.setdefault(device_name, ColorStatistics())
+        statistics.update(frame)
+
+    def lut_for(self, device_name: str) -> Optional[LUT3D]:
+        """
+        Current matching LUT of a stream
+
+        The LUT is rebuilt in the background when either side's statistics
+        have moved, and the previous one is returned until it is ready.
+
+        Returns:
+            LUT3D: LUT, None for the reference or before the first one is built
+        """
+        if device_name == self.reference:
+            return None
+
+        now = time.monotonic()
+        if now - self._built_at.get(device_name, 0.0) >= self.rebuild_interval:
+            self._built_at[device_name] = now
+            source = self.statistics.get(device_name)
+            reference = self.statistics.get(self.reference)
+            if source and reference and source.ready and reference.ready:
+                inputs = np.concatenate((source.mean, source.std, reference.mean, reference.std))
+                previous = self._built_from.get(device_name)
+                with self._lock:
+                    due = device_name not in self._building and (
+                        previous is None or np.abs(inputs - previous).max() >= self.REBUILD_DELTA
+                    )
+                    if due:
+                        self._building.add(device_name)
+                if due:
+                    self._built_from[device_name] = inputs
+                    self._builder.submit(self._build, device_name, inputs)
+        return self.luts.get(device_name)
+
+    def _build(self, device_name: str, inputs: np.ndarray):
+        try:
+            source_mean, source_std, reference_mean, reference_std = np.split(inputs, 4)
+            lut = LUT3D.from_statistics(
+                source_mean, source_std, reference_mean, reference_std,
+                size=self.size, strength=self.strength
+            ).prepare()
+            with self._lock:
+                if device_name in self._building:
+                    self.luts[device_name] = lut
+        except Exception as e:
+            logger.error(f"Failed to build colour match LUT for {device_name}: {e}")
+        finally:
+            with self._lock:
+                self._building.discard(device_name)
+
+    def forget(self, device_name: str):
+        """Drop a stopped stream"""
+        with self._lock:
+            self.statistics.pop(device_name, None)
+            self._building.discard(device_name)
+            self.luts.pop(device_name, None)
+        self._built_at.pop(device_name, None)
+        self._built_from.pop(device_name, None)
+
+
+# (path, mtime) -> prepared LUT, so streams sharing a file share its dense table
+_lut_cache: Dict[Tuple[str, float], LUT3D] = {}
+_lut_cache_lock = threading.Lock()
+
+
+def load_stream_lut(lut_dir: str, device_name: str) -> Optional[LUT3D]:
+    """
+    Find the .cube LUT of a device: <device_name>.cube, else default.cube
+
+    The LUT is returned prepared; a file is only built once while unchanged.
+
+    Args:
+        lut_dir: Directory of .cube files ("" disables file LUTs)
+        device_name: Device name of the stream
+
+    Returns:
+        LUT3D: Loaded LUT or None
+    """
+    if not lut_dir:
+        return None
+    for name in (device_name, "default"):
+        path = os.path.join(lut_dir, f"{name}.cube")
+        if os.path.isfile(path):
+            try:
+                key = (path, os.path.getmtime(path))
+                with _lut_cache_lock:
+                    lut = _lut_cache.get(key)
+                    if lut is None:
+                        lut = LUT3D.load_cube(path).prepare()
+                        for stale in [cached for cached in _lut_cache if cached[0] == path]:
+                            del _lut_cache[stale]  # edited file, the old table is large
+                        _lut_cache[key] = lut
+                logger.info(f"🎨 Loaded {lut.size}³ LUT '{lut.title}' for {device_name}")
+                return lut
+            except Exception as e:
+                logger.error(f"Failed to load LUT {path}: {e}")
+                return None
+    return None
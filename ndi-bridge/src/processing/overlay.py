@@ -0,0 +1,221 @@
+"""
+Overlay - Logo bugs and name straps composited onto stream frames
+"""
+
+import logging
+import os
+from typing import Dict, List, Optional, Tuple
+
+import cv2
+import numpy as np
+
+logger = logging.getLogger(__name__)
+
+ANCHORS = ("top-left", "top-right", "bottom-left", "bottom-right")
+
+# (x, y, premultiplied BGRA, 255 - alpha in every channel)
+RenderedLayer = Tuple[int, int, np.ndarray, np.ndarray]
+
+# Logo layers by (path, anchor, scale), shared by every stream showing them
+_logo_cache: Dict[Tuple[str, str, float], "OverlayLayer"] = {}
+
+
+class OverlayLayer:
+    """
+    One overlay graphic placed relative to the frame.
+
+    The graphic is rendered for an output size once -- scaled, cropped to
+    its visible pixels and premultiplied -- and cached, so a frame only
+    pays for blending the layer's bounding rectangle.
+    """
+
+    def __init__(self, image: np.ndarray, anchor: str = "top-right", scale: float = 0.12,
+                 margin: float = 0.03):
+        """
+        Initialize overlay layer
+
+        Args:
+            image: Straight-alpha BGRA graphic
+            anchor: Frame corner the layer sits in (top-left, top-right, bottom-left, bottom-right)
+            scale: Layer width as a fraction of the frame width
+            margin: Distance from the frame edges as a fraction of the frame height
+        """
+        if anchor not in ANCHORS:
+            raise ValueError(f"Unknown overlay anchor: {anchor}")
+        self.image = image
+        self.anchor = anchor
+        self.scale = scale
+        self.margin = margin
+        self._cache: Dict[Tuple[int, int], Optional[RenderedLayer]] = {}
+
+    @classmethod
+    def from_file(cls, path: str, **kwargs) -> "OverlayLayer":
+        """
+        Load a graphic (PNG with alpha recommended)
+
+        Raises:
+            ValueError: If the file cannot be read
+        """
+        image = cv2.imread(path, cv2.IMREAD_UNCHANGED)
+        if image is None:
+            raise ValueError(f"Cannot read overlay image {path}")
+        if image.ndim == 2:
+            image = cv2.cvtColor(image, cv2.COLOR_GRAY2BGRA)
+        elif image.shape[2] == 3:
+            image = cv2.cvtColor(image, cv2.COLOR_BGR2BGRA)
+        return cls(image, **kwargs)
+
+    def graphic(self, width: int, height: int) -> np.ndarray:
+        """Straight-alpha BGRA graphic at its size for a frame"""
+        target_width = max(1, int(round(width * self.scale)))
+        target_height = max(1, int(round(self.image.shape[0] * target_width / self.image.shape[1])))
+        return cv2.resize(self.image, (target_width, target_height), interpolation=cv2.INTER_AREA)
+
+    def render(self, width: int, height: int) -> Optional[RenderedLayer]:
+        """
+        Layer prepared for a frame size (cached)
+
+        Returns:
+            tuple: (x, y, premultiplied BGRA, inverse alpha), None if nothing is visible
+        """
+        key = (width, height)
+        if key not in self._cache:
+            self._cache[key] = self._render(width, height)
+        return self._cache[key]
+
+    def _render(self, width: int, height: int) -> Optional[RenderedLayer]:
+        graphic = self.graphic(width, height)
+        margin = int(round(height * self.margin))
+        x = margin if self.anchor.endswith("left") else width - margin - graphic.shape[1]
+        y = margin if self.anchor.startswith("top") else height - margin - graphic.shape[0]
+
+        # Crop to the visible pixels inside the frame: the dirty rectangle
+        visible = cv2.boundingRect(graphic[..., 3])
+        left, top = max(visible[0], -x), max(visible[1], -y)
+        right = min(visible[0] + visible[2], width - x)
+        bottom = min(visible[1] + visible[3], height - y)
+        if right <= left or bottom <= top:
+            return None
+        graphic = graphic[top:bottom, left:right]
+
+        alpha = graphic[..., 3:4]
+        premultiplied = np.empty_like(graphic)
+        premultiplied[..., :3] = (graphic[..., :3].astype(np.uint16) * alpha + 127) // 255
+        premultiplied[..., 3:] = alpha
+        inverse = np.repeat(255 - alpha, 4, axis=2)
+        return x + left, y + top, premultiplied, inverse
+
+
+class NameStrap(OverlayLayer):
+    """Lower-third strap with a name on a translucent bar"""
+
+    def __init__(self, text: str, anchor: str = "bottom-left", margin: float = 0.06,
+                 bar_opacity: int = 170):
+        """
+        Initialize name strap
+
+        Args:
+            text: Name shown on the strap
+            anchor: Frame corner the strap sits in
+            margin: Distance from the frame edges as a fraction of the frame height
+            bar_opacity: Alpha of the bar behind the text (0-255)
+        """
+        super().__init__(np.zeros((1, 1, 4), dtype=np.uint8), anchor=anchor, margin=margin)
+        self.text = text
+        self.bar_opacity = bar_opacity
+
+    def graphic(self, width: int, height: int) -> np.ndarray:
+        bar_height = max(12, int(round(height * 0.08)))
+        font = cv2.FONT_HERSHEY_DUPLEX
+        font_scale = cv2.getFontScaleFromHeight(font, int(bar_height * 0.5))
+        thickness = max(1, bar_height // 24)
+        (text_width, text_height), _ = cv2.getTextSize(self.text, font, font_scale, thickness)
+        padding = bar_height // 2
+
+        strap = np.zeros((bar_height, min(width, text_width + 2 * padding), 4), dtype=np.uint8)
+        strap[..., 3] = self.bar_opacity
+        baseline = (bar_height + text_height) // 2
+        cv2.putText(strap, self.text, (padding, baseline), font, font_scale,
+                    (255, 255, 255, 255), thickness, cv2.LINE_AA)
+        return strap
+
+
+class Overlay:
+    """
+    Per-stream stack of overlay layers.
+
+    Compositing is premultiplied "over", done in place with two OpenCV
+    SIMD passes per layer -- destination times inverse alpha, plus the
+    premultiplied layer -- and only inside each layer's bounding
+    rectangle; the rest of the frame is never touched.
+    """
+
+    def __init__(self, layers: Optional[List[OverlayLayer]] = None):
+        """
+        Initialize overlay
+
+        Args:
+            layers: Layers, bottom first
+        """
+        self.layers: List[OverlayLayer] = list(layers or [])
+
+    def composite(self, frame: np.ndarray) -> np.ndarray:
+        """
+        Composite all layers onto a frame in place
+
+        Args:
+            frame: uint8 BGRA (or BGR) frame
+
+        Returns:
+            np.ndarray: The same frame
+        """
+        height, width = frame.shape[:2]
+        channels = frame.shape[2]
+        for layer in self.layers:
+            rendered = layer.render(width, height)
+            if rendered is None:
+                continue
+            x, y, premultiplied, inverse = rendered
+            rows, cols = premultiplied.shape[:2]
+            region = frame[y:y + rows, x:x + cols]
+            cv2.multiply(region, inverse[..., :channels], dst=region, scale=1.0 / 255.0)
+            cv2.add(region, premultiplied[..., :channels], dst=region)
+        return frame
+
+
+def load_stream_overlay(overlay_dir: str, device_name: str, name_strap: bool = False,
+                        anchor: str = "top-right", scale: float = 0.12) -> Optional[Overlay]:
+    """
+    Build the overlay of a device: its logo bug (<device_name>.png, else
+    default.png) and optionally a strap with the device name
+
+    Logos are shared between streams using the same file, so each output
+    size is rendered once for all of them.
+
+    Args:
+        overlay_dir: Directory of logo images ("" disables logos)
+        device_name: Device name of the stream
+        name_strap: Show the device name as a lower third
+        anchor: Frame corner of the logo
+        scale: Logo width as a fraction of the frame width
+
+    Returns:
+        Overlay: Stream overlay, None when there is nothing to draw
+    """
+    layers: List[OverlayLayer] = []
+    if name_strap:
+        layers.append(NameStrap(device_name))
+    if overlay_dir:
+        for name in (device_name, "default"):
+            path = os.path.join(overlay_dir, f"{name}.png")
+            if os.path.isfile(path):
+                key = (path, anchor, scale)
+                try:
+                    if key not in _logo_cache:
+                        _logo_cache[key] = OverlayLayer.from_file(path, anchor=anchor, scale=scale)
+                        logger.info(f"🏷️ Loaded overlay logo {path}")
+                    layers.append(_logo_cache[key])
+                except Exception as e:
+                    logger.error(f"Failed to load overlay logo {path}: {e}")
+                break
+    return Overlay(layers) if layers else None
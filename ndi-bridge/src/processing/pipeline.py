@@ -4,11 +4,20 @@ Stream Pipeline - Processes video frames from WebRTC to NDI
 
 import asyncio
 import logging
+import cv2
 import numpy as np
 from typing import Optional, Callable, Dict, Any
 from datetime import datetime, timedelta
 import time
 
+from processing.denoise import TemporalDenoiser
+from processing.frame_rate import FrameRateConverter
+from processing.keyer import ChromaKeyer
+from processing.lut3d import ColorMatcher, LUT3D
+from processing.overlay import Overlay
+from processing.scheduler import CpuMeter, DeadlineMissed
+from utils.metrics import record_frame_dropped
+
 logger = logging.getLogger(__name__)
 
 class StreamPipeline:
@@ -34,6 +43,37 @@ class StreamPipeline:
         self.is_processing = False
         self.processing_task: Optional[asyncio.Task] = None
         
+        # Output profile imposed by admission control (None = pass through)
+        self.output_width: Optional[int] = None
+        self.output_height: Optional[int] = None
+        self.output_fps: Optional[float] = None
+        self.next_output_time = 0.0
+        
+        # Row-banded scale + BGRA conversion on the shared pool (None = inline)
+        self.band_converter = None
+        
+        # Colour correction: a fixed .cube LUT, else one auto-matched to the reference camera
+        self.lut: Optional[LUT3D] = None
+        self.color_matcher: Optional[ColorMatcher] = None
+        self.device_name = stream_id
+        
+        # Temporal noise reduction with this stream's one-frame history (None = off)
+        self.denoiser: Optional[TemporalDenoiser] = None
+        
+        # Chroma key into the alpha channel (None = opaque output)
+        self.keyer: Optional[ChromaKeyer] = None
+        
+        # Logo bug / name strap composited over the output (None = clean feed)
+        self.overlay: Optional[Overlay] = None
+        
+        # House clock: frames wait for the shared tick instead of going out on arrival
+        self.house_clock = None
+        self.clock_subscription: Optional[int] = None
+        self.pending_frame: Optional[np.ndarray] = None
+        self.last_sent_frame: Optional[np.ndarray] = None
+        # Blends source frames to the house clock rate (None = newest frame / repeat)
+        self.frame_rate_converter: Optional[FrameRateConverter] = None
+        
         # Statistics
         self.stats = {
             "frames_received": 0,
@@ -42,12 +82,20 @@ class StreamPipeline:
             "last_frame_time": None,
             "processing_fps": 0.0,
             "queue_size": 0,
-            "processing_latency": 0.0
+            "processing_latency": 0.0,
+            "frames_decimated": 0,
+            "frames_late": 0,
+            "frames_repeated": 0,
+            "processing_cost": 0.0
         }
         
         # Performance monitoring
         self.fps_calculator = FPSCalculator()
         self.latency_tracker = LatencyTracker()
+        # CPU time of this stream on the event loop and the frame workers;
+        # sampled against wall time for processing_cost
+        self.cpu_meter = CpuMeter()
+        self._cost_sample = (time.monotonic(), 0.0)
         
         logger.info(f"Stream pipeline initialized for: {stream_id}")
     
@@ -61,6 +109,8 @@ class StreamPipeline:
         
         self.is_processing = True
         self.processing_task = asyncio.create_task(self._process_frames())
+        if self.house_clock:
+            self.clock_subscription = self.house_clock.subscribe(self._on_tick)
         
         logger.info(f"Started processing pipeline for stream: {self.stream_id}")
     
@@ -73,6 +123,10 @@ class StreamPipeline:
         
         self.is_processing = False
         
+        if self.house_clock and self.clock_subscription is not None:
+            self.house_clock.unsubscribe(self.clock_subscription)
+            self.clock_subscription = None
+        
         if self.processing_task:
             self.processing_task.cancel()
             try:
@@ -89,6 +143,21 @@ class StreamPipeline:
         
         logger.info(f"Stopped processing pipeline for stream: {self.stream_id}")
     
+    def set_output_profile(self, width: Optional[int], height: Optional[int], fps: Optional[float]):
+        """
+        Limit output resolution and frame rate
+        
+        Args:
+            width: Output width (None to keep source width)
+            height: Output height (None to keep source height)
+            fps: Maximum output frame rate (None for no limit)
+        """
+        self.output_width = width
+        self.output_height = height
+        self.output_fps = fps
+        self.next_output_time = 0.0
+        logger.info(f"Output profile for {self.stream_id}: {width}x{height}@{fps}")
+    
     async def add_frame(self, frame: np.ndarray, timestamp: Optional[float] = None):
         """
         Add frame to processing queue
@@ -170,13 +239,67 @@ class StreamPipeline:
             processing_start = time.time()
             queue_latency = processing_start - queue_time
             
+            # Decimate to the output frame rate
+            if self.output_fps:
+                if timestamp < self.next_output_time:
+                    self.stats["frames_decimated"] += 1
+                    return
+                interval = 1.0 / self.output_fps
+                self.next_output_time = max(self.next_output_time + interval, timestamp + interval / 2)
+            
+            with self.cpu_meter.measure():
+                lut = self._current_lut(frame)
+            
+            # Scale to the output resolution
+            if self.band_converter:
+                # Bands convert and key in parallel and the sender gets BGRA it can send as is
+                try:
+                    frame = await self.band_converter.convert_async(
+                        frame,
+                        self.output_width or frame.shape[1],
+                        self.output_height or frame.shape[0],
+                        deadline=self._frame_deadline(timestamp),
+                        lut=lut,
+                        denoiser=self.denoiser,
+                        keyer=self.keyer
+                    )
+                except DeadlineMissed:
+                    # The next frame is due; sending this one would only delay it
+                    self.stats["frames_late"] += 1
+                    record_frame_dropped(self.stream_id, "deadline")
+                    return
+            else:
+                with self.cpu_meter.measure():
+                    if self.output_width and self.output_height:
+                        if frame.shape[1] != self.output_width or frame.shape[0] != self.output_height:
+                            frame = cv2.resize(frame, (self.output_width, self.output_height), interpolation=cv2.INTER_AREA)
+                    if lut is not None:
+                        frame = lut.apply(frame)
+                    if self.denoiser is not None:
+                        frame = self.denoiser.apply(frame)
+                    # Key the green/blue screen into a real alpha channel
+                    if self.keyer:
+                        frame = self.keyer.apply(frame)
+            
+            # Branding goes on last so it stays opaque over keyed-out areas
+            if self.overlay:
+                with self.cpu_meter.measure():
+                    frame = self.overlay.composite(frame)
+            
             # Update NDI sender dimensions if needed
             height, width = frame.shape[:2]
             if self.ndi_sender.width != width or self.ndi_sender.height != height:
                 self.ndi_sender.update_dimensions(width, height)
             
-            # Send frame to NDI
-            success = await self.ndi_sender.send_frame(frame)
+            # Send frame to NDI, or hand it to the next house clock tick
+            if self.house_clock:
+                if self.frame_rate_converter:
+                    self.frame_rate_converter.push(frame, timestamp)
+                else:
+                    self.pending_frame = frame
+                success = True
+            else:
+                success = await self.ndi_sender.send_frame(frame)
             
             if success:
                 self.stats["frames_processed"] += 1
@@ -191,6 +314,8 @@ class StreamPipeline:
                 self.latency_tracker.add_measurement(total_latency)
                 self.stats["processing_latency"] = self.latency_tracker.get_average_latency()
                 
+                self._update_processing_cost()
+                
                 # Log every 100 frames
                 if self.stats["frames_processed"] % 100 == 0:
                     logger.debug(f"Processed {self.stats['frames_processed']} frames for {self.stream_id}")
@@ -200,6 +325,78 @@ class StreamPipeline:
         except Exception as e:
             logger.error(f"Error processing single frame for {self.stream_id}: {e}")
     
+    def _update_processing_cost(self, window: float = 1.0):
+        """CPU cores spent on this stream: CPU seconds per wall second, over `window` seconds"""
+        now = time.monotonic()
+        sampled_at, sampled_cpu = self._cost_sample
+        if now - sampled_at < window:
+            return
+        cpu = self.cpu_meter.total
+        self.stats["processing_cost"] = (cpu - sampled_cpu) / (now - sampled_at)
+        self._cost_sample = (now, cpu)
+    
+    def _current_lut(self, frame: np.ndarray) -> Optional[LUT3D]:
+        """LUT for this frame; feeds the auto-matcher when no fixed LUT is set"""
+        if self.lut is not None or not self.color_matcher:
+            return self.lut
+        self.color_matcher.observe(self.device_name, frame)
+        return self.color_matcher.lut_for(self.device_name)
+    
+    async def _on_tick(self, index: int, tick_time: float):
+        """
+        Submit the newest frame on a house clock tick
+        
+        Without a new frame the previous one is repeated, so the source
+        keeps the house frame rate and switchers never see a gap. With a
+        frame-rate converter the tick gets a blend of the source frames
+        around it instead.
+        """
+        if self.frame_rate_converter:
+            await self._on_converted_tick(tick_time)
+            return
+        
+        frame = self.pending_frame
+        if frame is None:
+            frame = self.last_sent_frame
+            if frame is None:
+                return
+            self.stats["frames_repeated"] += 1
+        self.pending_frame = None
+        
+        if await self.ndi_sender.send_frame(frame, timecode=tick_time):
+            self.last_sent_frame = frame
+    
+    async def _on_converted_tick(self, tick_time: float):
+        """Send the frame-rate converted frame of a house clock tick"""
+        scheduler = self.band_converter.scheduler if self.band_converter else None
+        bands = self.band_converter.bands if self.band_converter else 1
+        deadline = time.monotonic() + (tick_time + self.house_clock.interval - time.time())
+        try:
+            frame = await self.frame_rate_converter.render(tick_time, scheduler, bands, deadline, self.cpu_meter)
+        except DeadlineMissed:
+            frame = self.last_sent_frame
+            self.stats["frames_late"] += 1
+        if frame is None:
+            return
+        if frame is self.last_sent_frame:
+            self.stats["frames_repeated"] += 1
+        
+        if await self.ndi_sender.send_frame(frame, timecode=tick_time):
+            self.last_sent_frame = frame
+    
+    def _frame_deadline(self, timestamp: float) -> Optional[float]:
+        """
+        Output deadline of a frame on the stream's pacing clock
+        
+        A frame has to be out before the next one is due, one frame interval
+        after it arrived. Returns time.monotonic() seconds, None if the
+        stream has no known cadence.
+        """
+        fps = self.output_fps or getattr(self.ndi_sender, "fps", None)
+        if not isinstance(fps, (int, float)) or fps <= 0:
+            return None
+        return time.monotonic() + (timestamp + 1.0 / fps - time.time())
+    
     def get_stats(self) -> dict:
         """
         Get pipeline statistics
@@ -207,13 +404,16 @@ class StreamPipeline:
         Returns:
             dict: Pipeline statistics
         """
-        return {
+        stats = {
             "stream_id": self.stream_id,
             "is_processing": self.is_processing,
             "queue_size": self.frame_queue.qsize(),
             "max_queue_size": self.max_queue_size,
             **self.stats
         }
+        if self.frame_rate_converter:
+            stats["frame_rate_conversion"] = dict(self.frame_rate_converter.stats)
+        return stats
     
     def get_performance_stats(self) -> dict:
         """
@@ -0,0 +1,198 @@
+"""
+Deadline Scheduler - Earliest-deadline-first worker pool for frame work
+shared by all streams
+"""
+
+import heapq
+import itertools
+import logging
+import math
+import os
+import threading
+import time
+from concurrent.futures import Future
+from contextlib import contextmanager
+from typing import Callable, Dict, List, Optional, Tuple
+
+logger = logging.getLogger(__name__)
+
+
+class DeadlineMissed(Exception):
+    """Raised through a task's future when it was dropped for its deadline"""
+
+
+class CpuMeter:
+    """
+    CPU time spent on behalf of one stream, summed over every thread that
+    works for it (thread CPU time, so waiting and other streams' work
+    interleaved on the same thread are not counted)
+    """
+
+    def __init__(self):
+        self.total = 0.0
+        self._lock = threading.Lock()
+
+    def add(self, seconds: float):
+        with self._lock:
+            self.total += seconds
+
+    @contextmanager
+    def measure(self):
+        """Count the calling thread's CPU time spent inside the block"""
+        start = time.thread_time()
+        try:
+            yield
+        finally:
+            self.add(time.thread_time() - start)
+
+
+class DeadlineScheduler:
+    """
+    Worker pool that always runs the pending task with the nearest deadline.
+
+    Deadlines come from each stream's pacing clock, so a heavy 4K frame
+    due in 30 ms waits behind 720p bands due in 5 ms instead of blocking
+    them as it would in a FIFO pool. A task that can no longer finish
+    before its deadline, judged by the measured run time of its kind, is
+    dropped before it wastes a worker. Tasks without a deadline run after
+    all deadline work, oldest first.
+
+    The submit() signature is compatible with concurrent.futures executors.
+    """
+
+    def __init__(self, workers: int = 4, drop_late: bool = True):
+        """
+        Initialize scheduler
+
+        Args:
+            workers: Number of worker threads
+            drop_late: Drop tasks that cannot make their deadline
+        """
+        self.workers = max(1, workers)
+        self.drop_late = drop_late
+
+        self._queue: List[Tuple[float, int, Future, Callable, tuple, str, Optional[CpuMeter]]] = []
+        self._sequence = itertools.count()
+        self._condition = threading.Condition()
+        self._threads: List[threading.Thread] = []
+        self._shutdown = False
+
+        # Smoothed run time per task kind, seconds
+        self.cost_estimates: Dict[str, float] = {}
+
+        self.stats = {
+            "submitted": 0,
+            "completed": 0,
+            "dropped_late": 0,
+            "missed": 0  # ran but finished after the deadline
+        }
+
+        for index in range(self.workers):
+            thread = threading.Thread(target=self._worker, name=f"edf-{index}", daemon=True)
+            thread.start()
+            self._threads.append(thread)
+
+    def submit(self, fn: Callable, *args, deadline: Optional[float] = None, kind: str = "task",
+               meter: Optional[CpuMeter] = None) -> Future:
+        """
+        Queue a task
+
+        Args:
+            fn: Callable to run on a worker
+            *args: Arguments for fn
+            deadline: time.monotonic() by which the result is needed, None for no deadline
+            kind: Task kind for run-time estimates (e.g. "convert", "send")
+            meter: Charged with the task's CPU time, None for no accounting
+
+        Returns:
+            Future: Result of fn, or DeadlineMissed if dropped
+        """
+        future = Future()
+        with self._condition:
+            if self._shutdown:
+                raise RuntimeError("scheduler is shut down")
+            key = deadline if deadline is not None else math.inf
+            heapq.heappush(self._queue, (key, next(self._sequence), future, fn, args, kind, meter))
+            self.stats["submitted"] += 1
+            self._condition.notify()
+        return future
+
+    def _worker(self):
+        while True:
+            with self._condition:
+                while not self._queue and not self._shutdown:
+                    self._condition.wait()
+                if self._shutdown and not self._queue:
+                    return
+                deadline, _, future, fn, args, kind, meter = heapq.heappop(self._queue)
+
+            if not future.set_running_or_notify_cancel():
+                continue
+
+            start = time.monotonic()
+            if self.drop_late and deadline != math.inf and start + self.cost_estimates.get(kind, 0.0) > deadline:
+                self.stats["dropped_late"] += 1
+                future.set_exception(DeadlineMissed(f"{kind} task {(start - deadline) * 1000:.1f} ms past its deadline"))
+                continue
+
+            cpu_start = time.thread_time()
+            try:
+                result = fn(*args)
+            except BaseException as e:
+                future.set_exception(e)
+                continue
+            finally:
+                if meter is not None:
+                    meter.add(time.thread_time() - cpu_start)
+
+            finished = time.monotonic()
+            previous = self.cost_estimates.get(kind)
+            elapsed = finished - start
+            self.cost_estimates[kind] = elapsed if previous is None else previous + (elapsed - previous) / 8
+            self.stats["completed"] += 1
+            if finished > deadline:
+                self.stats["missed"] += 1
+            future.set_result(result)
+
+    def pending(self) -> int:
+        """Number of queued tasks"""
+        with self._condition:
+            return len(self._queue)
+
+    def get_stats(self) -> dict:
+        """Get scheduler statistics"""
+        return {
+            **self.stats,
+            "workers": self.workers,
+            "pending": self.pending(),
+            "cost_estimates_ms": {kind: cost * 1000 for kind, cost in self.cost_estimates.items()}
+        }
+
+    def shutdown(self, wait: bool = True):
+        """Stop the workers after the queued tasks"""
+        with self._condition:
+            self._shutdown = True
+            self._condition.notify_all()
+        if wait:
+            for thread in self._threads:
+                thread.join()
+
+
+_scheduler: Optional[DeadlineScheduler] = None
+
+
+def get_frame_scheduler(workers: Optional[int] = None, drop_late: bool = True) -> DeadlineScheduler:
+    """
+    Scheduler shared by all streams
+
+    Args:
+        workers: Pool size on first use (defaults to the CPU count)
+        drop_late: Drop tasks that cannot make their deadline, on first use
+
+    Returns:
+        DeadlineScheduler: Shared frame scheduler
+    """
+    global _scheduler
+    if _scheduler is None:
+        _scheduler = DeadlineScheduler(workers or os.cpu_count() or 1, drop_late)
+    return _scheduler
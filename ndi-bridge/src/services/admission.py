@@ -0,0 +1,361 @@
+"""
+Admission Control - CPU budget tracking and load shedding for NDI streams
+"""
+
+import logging
+import os
+from dataclasses import dataclass
+from enum import Enum
+from typing import Dict, List, Optional, Tuple
+
+logger = logging.getLogger(__name__)
+
+
+class AdmissionDecision(Enum):
+    ACCEPT = "accept"
+    DOWNGRADE = "downgrade"
+    REJECT = "reject"
+
+
+@dataclass(frozen=True)
+class OutputProfile:
+    """
+    Output resolution and frame rate a stream is allowed to run at
+    """
+    width: int
+    height: int
+    fps: int
+
+    @property
+    def pixel_rate(self) -> float:
+        """Megapixels per second produced by this profile"""
+        return self.width * self.height * self.fps / 1_000_000
+
+    def fits_within(self, other: "OutputProfile") -> bool:
+        """True if width, height and frame rate are each at most those of `other`"""
+        return self.width <= other.width and self.height <= other.height and self.fps <= other.fps
+
+    def __str__(self) -> str:
+        return f"{self.width}x{self.height}@{self.fps}"
+
+
+# Degradation ladder, highest first. Streams are only ever moved down to a
+# profile that is not larger than what they originally asked for.
+PROFILE_LADDER = [
+    OutputProfile(3840, 2160, 60),
+    OutputProfile(3840, 2160, 30),
+    OutputProfile(1920, 1080, 60),
+    OutputProfile(2560, 1440, 30),
+    OutputProfile(1920, 1080, 30),
+    OutputProfile(1280, 720, 30),
+    OutputProfile(960, 540, 30),
+    OutputProfile(640, 360, 30),
+    OutputProfile(640, 360, 15),
+]
+
+
+@dataclass
+class StreamCost:
+    """
+    Measured cost of a running stream
+    """
+    requested: OutputProfile
+    profile: OutputProfile
+    priority: int = 0
+    cost: Optional[float] = None  # CPU cores used, None until measured
+
+
+class AdmissionController:
+    """
+    Keeps an estimate of remaining CPU capacity from per-stream cost
+    measurements and decides whether new streams are accepted, downgraded
+    or rejected, and which running streams to lower when the host is
+    over budget.
+    """
+
+    def __init__(
+        self,
+        cpu_budget_percent: float = 80.0,
+        default_stream_cost: float = 0.25,
+        smoothing: float = 0.2,
+        cpu_count: Optional[int] = None,
+        enabled: bool = True
+    ):
+        """
+        Initialize admission controller
+
+        Args:
+            cpu_budget_percent: Share of all host cores the bridge may use
+            default_stream_cost: Assumed cores per 720p30 stream before any
+                stream has been measured
+            smoothing: EWMA factor applied to new cost measurements
+            cpu_count: Number of host cores (defaults to os.cpu_count())
+            enabled: When False every stream is accepted as requested
+        """
+        self.cpu_count = cpu_count or os.cpu_count() or 1
+        self.budget = self.cpu_count * cpu_budget_percent / 100.0
+        self.default_stream_cost = default_stream_cost
+        self.smoothing = smoothing
+        self.enabled = enabled
+
+        self.streams: Dict[str, StreamCost] = {}
+
+        logger.info(
+            f"Admission control {'enabled' if enabled else 'disabled'}: "
+            f"budget {self.budget:.2f} of {self.cpu_count} cores"
+        )
+
+    def cost_per_megapixel(self) -> float:
+        """
+        Average measured cost per megapixel/second across running streams
+
+        Returns:
+            float: CPU cores per megapixel/second
+        """
+        measured = [s for s in self.streams.values() if s.cost is not None]
+        pixel_rate = sum(s.profile.pixel_rate for s in measured)
+        if not measured or pixel_rate <= 0:
+            return self.default_stream_cost / OutputProfile(1280, 720, 30).pixel_rate
+        return sum(s.cost for s in measured) / pixel_rate
+
+    def estimate_cost(self, profile: OutputProfile) -> float:
+        """
+        Estimate the CPU cost of running a stream at the given profile
+
+        Args:
+            profile: Output profile
+
+        Returns:
+            float: Estimated CPU cores
+        """
+        return profile.pixel_rate * self.cost_per_megapixel()
+
+    def stream_cost(self, stream_id: str) -> float:
+        """Measured cost of a stream, or its estimate if not measured yet"""
+        stream = self.streams[stream_id]
+        if stream.cost is not None:
+            return stream.cost
+        return self.estimate_cost(stream.profile)
+
+    def used_capacity(self) -> float:
+        """CPU cores currently used by all admitted streams"""
+        return sum(self.stream_cost(stream_id) for stream_id in self.streams)
+
+    def remaining_capacity(self) -> float:
+        """CPU cores left in the budget"""
+        return self.budget - self.used_capacity()
+
+    def evaluate(
+        self,
+        requested: OutputProfile,
+        priority: int = 0
+    ) -> Tuple[AdmissionDecision, Optional[OutputProfile], List[Tuple[str, OutputProfile]]]:
+        """
+        Decide whether a new stream can be admitted
+
+        Args:
+            requested: Profile the stream asked for
+            priority: Stream priority, higher wins
+
+        Returns:
+            tuple: (decision, profile to run at, running streams to lower first)
+        """
+        if not self.enabled:
+            return AdmissionDecision.ACCEPT, requested, []
+
+        remaining = self.remaining_capacity()
+
+        # Best profile that fits without touching other streams
+        for profile in self._ladder_for(requested):
+            if self.estimate_cost(profile) <= remaining:
+                decision = AdmissionDecision.ACCEPT if profile == requested else AdmissionDecision.DOWNGRADE
+                return decision, profile, []
+
+        # Lower running streams of lower priority to make room for the
+        # smallest acceptable profile
+        smallest = self._ladder_for(requested)[-1]
+        needed = self.estimate_cost(smallest) - remaining
+        shed = self.plan_shedding(needed, below_priority=priority)
+        if shed:
+            return AdmissionDecision.DOWNGRADE, smallest, shed
+
+        return AdmissionDecision.REJECT, None, []
+
+    def plan_shedding(
+        self,
+        needed: float,
+        below_priority: Optional[int] = None
+    ) -> List[Tuple[str, OutputProfile]]:
+        """
+        Pick running streams to lower until enough capacity is freed
+
+        Streams are lowered one ladder step at a time, lowest priority and
+        most expensive first.
+
+        Args:
+            needed: CPU cores to free
+            below_priority: Only consider streams with a lower priority
+
+        Returns:
+            list: (stream_id, new profile) pairs, empty if not enough can be freed
+        """
+        candidates = {
+            stream_id: stream.profile
+            for stream_id, stream in self.streams.items()
+            if below_priority is None or stream.priority < below_priority
+        }
+
+        plan: Dict[str, OutputProfile] = {}
+        freed = 0.0
+        while freed < needed:
+            best = None
+            for stream_id, profile in candidates.items():
+                lower = self._next_lower(profile, self.streams[stream_id].requested)
+                if lower is None:
+                    continue
+                current_cost = self._scaled_cost(stream_id, profile)
+                saving = current_cost - self._scaled_cost(stream_id, lower)
+                key = (self.streams[stream_id].priority, -saving)
+                if best is None or key < best[0]:
+                    best = (key, stream_id, lower, saving)
+
+            if best is None:
+                return []
+
+            _, stream_id, lower, saving = best
+            candidates[stream_id] = lower
+            plan[stream_id] = lower
+            freed += saving
+
+        return list(plan.items())
+
+    def plan_restoring(self, headroom: float = 0.1) -> List[Tuple[str, OutputProfile]]:
+        """
+        Pick lowered streams to raise back toward the profile they asked for
+
+        Streams are raised one ladder step at a time, highest priority and
+        cheapest step first, as long as the budget keeps `headroom` spare so
+        a restore does not trip shedding again on the next measurement.
+
+        Args:
+            headroom: Share of the budget left free
+
+        Returns:
+            list: (stream_id, new profile) pairs, empty if nothing fits
+        """
+        if not self.enabled:
+            return []
+
+        available = self.remaining_capacity() - self.budget * headroom
+        candidates = {
+            stream_id: stream.profile
+            for stream_id, stream in self.streams.items()
+            if stream.profile != stream.requested
+        }
+
+        plan: Dict[str, OutputProfile] = {}
+        while True:
+            best = None
+            for stream_id, profile in candidates.items():
+                higher = self._next_higher(profile, self.streams[stream_id].requested)
+                if higher is None:
+                    continue
+                extra = self._scaled_cost(stream_id, higher) - self._scaled_cost(stream_id, profile)
+                if extra > available:
+                    continue
+                key = (-self.streams[stream_id].priority, extra)
+                if best is None or key < best[0]:
+                    best = (key, stream_id, higher, extra)
+
+            if best is None:
+                return list(plan.items())
+
+            _, stream_id, higher, extra = best
+            candidates[stream_id] = higher
+            plan[stream_id] = higher
+            available -= extra
+
+    def admit(self, stream_id: str, requested: OutputProfile, profile: OutputProfile, priority: int = 0):
+        """Register an admitted stream"""
+        self.streams[stream_id] = StreamCost(requested=requested, profile=profile, priority=priority)
+
+    def release(self, stream_id: str):
+        """Forget a stopped stream"""
+        self.streams.pop(stream_id, None)
+
+    def update_profile(self, stream_id: str, profile: OutputProfile):
+        """Record that a running stream was moved to another profile"""
+        stream = self.streams.get(stream_id)
+        if stream:
+            if stream.cost is not None:
+                stream.cost = self._scaled_cost(stream_id, profile)
+            stream.profile = profile
+
+    def record_cost(self, stream_id: str, cost: float):
+        """
+        Record a cost measurement for a running stream
+
+        Args:
+            stream_id: Stream identifier
+            cost: CPU cores used by the stream since the last measurement
+        """
+        stream = self.streams.get(stream_id)
+        if not stream:
+            return
+        if stream.cost is None:
+            stream.cost = cost
+        else:
+            stream.cost += self.smoothing * (cost - stream.cost)
+
+    def get_stats(self) -> dict:
+        """
+        Get admission statistics
+
+        Returns:
+            dict: Budget and per-stream cost information
+        """
+        return {
+            "enabled": self.enabled,
+            "cpu_count": self.cpu_count,
+            "budget": self.budget,
+            "used": self.used_capacity(),
+            "remaining": self.remaining_capacity(),
+            "streams": {
+                stream_id: {
+                    "requested": str(stream.requested),
+                    "profile": str(stream.profile),
+                    "priority": stream.priority,
+                    "cost": stream.cost
+                }
+                for stream_id, stream in self.streams.items()
+            }
+        }
+
+    def _ladder_for(self, requested: OutputProfile) -> List[OutputProfile]:
+        """Requested profile followed by every smaller ladder step within it"""
+        lower = [p for p in PROFILE_LADDER if p.pixel_rate < requested.pixel_rate and p.fits_within(requested)]
+        return [requested] + lower
+
+    def _next_lower(self, profile: OutputProfile, requested: OutputProfile) -> Optional[OutputProfile]:
+        """Next ladder step below a profile that stays within the requested one"""
+        for candidate in PROFILE_LADDER:
+            if candidate.pixel_rate < profile.pixel_rate and candidate.fits_within(requested):
+                return candidate
+        return None
+
+    def _next_higher(self, profile: OutputProfile, requested: OutputProfile) -> Optional[OutputProfile]:
+        """Next ladder step above a profile, the requested profile at the top"""
+        if profile == requested:
+            return None
+        higher = [
+            p for p in PROFILE_LADDER
+            if profile.pixel_rate < p.pixel_rate < requested.pixel_rate and p.fits_within(requested)
+        ]
+        return min(higher, key=lambda p: p.pixel_rate) if higher else requested
+
+    def _scaled_cost(self, stream_id: str, profile: OutputProfile) -> float:
+        """Cost of a stream scaled from its current profile to another one"""
+        stream = self.streams[stream_id]
+        if stream.profile.pixel_rate <= 0:
+            return 0.0
+        return self.stream_cost(stream_id) * profile.pixel_rate / stream.profile.pixel_rate
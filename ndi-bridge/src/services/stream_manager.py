@@ -4,13 +4,28 @@ Stream Manager - Manages multiple WebRTC streams and NDI outputs
 
 import asyncio
 import logging
-from typing import Dict, Optional, Callable, Any
+import time
+from typing import Dict, Optional, Callable, Any, Tuple
 from datetime import datetime
 
 from ndi.ndi_manager import NDIManager
 from webrtc.consumer import WebRTCConsumer
 from webrtc.signaling import WebRTCSignaling
+from processing.audio_pipeline import AudioPipeline
+from processing.band_pipeline import BandConverter
+from processing.denoise import TemporalDenoiser
+from processing.frame_rate import FrameRateConverter
+from processing.house_clock import HouseClock
+from processing.keyer import ChromaKeyer, create_chroma_keyer
+from processing.lut3d import ColorMatcher, load_stream_lut
+from processing.overlay import load_stream_overlay
 from processing.pipeline import StreamPipeline
+from processing.scheduler import get_frame_scheduler
+from services.admission import AdmissionController, AdmissionDecision, OutputProfile
+from webrtc.layer_selector import LayerSelector
+from utils.metrics import (
+    record_admission_decision, record_stream_cost, record_stream_shed, update_cpu_budget
+)
 
 logger = logging.getLogger(__name__)
 
@@ -19,13 +34,19 @@ class StreamManager:
     Manages multiple WebRTC streams and their NDI outputs
     """
     
-    def __init__(self, backend_url: str, ndi_source_prefix: str = "MobileCam"):
+    def __init__(
+        self,
+        backend_url: str,
+        ndi_source_prefix: str = "MobileCam",
+        admission: Optional[AdmissionController] = None
+    ):
         """
         Initialize stream manager
         
         Args:
             backend_url: Backend WebSocket URL
             ndi_source_prefix: Prefix for NDI source names
+            admission: Admission controller (defaults to an 80% CPU budget)
         """
         self.backend_url = backend_url
         self.ndi_source_prefix = ndi_source_prefix
@@ -38,10 +59,38 @@ class StreamManager:
         self.active_streams: Dict[str, dict] = {}
         self.ndi_senders: Dict[str, NDISender] = {}
         self.pipelines: Dict[str, StreamPipeline] = {}
+        self.audio_pipelines: Dict[str, AudioPipeline] = {}
         
         # Configuration
         self.max_streams = 10
         self.auto_consume = True
+        self.admission = admission or AdmissionController()
+        self.suspend_idle_decoders = False
+        self.idle_suspend_after = 5.0  # seconds without NDI receivers
+        self.conversion_bands = 4  # row bands per frame for scale/convert, 0 to disable
+        self.frame_workers: Optional[int] = None  # EDF pool size, None for one per CPU
+        self.drop_late_frames = True
+        self.house_clock = None  # HouseClock driving every sender, None for per-stream pacing
+        self.frame_rate_conversion = "repeat"  # "blend" mixes source frames to the house clock rate
+        self.ndi_async_send = True
+        self.audio_enabled = True
+        self.audio_block_samples = 480  # 10 ms NDI audio frames when self-paced
+        self.audio_buffer_ms = 40.0  # ASRC occupancy held against clock drift
+        self.audio_only_block_samples = 240  # 5 ms blocks for phones used only as mics
+        self.lut_dir = ""  # directory of per-device .cube LUTs, "" for none
+        self.color_matcher: Optional[ColorMatcher] = None  # auto-match to a reference camera
+        self.chroma_keyer: Optional[ChromaKeyer] = None
+        self.chroma_key_devices: set = set()  # device names to key, "*" for all
+        self.key_output_format = "UYVA"  # NDI alpha format of keyed streams
+        self.overlay_dir = ""  # directory of per-device logo PNGs, "" for none
+        self.overlay_position = "top-right"
+        self.overlay_scale = 0.12  # logo width as a fraction of the frame width
+        self.overlay_name_strap = False  # lower third with the device name
+        self.denoise_threshold = 0.0  # temporal denoise noise level in 8-bit levels, 0 to disable
+        # Assumed source format when the backend does not report one
+        self.default_width = 1280
+        self.default_height = 720
+        self.default_fps = 30
         
         # Callbacks
         self.on_stream_started: Optional[Callable[[str, dict], None]] = None
@@ -75,6 +124,8 @@ class StreamManager:
             self.webrtc_consumer.on_frame_received = self._on_frame_received
             self.webrtc_consumer.on_connection_state_change = self._on_connection_state_change
             self.webrtc_consumer.on_error = self._on_webrtc_error
+            self.webrtc_consumer.on_bitrate_estimate = self._on_bitrate_estimate
+            self.webrtc_consumer.cpu_load = self._cpu_load
             
             # Connect to backend
             if not await self.signaling.connect():
@@ -87,6 +138,7 @@ class StreamManager:
             # Register message handlers
             self.signaling.register_message_handler("stream-started", self._handle_new_producer)
             self.signaling.register_message_handler("stream-ended", self._handle_producer_closed)
+            self.signaling.register_message_handler("stream-audio-added", self._handle_audio_added)
             self.signaling.register_message_handler("stream-stats", self._handle_stream_stats)
             
             # Get initial active producers
@@ -94,6 +146,7 @@ class StreamManager:
             
             # Start health monitoring task
             asyncio.create_task(self.monitor_stream_health())
+            asyncio.create_task(self.monitor_tally())
             
             logger.info("Stream Manager initialized successfully")
             return True
@@ -130,19 +183,62 @@ class StreamManager:
         Returns:
             bool: True if stream started successfully
         """
+        reserved = False
         try:
             stream_id = stream_info.get("id")
             producer_id = stream_info.get("producer_id") or stream_info.get("producerId")
             device_name = stream_info.get("device_name", "Unknown")
-            resolution = stream_info.get("resolution", {"width": 1280, "height": 720})
+            resolution = stream_info.get("resolution") or {}
             
             if not stream_id or not producer_id:
                 logger.error("Invalid stream info: missing IDs")
                 return False
             
+            audio_only = stream_info.get("kind") == "audio"
             if stream_id in self.active_streams:
-                logger.warning(f"Stream {stream_id} already active")
-                return True
+                if self.active_streams[stream_id].get("audio_only") and not audio_only:
+                    # A mic-only phone turned its camera on: rebuild as a video stream
+                    logger.info(f"Stream {stream_id} gained video, restarting with video output")
+                    await self.stop_stream(stream_id)
+                else:
+                    logger.warning(f"Stream {stream_id} already active")
+                    return True
+            
+            if len(self.active_streams) >= self.max_streams:
+                logger.warning(f"Rejecting stream {stream_id}: max_streams ({self.max_streams}) reached")
+                record_admission_decision(AdmissionDecision.REJECT.value)
+                return False
+            
+            if audio_only:
+                return await self._start_audio_only_stream(stream_id, producer_id, device_name, stream_info)
+            
+            # Admission control against the CPU budget
+            requested = OutputProfile(
+                int(resolution.get("width", self.default_width)),
+                int(resolution.get("height", self.default_height)),
+                int(stream_info.get("fps", self.default_fps))
+            )
+            priority = int(stream_info.get("priority", 0))
+            decision, profile, shed = self.admission.evaluate(requested, priority)
+            record_admission_decision(decision.value)
+            
+            if decision == AdmissionDecision.REJECT:
+                logger.warning(
+                    f"Rejecting stream {stream_id}: {requested} does not fit in remaining CPU budget "
+                    f"({self.admission.remaining_capacity():.2f} cores)"
+                )
+                return False
+            
+            if decision == AdmissionDecision.DOWNGRADE:
+                logger.info(f"Downgrading stream {stream_id} from {requested} to {profile}")
+            
+            # Make room by lowering lower-priority streams and hold this stream's
+            # share before awaiting the backend, so concurrent starts see it taken
+            for shed_id, shed_profile in shed:
+                self._apply_output_profile(shed_id, shed_profile)
+            self.admission.admit(stream_id, requested, profile, priority)
+            update_cpu_budget(self.admission.remaining_capacity())
+            reserved = True
             
             logger.info(f"🚀 Starting stream {stream_id} ({device_name})")
             
@@ -168,30 +264,44 @@ class StreamManager:
             rtp_parameters = response.get('rtp_parameters', {})
             stream_metadata = response.get('stream_metadata', {})
             
-            # Create NDI Manager with intelligent fallback
-            ndi_source_name = f"{self.ndi_source_prefix}_{device_name}"
-            ndi_manager = NDIManager(
-                source_name=ndi_source_name,
-                width=stream_metadata.get('width', 1280),
-                height=stream_metadata.get('height', 720),
-                fps=stream_metadata.get('fps', 30)
+            # Simulcast/SVC layers available on the consumer
+            encodings = rtp_parameters.get('encodings') or [{}]
+            layer_selector = LayerSelector(
+                source_width=stream_metadata.get('width', requested.width),
+                source_height=stream_metadata.get('height', requested.height),
+                source_fps=stream_metadata.get('fps', requested.fps),
+                scalability_mode=encodings[0].get('scalabilityMode'),
+                producer_encodings=response.get('producer_encodings')
             )
             
-            # Initialize NDI output
-            if not await ndi_manager.initialize():
-                logger.error(f"Failed to initialize NDI for {stream_id}")
+            # Create NDI output and processing pipeline
+            if decision == AdmissionDecision.DOWNGRADE:
+                ndi_width, ndi_height, ndi_fps = profile.width, profile.height, profile.fps
+            else:
+                ndi_width = stream_metadata.get('width', requested.width)
+                ndi_height = stream_metadata.get('height', requested.height)
+                ndi_fps = stream_metadata.get('fps', requested.fps)
+            output = await self._create_output(
+                stream_id, device_name, ndi_width, ndi_height, ndi_fps,
+                source_fps=stream_metadata.get('fps') or self.default_fps
+            )
+            if output is None:
                 return False
-            
-            # Create processing pipeline
-            pipeline = StreamPipeline(stream_id, ndi_manager)
+            ndi_manager, pipeline = output
+            if decision == AdmissionDecision.DOWNGRADE:
+                pipeline.set_output_profile(profile.width, profile.height, profile.fps)
+            elif layer_selector.has_layers:
+                # Layer switches must not change the NDI output size
+                pipeline.set_output_profile(ndi_width, ndi_height, None)
             await pipeline.start()
             
-            # Start RTP reception with aiortc (with GStreamer fallback)
-            if not await self.webrtc_consumer.consume_stream(
+            # Start RTP reception (native receiver, aiortc and GStreamer fallbacks)
+            if not await self.webrtc_consumer.receive_stream(
                 stream_id, 
                 producer_id, 
                 transport_info,
-                rtp_parameters
+                rtp_parameters,
+                response.get('consumer_id')
             ):
                 logger.error(f"Failed to start RTP reception for {stream_id}")
                 await pipeline.stop()
@@ -204,17 +314,31 @@ class StreamManager:
                 "ndi_manager": ndi_manager,
                 "pipeline": pipeline,
                 "transport_info": transport_info,
+                "consumer_id": response.get('consumer_id'),
+                "layer_selector": layer_selector,
+                "layers": None,
+                # Output profile at the requested quality, restored after shedding
+                "base_output": (ndi_width, ndi_height, None) if layer_selector.has_layers else (None, None, None),
+                "on_program": False,
                 "started_at": datetime.now()
             }
             
             self.ndi_senders[stream_id] = ndi_manager
             self.pipelines[stream_id] = pipeline
+            # From here stop_stream releases the reservation
+            reserved = False
+            
+            await self._update_preferred_layers(stream_id)
+            
+            audio_producer_id = stream_info.get("audio_producer_id") or stream_info.get("audioProducerId")
+            if audio_producer_id:
+                await self._start_audio(stream_id, audio_producer_id, rtp_capabilities)
             
             # Update statistics
             self.stats["total_streams_created"] += 1
             self.stats["active_streams"] = len(self.active_streams)
             
-            logger.info(f"✅ Stream {stream_id} started successfully -> {ndi_source_name}")
+            logger.info(f"✅ Stream {stream_id} started successfully -> {ndi_manager.source_name}")
             
             if self.on_stream_started:
                 self.on_stream_started(stream_id, stream_info)
@@ -226,6 +350,152 @@ class StreamManager:
             if self.on_error:
                 self.on_error(f"start-stream-{stream_id}", e)
             return False
+        finally:
+            if reserved:
+                self._release_reservation(stream_id)
+    
+    async def _create_output(self, stream_id: str, device_name: str, width: int, height: int, fps: float,
+                             source_fps: float) -> Optional[Tuple[NDIManager, StreamPipeline]]:
+        """
+        Create a stream's NDI source and its (not yet started) processing pipeline
+        
+        Args:
+            stream_id: Stream identifier
+            device_name: Device name, used for the NDI source name and per-device looks
+            width: NDI output width
+            height: NDI output height
+            fps: NDI output frame rate (the house clock rate when one runs)
+            source_fps: Frame rate the source is expected to send
+            
+        Returns:
+            tuple: (NDI manager, pipeline), None if NDI could not be initialized
+        """
+        if self.house_clock:
+            fps = self.house_clock.fps
+        keyed = self.chroma_keyer is not None and (
+            "*" in self.chroma_key_devices or device_name in self.chroma_key_devices
+        )
+        ndi_manager = NDIManager(
+            source_name=f"{self.ndi_source_prefix}_{device_name}",
+            width=width,
+            height=height,
+            fps=fps,
+            clock_video=self.house_clock is None,
+            async_send=self.ndi_async_send,
+            pixel_format=self.key_output_format if keyed else "BGRX"
+        )
+        
+        # Initialize NDI output
+        if not await ndi_manager.initialize():
+            logger.error(f"Failed to initialize NDI for {stream_id}")
+            return None
+        
+        pipeline = StreamPipeline(stream_id, ndi_manager)
+        pipeline.house_clock = self.house_clock
+        if self.house_clock and self.frame_rate_conversion == "blend":
+            pipeline.frame_rate_converter = FrameRateConverter(self.house_clock.fps, source_fps=source_fps)
+        if self.conversion_bands:
+            pipeline.band_converter = BandConverter(
+                bands=self.conversion_bands,
+                scheduler=get_frame_scheduler(self.frame_workers, self.drop_late_frames),
+                cpu_meter=pipeline.cpu_meter
+            )
+        pipeline.lut = load_stream_lut(self.lut_dir, device_name)
+        if self.denoise_threshold:
+            pipeline.denoiser = TemporalDenoiser(threshold=self.denoise_threshold)
+        pipeline.color_matcher = self.color_matcher
+        pipeline.device_name = device_name
+        if keyed:
+            pipeline.keyer = self.chroma_keyer
+        pipeline.overlay = load_stream_overlay(
+            self.overlay_dir, device_name, self.overlay_name_strap,
+            anchor=self.overlay_position, scale=self.overlay_scale
+        )
+        return ndi_manager, pipeline
+    
+    async def start_whip_stream(self, stream_id: str, device_name: str, width: int, height: int) -> bool:
+        """
+        Start NDI output for a stream published straight to the bridge over WHIP
+        
+        Frames are pushed into the stream's pipeline by the WHIP session;
+        there is no mediasoup consumer behind it.
+        
+        Args:
+            stream_id: Stream identifier
+            device_name: Device name for the NDI source
+            width: Width of the first decoded frame
+            height: Height of the first decoded frame
+            
+        Returns:
+            bool: True if the stream's output is running
+        """
+        reserved = False
+        try:
+            if stream_id in self.active_streams:
+                return True
+            if len(self.active_streams) >= self.max_streams:
+                logger.warning(f"Rejecting WHIP stream {stream_id}: max_streams ({self.max_streams}) reached")
+                record_admission_decision(AdmissionDecision.REJECT.value)
+                return False
+            
+            requested = OutputProfile(width, height, int(self.default_fps))
+            decision, profile, shed = self.admission.evaluate(requested, 0)
+            record_admission_decision(decision.value)
+            if decision == AdmissionDecision.REJECT:
+                logger.warning(f"Rejecting WHIP stream {stream_id}: {requested} does not fit in remaining CPU budget")
+                return False
+            
+            for shed_id, shed_profile in shed:
+                self._apply_output_profile(shed_id, shed_profile)
+            self.admission.admit(stream_id, requested, profile, 0)
+            update_cpu_budget(self.admission.remaining_capacity())
+            reserved = True
+            
+            output = await self._create_output(
+                stream_id, device_name, profile.width, profile.height, profile.fps, source_fps=self.default_fps
+            )
+            if output is None:
+                return False
+            ndi_manager, pipeline = output
+            if decision == AdmissionDecision.DOWNGRADE:
+                pipeline.set_output_profile(profile.width, profile.height, profile.fps)
+            await pipeline.start()
+            
+            stream_info = {"id": stream_id, "device_name": device_name, "kind": "video", "ingest": "whip"}
+            self.active_streams[stream_id] = {
+                "stream_info": stream_info,
+                "ndi_manager": ndi_manager,
+                "pipeline": pipeline,
+                "whip": True,
+                "on_program": False,
+                "started_at": datetime.now()
+            }
+            self.ndi_senders[stream_id] = ndi_manager
+            self.pipelines[stream_id] = pipeline
+            reserved = False
+            
+            if self.audio_enabled:
+                audio_pipeline = AudioPipeline(
+                    stream_id, ndi_manager, block_samples=self.audio_block_samples, target_ms=self.audio_buffer_ms
+                )
+                audio_pipeline.house_clock = self.house_clock
+                await audio_pipeline.start()
+                self.audio_pipelines[stream_id] = audio_pipeline
+            
+            self.stats["total_streams_created"] += 1
+            self.stats["active_streams"] = len(self.active_streams)
+            logger.info(f"✅ WHIP stream {stream_id} started -> {ndi_manager.source_name}")
+            
+            if self.on_stream_started:
+                self.on_stream_started(stream_id, {**stream_info, "resolution": {"width": width, "height": height}})
+            return True
+            
+        except Exception as e:
+            logger.error(f"Failed to start WHIP stream {stream_id}: {e}")
+            return False
+        finally:
+            if reserved:
+                self._release_reservation(stream_id)
     
     async def stop_stream(self, stream_id: str) -> bool:
         """
@@ -242,14 +512,21 @@ class StreamManager:
                 logger.warning(f"Stream {stream_id} not found")
                 return False
             
-            # Stop WebRTC consumption
-            await self.webrtc_consumer.stop_stream(stream_id)
+            # Stop WebRTC consumption (WHIP streams have no consumer)
+            if not self.active_streams[stream_id].get("whip"):
+                await self.webrtc_consumer.stop_stream(stream_id)
+            
+            audio_pipeline = self.audio_pipelines.pop(stream_id, None)
+            if audio_pipeline:
+                await audio_pipeline.stop()
             
             # Stop pipeline
             pipeline = self.pipelines.get(stream_id)
             if pipeline:
                 await pipeline.stop()
                 del self.pipelines[stream_id]
+                if self.color_matcher:
+                    self.color_matcher.forget(pipeline.device_name)
             
             # Close NDI sender
             ndi_sender = self.ndi_senders.get(stream_id)
@@ -259,6 +536,9 @@ class StreamManager:
             
             # Remove from active streams
             del self.active_streams[stream_id]
+            self.admission.release(stream_id)
+            self._restore_load()
+            update_cpu_budget(self.admission.remaining_capacity())
             
             # Update statistics
             self.stats["active_streams"] = len(self.active_streams)
@@ -274,6 +554,128 @@ class StreamManager:
             logger.error(f"Failed to stop stream {stream_id}: {e}")
             return False
     
+    async def _start_audio_only_stream(self, stream_id: str, producer_id: str, device_name: str,
+                                       stream_info: dict) -> bool:
+        """
+        Start a stream from a phone used only as a wireless mic
+        
+        The NDI source carries audio frames only: no video buffers, no
+        StreamPipeline, no conversion and no admission cost. Audio is sent in
+        small self-paced blocks rather than on house clock ticks, which would
+        bunch it into frame-sized blocks for no reason without video.
+        
+        Args:
+            stream_id: Stream identifier
+            producer_id: Mediasoup audio producer ID
+            device_name: Device name for the NDI source
+            stream_info: Stream information from backend
+            
+        Returns:
+            bool: True if stream started successfully
+        """
+        if not self.audio_enabled:
+            logger.warning(f"Ignoring audio-only stream {stream_id}: audio is disabled")
+            return False
+        
+        logger.info(f"🎙️ Starting audio-only stream {stream_id} ({device_name})")
+        
+        rtp_capabilities = await self.signaling.request_rtp_capabilities()
+        if not rtp_capabilities:
+            logger.error("Failed to get RTP capabilities")
+            return False
+        
+        ndi_source_name = f"{self.ndi_source_prefix}_{device_name}"
+        ndi_manager = NDIManager(
+            source_name=ndi_source_name,
+            fps=self.default_fps,
+            clock_video=False,
+            video=False
+        )
+        if not await ndi_manager.initialize():
+            logger.error(f"Failed to initialize NDI for {stream_id}")
+            return False
+        
+        self.ndi_senders[stream_id] = ndi_manager
+        if not await self._start_audio(
+            stream_id, producer_id, rtp_capabilities,
+            block_samples=self.audio_only_block_samples, follow_house_clock=False
+        ):
+            del self.ndi_senders[stream_id]
+            await ndi_manager.stop()
+            return False
+        
+        self.active_streams[stream_id] = {
+            "stream_info": stream_info,
+            "ndi_manager": ndi_manager,
+            "pipeline": None,
+            "audio_only": True,
+            "started_at": datetime.now()
+        }
+        
+        self.stats["total_streams_created"] += 1
+        self.stats["active_streams"] = len(self.active_streams)
+        
+        logger.info(f"✅ Audio-only stream {stream_id} started successfully -> {ndi_source_name}")
+        
+        if self.on_stream_started:
+            self.on_stream_started(stream_id, stream_info)
+        
+        return True
+    
+    async def _start_audio(self, stream_id: str, audio_producer_id: str, rtp_capabilities: dict,
+                           block_samples: Optional[int] = None, follow_house_clock: bool = True) -> bool:
+        """
+        Consume a stream's audio into its NDI source through the ASRC
+        
+        Args:
+            stream_id: Stream identifier
+            audio_producer_id: Mediasoup audio producer ID
+            rtp_capabilities: RTP capabilities for the consumer
+            block_samples: Samples per self-paced NDI audio frame (defaults to audio_block_samples)
+            follow_house_clock: Send on house clock ticks when one runs
+            
+        Returns:
+            bool: True if audio is flowing; video keeps running either way
+        """
+        if not self.audio_enabled or stream_id in self.audio_pipelines:
+            return False
+        
+        try:
+            response = await self.signaling.sio.call('ndi-bridge-consume-stream', {
+                "stream_id": stream_id,
+                "producer_id": audio_producer_id,
+                "rtp_capabilities": rtp_capabilities
+            })
+            if not response.get('success'):
+                logger.warning(f"Failed to consume audio for {stream_id}: {response.get('error')}")
+                return False
+            
+            audio_pipeline = AudioPipeline(
+                stream_id,
+                self.ndi_senders[stream_id],
+                block_samples=block_samples or self.audio_block_samples,
+                target_ms=self.audio_buffer_ms
+            )
+            if follow_house_clock:
+                audio_pipeline.house_clock = self.house_clock
+            
+            if not await self.webrtc_consumer.receive_audio(
+                stream_id,
+                response.get('transport', {}),
+                response.get('rtp_parameters', {}),
+                on_audio=audio_pipeline.push,
+                on_packet_timing=audio_pipeline.observe
+            ):
+                return False
+            
+            await audio_pipeline.start()
+            self.audio_pipelines[stream_id] = audio_pipeline
+            return True
+            
+        except Exception as e:
+            logger.error(f"Failed to start audio for {stream_id}: {e}")
+            return False
+    
     async def get_stream_stats(self, stream_id: str) -> Optional[dict]:
         """
         Get statistics for a specific stream
@@ -297,7 +699,10 @@ class StreamManager:
                 "started_at": stream_data.get("started_at"),
                 "uptime": (datetime.now() - stream_data.get("started_at", datetime.now())).total_seconds(),
                 "ndi_sender_stats": ndi_sender.get_stats() if ndi_sender else {},
-                "pipeline_stats": pipeline.get_stats() if pipeline else {}
+                "pipeline_stats": pipeline.get_stats() if pipeline else {},
+                "receiver_stats": self.webrtc_consumer.get_receiver_stats(stream_id),
+                "admission": self.admission.get_stats()["streams"].get(stream_id),
+                "audio_stats": self.audio_pipelines[stream_id].get_stats() if stream_id in self.audio_pipelines else None
             }
             
             return stats
@@ -329,7 +734,11 @@ class StreamManager:
             return {
                 "manager_stats": self.stats,
                 "stream_stats": stream_stats,
-                "total_active_streams": len(self.active_streams)
+                "total_active_streams": len(self.active_streams),
+                "admission": self.admission.get_stats(),
+                "house_clock": self.house_clock.get_stats() if self.house_clock else None,
+                "frame_scheduler": get_frame_scheduler(self.frame_workers, self.drop_late_frames).get_stats()
+                if self.conversion_bands else None
             }
             
         except Exception as e:
@@ -345,10 +754,16 @@ class StreamManager:
             try:
                 await asyncio.sleep(10)  # Check every 10 seconds
                 
+                self._update_stream_costs()
+                if not self._shed_load():
+                    self._restore_load()
+                
                 for stream_id, stream_data in list(self.active_streams.items()):
                     ndi_manager = stream_data.get("ndi_manager")
                     
-                    if ndi_manager:
+                    # Health is judged on video frames; mic-only sources have none.
+                    # WHIP streams end with their peer connection, not by restart
+                    if ndi_manager and not stream_data.get("audio_only") and not stream_data.get("whip"):
                         health = ndi_manager.get_stats()
                         
                         if not health.get('healthy', False):
@@ -359,6 +774,218 @@ class StreamManager:
             except Exception as e:
                 logger.error(f"Error in health monitor: {e}")
 
+    def _update_stream_costs(self):
+        """
+        Feed per-stream cost measurements from the pipelines into admission control
+        """
+        for stream_id, pipeline in self.pipelines.items():
+            cost = pipeline.get_stats().get("processing_cost", 0.0)
+            if cost > 0:
+                self.admission.record_cost(stream_id, cost)
+                record_stream_cost(stream_id, cost)
+        update_cpu_budget(self.admission.remaining_capacity())
+    
+    def _shed_load(self) -> bool:
+        """
+        Lower low-priority streams when measured cost exceeds the CPU budget
+        
+        Returns:
+            bool: True if the host was over budget
+        """
+        overload = -self.admission.remaining_capacity()
+        if overload <= 0:
+            return False
+        
+        plan = self.admission.plan_shedding(overload)
+        if not plan:
+            logger.warning(f"⚠️ Over CPU budget by {overload:.2f} cores and nothing left to shed")
+            return True
+        
+        logger.warning(f"⚠️ Over CPU budget by {overload:.2f} cores, lowering {len(plan)} stream(s)")
+        for stream_id, profile in plan:
+            self._apply_output_profile(stream_id, profile)
+        update_cpu_budget(self.admission.remaining_capacity())
+        return True
+    
+    def _release_reservation(self, stream_id: str):
+        """Give back the capacity held for a stream that failed to start"""
+        self.admission.release(stream_id)
+        self._restore_load()
+        update_cpu_budget(self.admission.remaining_capacity())
+    
+    def _restore_load(self):
+        """
+        Raise lowered streams back toward their requested profile as capacity frees up
+        """
+        plan = self.admission.plan_restoring()
+        for stream_id, profile in plan:
+            self._apply_output_profile(stream_id, profile)
+        if plan:
+            update_cpu_budget(self.admission.remaining_capacity())
+    
+    def _apply_output_profile(self, stream_id: str, profile: OutputProfile):
+        """
+        Move a running stream to another output profile
+        
+        Args:
+            stream_id: Stream identifier
+            profile: New output profile
+        """
+        pipeline = self.pipelines.get(stream_id)
+        stream = self.admission.streams.get(stream_id)
+        if not pipeline:
+            return
+        
+        raising = stream is not None and profile.pixel_rate > stream.profile.pixel_rate
+        if stream is not None and profile == stream.requested:
+            # Back to full quality: undo the scaling and decimation entirely
+            base = self.active_streams.get(stream_id, {}).get("base_output", (None, None, None))
+            pipeline.set_output_profile(*base)
+        else:
+            pipeline.set_output_profile(profile.width, profile.height, profile.fps)
+        logger.info(f"{'⬆️ Raising' if raising else '⬇️ Lowering'} stream {stream_id} to {profile}")
+        self.admission.update_profile(stream_id, profile)
+        if not raising:
+            record_stream_shed()
+        asyncio.create_task(self._update_preferred_layers(stream_id))
+    
+    def _cpu_load(self) -> float:
+        """Used share of the CPU budget, above 1.0 when the host is overloaded"""
+        if not self.admission.enabled or self.admission.budget <= 0:
+            return 0.0
+        return self.admission.used_capacity() / self.admission.budget
+    
+    def _on_bitrate_estimate(self, stream_id: str, bitrate: int):
+        """Forward a receiver bitrate estimate to the backend"""
+        stream_data = self.active_streams.get(stream_id)
+        if not stream_data:
+            return
+        producer_id = stream_data["stream_info"].get("producer_id") or stream_data["stream_info"].get("producerId")
+        asyncio.create_task(self._send_bitrate_feedback(stream_id, producer_id, bitrate))
+    
+    async def _send_bitrate_feedback(self, stream_id: str, producer_id: str, bitrate: int):
+        """
+        Ask the backend to cap what the phone sends for a producer
+        
+        Args:
+            stream_id: Stream identifier
+            producer_id: Mediasoup producer ID
+            bitrate: Bitrate estimate in bits per second
+        """
+        try:
+            response = await self.signaling.sio.call('ndi-bridge-bitrate-feedback', {
+                "stream_id": stream_id,
+                "producer_id": producer_id,
+                "bitrate": bitrate
+            })
+            if response and response.get('success'):
+                logger.info(f"📉 Stream {stream_id} bitrate capped at {bitrate / 1000:.0f} kbps")
+            else:
+                logger.warning(f"Bitrate feedback for {stream_id} rejected: {response.get('error') if response else 'no response'}")
+        except Exception as e:
+            logger.error(f"Error sending bitrate feedback for {stream_id}: {e}")
+    
+    async def monitor_tally(self):
+        """
+        Background task following NDI tally so sources on program get the
+        top simulcast/SVC layers
+        """
+        while True:
+            try:
+                await asyncio.sleep(0.5)
+                
+                for stream_id, stream_data in list(self.active_streams.items()):
+                    ndi_manager = stream_data.get("ndi_manager")
+                    if ndi_manager and self.suspend_idle_decoders and not stream_data.get("audio_only"):
+                        await self._update_decoding(stream_id, stream_data, ndi_manager)
+                    
+                    tally = ndi_manager.get_tally() if ndi_manager else None
+                    if tally is None:
+                        continue
+                    
+                    on_program = bool(tally.get("on_program"))
+                    if on_program != stream_data.get("on_program"):
+                        stream_data["on_program"] = on_program
+                        logger.info(f"🎬 Stream {stream_id} {'on' if on_program else 'off'} program")
+                        await self._update_preferred_layers(stream_id)
+                        
+            except asyncio.CancelledError:
+                break
+            except Exception as e:
+                logger.error(f"Error in tally monitor: {e}")
+    
+    async def _update_decoding(self, stream_id: str, stream_data: dict, ndi_manager: NDIManager):
+        """
+        Suspend decoding of streams no NDI receiver watches and resume it,
+        primed from the GOP cache, as soon as one connects
+        
+        Args:
+            stream_id: Stream identifier
+            stream_data: Active stream entry
+            ndi_manager: NDI output of the stream
+        """
+        connections = ndi_manager.get_connection_count()
+        if connections is None:
+            return
+        
+        suspended = stream_data.get("decoding_suspended", False)
+        if connections > 0:
+            stream_data["idle_since"] = None
+            if suspended and await self.webrtc_consumer.set_decoding(stream_id, True):
+                stream_data["decoding_suspended"] = False
+            return
+        
+        now = time.monotonic()
+        if stream_data.get("idle_since") is None:
+            stream_data["idle_since"] = now
+        elif not suspended and now - stream_data["idle_since"] >= self.idle_suspend_after:
+            if await self.webrtc_consumer.set_decoding(stream_id, False):
+                stream_data["decoding_suspended"] = True
+    
+    async def _update_preferred_layers(self, stream_id: str):
+        """
+        Request the cheapest consumer layers that still meet the NDI output
+        
+        Args:
+            stream_id: Stream identifier
+        """
+        stream_data = self.active_streams.get(stream_id)
+        if not stream_data:
+            return
+        
+        selector: Optional[LayerSelector] = stream_data.get("layer_selector")
+        consumer_id = stream_data.get("consumer_id")
+        if not selector or not selector.has_layers or not consumer_id:
+            return
+        
+        pipeline = stream_data["pipeline"]
+        ndi_manager = stream_data["ndi_manager"]
+        choice = selector.select(
+            pipeline.output_width or ndi_manager.width,
+            pipeline.output_height or ndi_manager.height,
+            pipeline.output_fps or ndi_manager.fps,
+            on_program=stream_data.get("on_program", False)
+        )
+        if choice == stream_data.get("layers"):
+            return
+        
+        try:
+            response = await self.signaling.sio.call('ndi-bridge-set-preferred-layers', {
+                "consumer_id": consumer_id,
+                "spatial_layer": choice.spatial_layer,
+                "temporal_layer": choice.temporal_layer
+            })
+            if response and response.get('success'):
+                stream_data["layers"] = choice
+                logger.info(
+                    f"📶 Stream {stream_id} layers S{choice.spatial_layer}T{choice.temporal_layer} "
+                    f"({choice.width}x{choice.height}@{choice.fps:g})"
+                )
+            else:
+                logger.warning(f"Failed to set layers for {stream_id}: {response.get('error') if response else 'no response'}")
+        except Exception as e:
+            logger.error(f"Error setting preferred layers for {stream_id}: {e}")
+    
     async def restart_stream(self, stream_id: str) -> bool:
         """
         Restart a failed stream
@@ -507,6 +1134,22 @@ class StreamManager:
         except Exception as e:
             logger.error(f"Error handling stream ended: {e}")
     
+    async def _handle_audio_added(self, data: dict):
+        """
+        Handle a phone adding audio to a running stream
+        
+        Args:
+            data: Event data
+        """
+        try:
+            stream_id = data.get("streamId")
+            if stream_id in self.active_streams:
+                rtp_capabilities = await self.signaling.request_rtp_capabilities()
+                await self._start_audio(stream_id, data.get("audioProducerId"), rtp_capabilities)
+                
+        except Exception as e:
+            logger.error(f"Error handling audio added: {e}")
+    
     async def _handle_stream_stats(self, data: dict):
         """
         Handle stream statistics update
@@ -519,3 +1162,77 @@ class StreamManager:
             pass
         except Exception as e:
             logger.error(f"Error handling stream stats: {e}")
+
+
+def create_stream_manager(settings, backend_url: Optional[str] = None, ndi_source_prefix: Optional[str] = None,
+                          admission: Optional[AdmissionController] = None) -> StreamManager:
+    """
+    Build a StreamManager configured by the settings, in the main process
+    or in a worker process alike
+
+    Args:
+        settings: Service settings
+        backend_url: Backend WebSocket URL (from the settings if None)
+        ndi_source_prefix: NDI source name prefix (from the settings if None)
+        admission: Admission controller (one from the settings if None)
+
+    Returns:
+        StreamManager: Configured, not yet initialized manager
+    """
+    manager = StreamManager(
+        backend_url=backend_url or settings.get_backend_ws_url(),
+        ndi_source_prefix=ndi_source_prefix or settings.ndi_source_prefix,
+        admission=admission or AdmissionController(
+            cpu_budget_percent=settings.cpu_budget_percent,
+            default_stream_cost=settings.default_stream_cost,
+            enabled=settings.admission_control
+        )
+    )
+    manager.max_streams = settings.max_streams
+
+    consumer = manager.webrtc_consumer
+    consumer.receiver_mode = settings.rtp_receiver
+    consumer.min_bitrate = settings.receiver_min_bitrate
+    consumer.max_bitrate = settings.receiver_max_bitrate
+    consumer.socket_backend = settings.rtp_socket_backend
+    consumer.busy_poll_core = settings.busy_poll_core if settings.busy_poll_core >= 0 else None
+    consumer.busy_poll_spin_us = settings.busy_poll_spin_us
+    consumer.xdp_interface = settings.xdp_interface
+    consumer.xdp_queue = settings.xdp_queue
+    consumer.xdp_port_range = (settings.xdp_port_min, settings.xdp_port_max)
+    consumer.xdp_native_mode = settings.xdp_native_mode
+    consumer.decode_threads = settings.decode_threads
+
+    manager.suspend_idle_decoders = settings.suspend_idle_decoders
+    manager.conversion_bands = settings.conversion_bands
+    manager.frame_workers = settings.frame_workers or None
+    manager.drop_late_frames = settings.drop_late_frames
+    manager.ndi_async_send = settings.ndi_async_send
+    manager.audio_enabled = settings.audio_enabled
+    manager.audio_block_samples = settings.audio_block_samples
+    manager.audio_only_block_samples = settings.audio_only_block_samples
+    manager.audio_buffer_ms = settings.audio_buffer_ms
+    manager.default_width = settings.default_width
+    manager.default_height = settings.default_height
+    manager.default_fps = settings.default_fps
+
+    # With worker processes, auto-matching only sees the streams of its own worker
+    manager.lut_dir = settings.color_lut_dir
+    if settings.processing_quality == "low":
+        manager.denoise_threshold = settings.denoise_threshold
+    if settings.color_match_reference:
+        manager.color_matcher = ColorMatcher(settings.color_match_reference, strength=settings.color_match_strength)
+    if settings.chroma_key_devices:
+        manager.chroma_keyer = create_chroma_keyer(settings)
+        manager.chroma_key_devices = settings.get_chroma_key_devices()
+        manager.key_output_format = settings.chroma_key_output
+    manager.overlay_dir = settings.overlay_dir
+    manager.overlay_position = settings.overlay_position
+    manager.overlay_scale = settings.overlay_scale
+    manager.overlay_name_strap = settings.overlay_name_strap
+
+    # Ticks are epoch-aligned, so every worker's clock shares one phase
+    if settings.house_clock:
+        manager.house_clock = HouseClock(settings.house_clock_fps, settings.house_clock_phase_ms)
+        manager.frame_rate_conversion = settings.frame_rate_conversion
+    return manager
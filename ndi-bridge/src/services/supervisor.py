@@ -0,0 +1,574 @@
+"""
+Stream Supervisor - Shards streams across pinned bridge worker processes
+"""
+
+import asyncio
+import logging
+import multiprocessing
+import os
+import time
+from dataclasses import dataclass, field
+from typing import Dict, List, Optional, Set, Tuple
+
+from webrtc.signaling import WebRTCSignaling
+
+logger = logging.getLogger(__name__)
+
+# Workers report their load this often (seconds)
+WORKER_STATS_INTERVAL = 5.0
+# How long a migration waits for the old worker to release the NDI name (seconds)
+MIGRATE_STOP_TIMEOUT = 5.0
+# Retry delay after a worker rejects a stream, doubling per rejection (seconds)
+REJECT_BACKOFF_MIN = 10.0
+REJECT_BACKOFF_MAX = 300.0
+
+
+def split_core_groups(worker_count: int, cores: Optional[List[int]] = None) -> List[List[int]]:
+    """
+    Split the available cores into contiguous groups, one per worker
+
+    Args:
+        worker_count: Number of worker processes
+        cores: Cores to split (defaults to this process' affinity)
+
+    Returns:
+        list: Core list for each worker
+    """
+    if cores is None:
+        cores = sorted(os.sched_getaffinity(0))
+    worker_count = max(1, min(worker_count, len(cores)))
+
+    groups = []
+    per_worker, extra = divmod(len(cores), worker_count)
+    start = 0
+    for index in range(worker_count):
+        size = per_worker + (1 if index < extra else 0)
+        groups.append(cores[start:start + size])
+        start += size
+    return groups
+
+
+def _worker_main(worker_id: int, cores: List[int], conn, backend_url: str,
+                 ndi_source_prefix: str, admission_kwargs: dict):
+    """
+    Worker process entry point
+
+    Runs its own StreamManager that only starts the streams the supervisor
+    assigns to it, and reports its measured load back over the pipe.
+    """
+    try:
+        os.sched_setaffinity(0, cores)
+    except (AttributeError, OSError) as e:
+        logger.warning(f"Worker {worker_id}: could not pin to cores {cores}: {e}")
+
+    asyncio.run(_worker_loop(worker_id, conn, backend_url, ndi_source_prefix, admission_kwargs))
+
+
+async def _worker_loop(worker_id: int, conn, backend_url: str,
+                       ndi_source_prefix: str, admission_kwargs: dict):
+    from config.settings import get_settings
+    from services.admission import AdmissionController
+    from services.stream_manager import create_stream_manager
+
+    # Same setup as the single-process manager, only placement differs
+    manager = create_stream_manager(
+        get_settings(),
+        backend_url=backend_url,
+        ndi_source_prefix=ndi_source_prefix,
+        admission=AdmissionController(**admission_kwargs)
+    )
+    # The supervisor owns placement, workers never pick streams themselves
+    manager.auto_consume = False
+
+    if not await manager.initialize():
+        logger.error(f"Worker {worker_id}: failed to initialize stream manager")
+        conn.send({"event": "failed"})
+        return
+
+    loop = asyncio.get_running_loop()
+    commands: asyncio.Queue = asyncio.Queue()
+
+    def _on_readable():
+        try:
+            while conn.poll():
+                commands.put_nowait(conn.recv())
+        except (EOFError, OSError):
+            commands.put_nowait({"cmd": "shutdown"})
+
+    loop.add_reader(conn.fileno(), _on_readable)
+    conn.send({"event": "ready"})
+    logger.info(f"Worker {worker_id} ready (pid {os.getpid()})")
+
+    last_stats = 0.0
+    try:
+        while True:
+            try:
+                command = await asyncio.wait_for(commands.get(), timeout=1.0)
+            except asyncio.TimeoutError:
+                command = None
+
+            if command:
+                cmd = command.get("cmd")
+                if cmd == "start":
+                    stream_info = command["stream_info"]
+                    started = await manager.start_stream(stream_info)
+                    conn.send({"event": "started" if started else "rejected", "stream_id": stream_info.get("id")})
+                elif cmd == "stop":
+                    await manager.stop_stream(command["stream_id"])
+                    conn.send({"event": "stopped", "stream_id": command["stream_id"]})
+                elif cmd == "shutdown":
+                    break
+
+            if time.monotonic() - last_stats >= WORKER_STATS_INTERVAL:
+                last_stats = time.monotonic()
+                manager._update_stream_costs()
+                admission = manager.admission.get_stats()
+                conn.send({
+                    "event": "stats",
+                    "load": admission["used"],
+                    "budget": admission["budget"],
+                    "streams": {
+                        stream_id: info["cost"] for stream_id, info in admission["streams"].items()
+                    }
+                })
+    finally:
+        loop.remove_reader(conn.fileno())
+        await manager.shutdown()
+        logger.info(f"Worker {worker_id} stopped")
+
+
+@dataclass
+class WorkerHandle:
+    """
+    Supervisor-side state of one worker process
+    """
+    worker_id: int
+    cores: List[int]
+    process: Optional[multiprocessing.Process] = None
+    conn: Optional[object] = None
+    ready: bool = False
+    load: float = 0.0
+    budget: float = 0.0
+    streams: Dict[str, dict] = field(default_factory=dict)
+    stream_costs: Dict[str, float] = field(default_factory=dict)
+    # Streams in the last stats report, measured or not; `load` already covers them
+    reported: Set[str] = field(default_factory=set)
+    restarts: int = 0
+    started_at: float = 0.0
+
+    def is_alive(self) -> bool:
+        return self.process is not None and self.process.is_alive()
+
+    def effective_load(self) -> float:
+        """Reported load plus an estimate for streams placed since the last report"""
+        unreported = [s for s in self.streams if s not in self.reported]
+        average = (sum(self.stream_costs.values()) / len(self.stream_costs)) if self.stream_costs else 0.25
+        return self.load + average * len(unreported)
+
+
+class StreamSupervisor:
+    """
+    Runs several bridge worker processes, each pinned to a core group.
+    Places streams on the least loaded worker, migrates streams to even out
+    load, and restarts crashed workers re-adopting their streams. A crash in
+    one worker's decoder only affects the streams on that worker.
+    """
+
+    def __init__(
+        self,
+        backend_url: str,
+        ndi_source_prefix: str = "MobileCam",
+        worker_count: int = 2,
+        admission_kwargs: Optional[dict] = None,
+        rebalance_threshold: float = 0.5,
+        health_interval: float = 5.0
+    ):
+        """
+        Initialize stream supervisor
+
+        Args:
+            backend_url: Backend WebSocket URL
+            ndi_source_prefix: Prefix for NDI source names
+            worker_count: Number of worker processes
+            admission_kwargs: AdmissionController arguments for each worker
+            rebalance_threshold: Load difference (cores) that triggers a migration
+            health_interval: Seconds between worker health checks
+        """
+        self.backend_url = backend_url
+        self.ndi_source_prefix = ndi_source_prefix
+        self.admission_kwargs = admission_kwargs or {}
+        self.rebalance_threshold = rebalance_threshold
+        self.health_interval = health_interval
+
+        self.signaling = WebRTCSignaling(backend_url)
+        self.context = multiprocessing.get_context("spawn")
+        self.workers: Dict[int, WorkerHandle] = {
+            worker_id: WorkerHandle(worker_id=worker_id, cores=cores)
+            for worker_id, cores in enumerate(split_core_groups(worker_count))
+        }
+        self.placement: Dict[str, int] = {}
+        # stream_id -> future resolved by the worker's "stopped" event
+        self._pending_stops: Dict[str, asyncio.Future] = {}
+        # stream_id -> (rejections, monotonic time before which it is not re-placed)
+        self._rejected: Dict[str, Tuple[int, float]] = {}
+        self.monitor_task: Optional[asyncio.Task] = None
+
+        # Statistics
+        self.stats = {
+            "worker_restarts": 0,
+            "migrations": 0,
+            "start_time": time.time()
+        }
+
+        logger.info(
+            f"Stream Supervisor initialized with {len(self.workers)} workers: "
+            f"{[w.cores for w in self.workers.values()]}"
+        )
+
+    async def initialize(self) -> bool:
+        """
+        Start worker processes and connect to the backend
+
+        Returns:
+            bool: True if initialization successful
+        """
+        try:
+            for worker in self.workers.values():
+                self._spawn_worker(worker)
+
+            if not await self.signaling.connect():
+                logger.error("Supervisor failed to connect to backend signaling")
+                return False
+
+            self.signaling.register_message_handler("stream-started", self._handle_new_producer)
+            self.signaling.register_message_handler("stream-ended", self._handle_producer_closed)
+
+            self.monitor_task = asyncio.create_task(self.monitor_workers())
+
+            logger.info("Stream Supervisor initialized successfully")
+            return True
+
+        except Exception as e:
+            logger.error(f"Failed to initialize Stream Supervisor: {e}")
+            return False
+
+    async def shutdown(self):
+        """
+        Stop all workers
+        """
+        if self.monitor_task:
+            self.monitor_task.cancel()
+
+        loop = asyncio.get_running_loop()
+        for worker in self.workers.values():
+            if worker.conn:
+                loop.remove_reader(worker.conn.fileno())
+                try:
+                    worker.conn.send({"cmd": "shutdown"})
+                except (BrokenPipeError, OSError):
+                    pass
+            if worker.process:
+                await loop.run_in_executor(None, worker.process.join, 10)
+                if worker.process.is_alive():
+                    worker.process.terminate()
+
+        await self.signaling.disconnect()
+        logger.info("Stream Supervisor shutdown complete")
+
+    async def start_stream(self, stream_info: dict) -> bool:
+        """
+        Place a stream on the least loaded worker
+
+        Args:
+            stream_info: Stream information from backend
+
+        Returns:
+            bool: True if the stream was assigned to a worker
+        """
+        stream_id = stream_info.get("id")
+        if not stream_id:
+            return False
+        if stream_id in self.placement:
+            return True
+        if stream_id in self._rejected and time.monotonic() < self._rejected[stream_id][1]:
+            return False
+
+        worker = self._least_loaded_worker()
+        if not worker:
+            logger.error(f"No live worker available for stream {stream_id}")
+            return False
+
+        self._assign(worker, stream_info)
+        return True
+
+    async def stop_stream(self, stream_id: str) -> bool:
+        """
+        Stop a stream on whichever worker runs it
+
+        Args:
+            stream_id: Stream identifier
+
+        Returns:
+            bool: True if the stream was found
+        """
+        self._rejected.pop(stream_id, None)
+        worker_id = self.placement.pop(stream_id, None)
+        if worker_id is None:
+            return False
+
+        worker = self.workers[worker_id]
+        worker.streams.pop(stream_id, None)
+        worker.stream_costs.pop(stream_id, None)
+        self._send(worker, {"cmd": "stop", "stream_id": stream_id})
+        return True
+
+    async def migrate_stream(self, stream_id: str, target_id: int) -> bool:
+        """
+        Move a stream to another worker
+
+        The NDI source keeps its name, so receivers hold the last frame for
+        the short gap between the old sender closing and the new one
+        starting instead of losing the source.
+
+        Args:
+            stream_id: Stream identifier
+            target_id: Destination worker
+
+        Returns:
+            bool: True if migration was issued
+        """
+        source_id = self.placement.get(stream_id)
+        target = self.workers.get(target_id)
+        if source_id is None or source_id == target_id or not target or not target.ready:
+            return False
+        if stream_id in self._pending_stops:
+            return False
+
+        source = self.workers[source_id]
+        stream_info = source.streams.pop(stream_id)
+        cost = source.stream_costs.pop(stream_id, None)
+
+        # Stop first and wait for it: two senders with the same NDI name would fight
+        if source.ready and source.is_alive():
+            stopped = asyncio.get_running_loop().create_future()
+            self._pending_stops[stream_id] = stopped
+            self._send(source, {"cmd": "stop", "stream_id": stream_id})
+            try:
+                await asyncio.wait_for(stopped, MIGRATE_STOP_TIMEOUT)
+            except asyncio.TimeoutError:
+                logger.warning(
+                    f"Worker {source_id} did not confirm stopping stream {stream_id} "
+                    f"within {MIGRATE_STOP_TIMEOUT:.0f}s, migrating anyway"
+                )
+            finally:
+                self._pending_stops.pop(stream_id, None)
+
+        if self.placement.get(stream_id) != source_id:
+            # Stopped or re-placed while we waited
+            return False
+
+        self._assign(target, stream_info)
+        if cost is not None:
+            source.load = max(0.0, source.load - cost)
+            target.load += cost
+
+        self.stats["migrations"] += 1
+        logger.info(f"🔀 Migrated stream {stream_id}: worker {source_id} -> worker {target_id}")
+        return True
+
+    async def monitor_workers(self):
+        """
+        Background task restarting crashed workers, syncing streams and
+        rebalancing load
+        """
+        while True:
+            try:
+                await asyncio.sleep(self.health_interval)
+
+                for worker in self.workers.values():
+                    if worker.process and not worker.is_alive():
+                        self._restart_worker(worker)
+
+                await self._sync_streams()
+                await self._rebalance()
+
+            except asyncio.CancelledError:
+                break
+            except Exception as e:
+                logger.error(f"Error in worker monitor: {e}")
+
+    def get_stats(self) -> dict:
+        """
+        Get supervisor statistics
+
+        Returns:
+            dict: Worker and placement statistics
+        """
+        return {
+            **self.stats,
+            "uptime": time.time() - self.stats["start_time"],
+            "total_active_streams": len(self.placement),
+            "rejected_streams": len(self._rejected),
+            "workers": {
+                worker_id: {
+                    "pid": worker.process.pid if worker.process else None,
+                    "alive": worker.is_alive(),
+                    "ready": worker.ready,
+                    "cores": worker.cores,
+                    "load": worker.load,
+                    "budget": worker.budget,
+                    "restarts": worker.restarts,
+                    "streams": list(worker.streams.keys())
+                }
+                for worker_id, worker in self.workers.items()
+            }
+        }
+
+    def _spawn_worker(self, worker: WorkerHandle):
+        parent_conn, child_conn = self.context.Pipe()
+        worker.process = self.context.Process(
+            target=_worker_main,
+            args=(worker.worker_id, worker.cores, child_conn, self.backend_url,
+                  self.ndi_source_prefix, self.admission_kwargs),
+            name=f"ndi-bridge-worker-{worker.worker_id}",
+            daemon=True
+        )
+        worker.process.start()
+        child_conn.close()
+
+        worker.conn = parent_conn
+        worker.ready = False
+        worker.load = 0.0
+        worker.stream_costs = {}
+        worker.reported = set()
+        worker.started_at = time.time()
+
+        asyncio.get_running_loop().add_reader(parent_conn.fileno(), self._on_worker_message, worker)
+        logger.info(f"Spawned worker {worker.worker_id} (pid {worker.process.pid}) on cores {worker.cores}")
+
+    def _restart_worker(self, worker: WorkerHandle):
+        """Replace a dead worker and re-adopt its streams"""
+        logger.error(
+            f"💥 Worker {worker.worker_id} died (exit code {worker.process.exitcode}), "
+            f"restarting with {len(worker.streams)} stream(s)"
+        )
+        if worker.conn:
+            asyncio.get_running_loop().remove_reader(worker.conn.fileno())
+            worker.conn.close()
+
+        worker.restarts += 1
+        self.stats["worker_restarts"] += 1
+        self._spawn_worker(worker)
+        # Streams stay in worker.streams and are re-sent once the worker is ready
+
+    def _on_worker_message(self, worker: WorkerHandle):
+        try:
+            while worker.conn.poll():
+                message = worker.conn.recv()
+                event = message.get("event")
+                if event == "ready":
+                    worker.ready = True
+                    for stream_info in worker.streams.values():
+                        self._send(worker, {"cmd": "start", "stream_info": stream_info})
+                elif event == "stats":
+                    worker.load = message.get("load", 0.0)
+                    worker.budget = message.get("budget", 0.0)
+                    worker.stream_costs = {
+                        stream_id: cost for stream_id, cost in message.get("streams", {}).items()
+                        if cost is not None
+                    }
+                    worker.reported = set(message.get("streams", {}))
+                elif event == "started":
+                    self._rejected.pop(message.get("stream_id"), None)
+                elif event == "stopped":
+                    stopped = self._pending_stops.get(message.get("stream_id"))
+                    if stopped and not stopped.done():
+                        stopped.set_result(True)
+                elif event == "rejected":
+                    stream_id = message.get("stream_id")
+                    worker.streams.pop(stream_id, None)
+                    self.placement.pop(stream_id, None)
+                    # Back off so the sync loop does not re-place it every cycle
+                    rejections = self._rejected.get(stream_id, (0, 0.0))[0] + 1
+                    delay = min(REJECT_BACKOFF_MIN * 2 ** (rejections - 1), REJECT_BACKOFF_MAX)
+                    self._rejected[stream_id] = (rejections, time.monotonic() + delay)
+                    logger.warning(
+                        f"Worker {worker.worker_id} rejected stream {stream_id}, "
+                        f"retrying in {delay:.0f}s"
+                    )
+                elif event == "failed":
+                    worker.ready = False
+        except (EOFError, OSError):
+            # Worker exited, the monitor restarts it
+            asyncio.get_running_loop().remove_reader(worker.conn.fileno())
+            worker.ready = False
+
+    def _assign(self, worker: WorkerHandle, stream_info: dict):
+        stream_id = stream_info["id"]
+        worker.streams[stream_id] = stream_info
+        self.placement[stream_id] = worker.worker_id
+        if worker.ready:
+            self._send(worker, {"cmd": "start", "stream_info": stream_info})
+        logger.info(f"📌 Stream {stream_id} placed on worker {worker.worker_id}")
+
+    def _send(self, worker: WorkerHandle, command: dict):
+        try:
+            if worker.conn and worker.ready:
+                worker.conn.send(command)
+        except (BrokenPipeError, OSError) as e:
+            logger.warning(f"Failed to send to worker {worker.worker_id}: {e}")
+
+    def _least_loaded_worker(self) -> Optional[WorkerHandle]:
+        live = [w for w in self.workers.values() if w.is_alive()]
+        if not live:
+            return None
+        return min(live, key=lambda w: (w.effective_load() / max(len(w.cores), 1), len(w.streams)))
+
+    async def _rebalance(self):
+        """Migrate one stream from the busiest to the idlest worker if worthwhile"""
+        ready = [w for w in self.workers.values() if w.ready and w.is_alive()]
+        if len(ready) < 2:
+            return
+
+        busiest = max(ready, key=lambda w: w.effective_load())
+        idlest = min(ready, key=lambda w: w.effective_load())
+        gap = busiest.effective_load() - idlest.effective_load()
+        if gap < self.rebalance_threshold or not busiest.stream_costs:
+            return
+
+        # Move the stream that best halves the gap
+        stream_id = min(
+            busiest.stream_costs,
+            key=lambda s: abs(gap / 2 - busiest.stream_costs[s])
+        )
+        if busiest.stream_costs[stream_id] < gap:
+            await self.migrate_stream(stream_id, idlest.worker_id)
+
+    async def _sync_streams(self):
+        """Start streams the backend knows about and stop vanished ones"""
+        if not self.signaling.is_connected:
+            return
+        producers = await self.signaling.get_active_producers()
+        if producers is None:
+            return
+
+        known = {p.get("id") for p in producers}
+        for stream_id in list(self._rejected):
+            if stream_id not in known:
+                del self._rejected[stream_id]
+        for producer in producers:
+            if producer.get("id") not in self.placement:
+                await self.start_stream(producer)
+        for stream_id in list(self.placement):
+            if stream_id not in known:
+                await self.stop_stream(stream_id)
+
+    async def _handle_new_producer(self, data: dict):
+        stream_info = data.get("stream", {})
+        if stream_info:
+            await self.start_stream(stream_info)
+
+    async def _handle_producer_closed(self, data: dict):
+        stream_id = data.get("streamId")
+        if stream_id:
+            await self.stop_stream(stream_id)
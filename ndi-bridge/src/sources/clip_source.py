@@ -0,0 +1,392 @@
+"""
+Clip Source - Loops video files into NDI senders for stings and test clips
+
+Uncompressed files (Y4M 4:2:0, raw UYVY, raw BGRA) are memory-mapped and
+their pages are handed to the NDI SDK as frame data without a copy;
+compressed files are decoded with OpenCV.
+"""
+
+import asyncio
+import logging
+import mmap
+import os
+import re
+import time
+from typing import List, Optional, Tuple
+
+import cv2
+import numpy as np
+
+from ndi.sender import NDISender
+
+logger = logging.getLogger(__name__)
+
+RAW_EXTENSIONS = {".uyvy": "UYVY", ".bgra": "BGRA"}
+CLIP_EXTENSIONS = {".y4m", ".uyvy", ".bgra", ".mp4", ".mov", ".mkv", ".avi", ".ts"}
+# "<name>_1920x1080@25.uyvy" or "<name>.1920x1080p50.bgra"
+RAW_GEOMETRY = re.compile(r"(\d+)x(\d+)(?:[@p](\d+(?:\.\d+)?))?")
+
+
+class MappedClip:
+    """
+    Uncompressed clip read through a read-only memory map.
+
+    frame() returns a numpy view of the mapped pages, which NDI reads
+    directly. The kernel is told the access is sequential, and the frames
+    ahead of the play head are prefetched with MADV_WILLNEED so the send
+    path does not stall on page faults.
+    """
+
+    zero_copy = True
+
+    def __init__(self, path: str, width: int, height: int, fps: float, pixel_format: str,
+                 data_start: int = 0, frame_header: int = 0, readahead: int = 2):
+        """
+        Initialize mapped clip
+
+        Args:
+            path: Clip file
+            width: Frame width
+            height: Frame height
+            fps: Native frame rate
+            pixel_format: NDI FourCC of the stored frames (UYVY, BGRA, I420)
+            data_start: Byte offset of the first frame (after any file header)
+            frame_header: Bytes before each frame's data (Y4M "FRAME\\n")
+            readahead: Frames prefetched ahead of the play head
+        """
+        self.path = path
+        self.width = width
+        self.height = height
+        self.fps = fps
+        self.pixel_format = pixel_format
+        self.frame_size = {
+            "UYVY": width * height * 2,
+            "BGRA": width * height * 4,
+            "I420": width * height * 3 // 2
+        }[pixel_format]
+        self.frame_header = frame_header
+        self.data_start = data_start
+        self.readahead = readahead
+
+        self._file = open(path, "rb")
+        self._map = mmap.mmap(self._file.fileno(), 0, access=mmap.ACCESS_READ)
+        self.frame_count = (len(self._map) - data_start) // (frame_header + self.frame_size)
+        if self.frame_count <= 0:
+            self.close()
+            raise ValueError(f"{path} holds no complete {width}x{height} {pixel_format} frame")
+        if hasattr(self._map, "madvise"):
+            self._map.madvise(mmap.MADV_SEQUENTIAL)
+
+    def frame(self, index: int) -> np.ndarray:
+        """
+        Frame data of a frame, a view of the mapped file
+
+        Args:
+            index: Frame index (wraps around)
+
+        Returns:
+            np.ndarray: Flat uint8 frame in the clip's pixel format
+        """
+        index %= self.frame_count
+        offset = self._offset(index)
+        self._prefetch(index + 1)
+        return np.frombuffer(self._map, dtype=np.uint8, count=self.frame_size, offset=offset)
+
+    def _offset(self, index: int) -> int:
+        return self.data_start + index * (self.frame_header + self.frame_size) + self.frame_header
+
+    def _prefetch(self, index: int):
+        """Ask the kernel to read the next frames in before they are due"""
+        if not hasattr(self._map, "madvise") or not self.readahead:
+            return
+        try:
+            for ahead in range(index, index + self.readahead):
+                start = self._offset(ahead % self.frame_count)
+                aligned = start - start % mmap.PAGESIZE
+                self._map.madvise(mmap.MADV_WILLNEED, aligned, start - aligned + self.frame_size)
+        except (OSError, ValueError) as e:
+            logger.debug(f"madvise failed for {self.path}: {e}")
+
+    def close(self):
+        """Unmap the file; NDI must no longer hold a frame of it"""
+        try:
+            self._map.close()
+        except BufferError:
+            logger.warning(f"Clip {self.path} still has frames in use, leaving it mapped")
+        self._file.close()
+
+
+class DecodedClip:
+    """Compressed clip decoded frame by frame to BGRA with OpenCV"""
+
+    zero_copy = False
+    pixel_format = "BGRA"
+
+    def __init__(self, path: str):
+        """
+        Initialize decoded clip
+
+        Args:
+            path: Clip file (anything OpenCV's FFmpeg backend reads)
+        """
+        self.path = path
+        self._capture = cv2.VideoCapture(path)
+        if not self._capture.isOpened():
+            raise ValueError(f"Cannot open clip {path}")
+        self.width = int(self._capture.get(cv2.CAP_PROP_FRAME_WIDTH))
+        self.height = int(self._capture.get(cv2.CAP_PROP_FRAME_HEIGHT))
+        self.fps = self._capture.get(cv2.CAP_PROP_FPS) or 30.0
+        self.frame_count = max(1, int(self._capture.get(cv2.CAP_PROP_FRAME_COUNT)))
+        self._next = 0
+
+    def frame(self, index: int) -> np.ndarray:
+        """
+        Decode a frame (sequential reads are cheapest, other indices seek)
+
+        Args:
+            index: Frame index (wraps around)
+
+        Returns:
+            np.ndarray: BGRA frame
+        """
+        index %= self.frame_count
+        if index != self._next:
+            self._capture.set(cv2.CAP_PROP_POS_FRAMES, index)
+        ok, frame = self._capture.read()
+        if not ok:
+            # Container frame counts are estimates; wrap at the real end
+            self._capture.set(cv2.CAP_PROP_POS_FRAMES, 0)
+            index = 0
+            ok, frame = self._capture.read()
+            if not ok:
+                raise ValueError(f"Cannot decode clip {self.path}")
+        self._next = index + 1
+        return cv2.cvtColor(frame, cv2.COLOR_BGR2BGRA)
+
+    def close(self):
+        """Release the decoder"""
+        self._capture.release()
+
+
+def _open_y4m(path: str, readahead: int) -> MappedClip:
+    """Parse a YUV4MPEG2 header and map its 4:2:0 frames"""
+    with open(path, "rb") as f:
+        header = f.readline()
+        frame_header = f.readline() if header.startswith(b"YUV4MPEG2") else b""
+    if not frame_header.startswith(b"FRAME"):
+        raise ValueError(f"{path} is not a YUV4MPEG2 file")
+
+    width = height = 0
+    fps = 30.0
+    chroma = "420"
+    for token in header.decode("ascii", "replace").split()[1:]:
+        key, value = token[0], token[1:]
+        if key == "W":
+            width = int(value)
+        elif key == "H":
+            height = int(value)
+        elif key == "F":
+            numerator, denominator = value.split(":")
+            fps = int(numerator) / int(denominator)
+        elif key == "C":
+            chroma = value
+    if not chroma.startswith("420") or chroma == "420p10":
+        raise ValueError(f"{path}: only 8-bit 4:2:0 Y4M can be played without conversion (got C{chroma})")
+    return MappedClip(path, width, height, fps, "I420", data_start=len(header),
+                      frame_header=len(frame_header), readahead=readahead)
+
+
+def open_clip(path: str, default_fps: float = 30.0, readahead: int = 2):
+    """
+    Open a clip file
+
+    Args:
+        path: .y4m, .uyvy/.bgra (geometry in the name, e.g. sting_1920x1080@25.uyvy)
+            or a compressed file
+        default_fps: Frame rate of raw files that do not name one
+        readahead: Frames prefetched ahead of playback for mapped files
+
+    Returns:
+        MappedClip or DecodedClip
+    """
+    extension = os.path.splitext(path)[1].lower()
+    if extension == ".y4m":
+        return _open_y4m(path, readahead)
+    if extension in RAW_EXTENSIONS:
+        match = RAW_GEOMETRY.search(os.path.basename(path))
+        if not match:
+            raise ValueError(f"{path}: raw clips need WIDTHxHEIGHT in the file name")
+        fps = float(match.group(3)) if match.group(3) else default_fps
+        return MappedClip(path, int(match.group(1)), int(match.group(2)), fps,
+                          RAW_EXTENSIONS[extension], readahead=readahead)
+    return DecodedClip(path)
+
+
+def find_clips(spec: str) -> List[str]:
+    """
+    Expand CLIP_SOURCES: comma-separated files and directories of clips
+
+    Args:
+        spec: Setting value
+
+    Returns:
+        list: Clip file paths
+    """
+    paths = []
+    for entry in (part.strip() for part in spec.split(",")):
+        if not entry:
+            continue
+        if os.path.isdir(entry):
+            paths.extend(
+                os.path.join(entry, name) for name in sorted(os.listdir(entry))
+                if os.path.splitext(name)[1].lower() in CLIP_EXTENSIONS
+            )
+        else:
+            paths.append(entry)
+    return paths
+
+
+class ClipSource:
+    """
+    Loops one clip into its own NDI source.
+
+    With a house clock, a frame goes out on every tick, stepping through
+    the clip at its native rate (frames are repeated or skipped when the
+    rates differ); otherwise the source paces itself at the clip rate.
+    """
+
+    def __init__(self, path: str, source_name: str, house_clock=None, async_send: bool = True,
+                 default_fps: float = 30.0):
+        """
+        Initialize clip source
+
+        Args:
+            path: Clip file
+            source_name: NDI source name
+            house_clock: HouseClock to send on, None to self-pace
+            async_send: Send through the SDK's async path
+            default_fps: Frame rate of raw files that do not name one
+        """
+        self.path = path
+        self.source_name = source_name
+        self.house_clock = house_clock
+        self.async_send = async_send
+        self.default_fps = default_fps
+
+        self.clip = None
+        self.sender: Optional[NDISender] = None
+        self.position = 0.0
+        self.clock_subscription: Optional[int] = None
+        self.task: Optional[asyncio.Task] = None
+        self.stats = {"frames_sent": 0, "loops": 0, "late_frames": 0}
+
+    async def start(self) -> bool:
+        """
+        Open the clip and start playing
+
+        Returns:
+            bool: True if playback started
+        """
+        try:
+            self.clip = open_clip(self.path, self.default_fps)
+            fps = self.house_clock.fps if self.house_clock else self.clip.fps
+            self.sender = NDISender(
+                self.source_name, self.clip.width, self.clip.height, fps,
+                clock_video=False, async_send=self.async_send, pixel_format=self.clip.pixel_format
+            )
+            if not await self.sender.initialize():
+                logger.error(f"Failed to create NDI sender for clip {self.path}")
+                self.clip.close()
+                return False
+
+            if self.house_clock:
+                self.clock_subscription = self.house_clock.subscribe(self._on_tick)
+            else:
+                self.task = asyncio.create_task(self._run())
+            logger.info(
+                f"🎞️ Playing {os.path.basename(self.path)} as '{self.source_name}' "
+                f"({self.clip.width}x{self.clip.height} {self.clip.pixel_format} @ {self.clip.fps:g} fps, "
+                f"{'zero-copy' if self.clip.zero_copy else 'decoded'})"
+            )
+            return True
+
+        except Exception as e:
+            logger.error(f"Failed to start clip source {self.path}: {e}")
+            return False
+
+    async def stop(self):
+        """Stop playback and release the sender before the clip's pages"""
+        if self.clock_subscription is not None:
+            self.house_clock.unsubscribe(self.clock_subscription)
+            self.clock_subscription = None
+        if self.task:
+            self.task.cancel()
+            try:
+                await self.task
+            except asyncio.CancelledError:
+                pass
+            self.task = None
+        if self.sender:
+            self.sender.close()
+            self.sender = None
+        if self.clip:
+            self.clip.close()
+            self.clip = None
+
+    async def _on_tick(self, index: int, tick_time: float):
+        """Send the clip frame due on a house clock tick"""
+        await self._send_next(tick_time, self.clip.fps / self.house_clock.fps)
+
+    async def _run(self):
+        """Self-paced playback at the clip rate"""
+        interval = 1.0 / self.clip.fps
+        next_time = time.time()
+        while True:
+            await self._send_next(None, 1.0)
+            next_time += interval
+            delay = next_time - time.time()
+            if delay < -interval:
+                # Fell behind (e.g. a slow decode): resync rather than burst
+                self.stats["late_frames"] += 1
+                next_time = time.time()
+            await asyncio.sleep(max(0.0, delay))
+
+    async def _send_next(self, timecode: Optional[float], step: float):
+        index = int(self.position)
+        if index >= self.clip.frame_count:
+            self.position -= self.clip.frame_count
+            index = int(self.position)
+            self.stats["loops"] += 1
+        self.position += step
+
+        if self.clip.zero_copy:
+            frame = self.clip.frame(index)
+        else:
+            frame = await asyncio.get_running_loop().run_in_executor(None, self.clip.frame, index)
+        if await self.sender.send_buffer(frame, timecode=timecode):
+            self.stats["frames_sent"] += 1
+
+    def get_stats(self) -> dict:
+        """
+        Get playback statistics
+
+        Returns:
+            dict: Clip, format and counters
+        """
+        stats = {"path": self.path, "source_name": self.source_name, **self.stats}
+        if self.clip:
+            stats.update({
+                "resolution": f"{self.clip.width}x{self.clip.height}",
+                "fps": self.clip.fps,
+                "pixel_format": self.clip.pixel_format,
+                "frame_count": self.clip.frame_count,
+                "zero_copy": self.clip.zero_copy
+            })
+        return stats
+
+
+def clip_source_name(prefix: str, path: str) -> str:
+    """NDI source name of a clip: <prefix>_Clip_<file name without geometry/extension>"""
+    stem = os.path.splitext(os.path.basename(path))[0]
+    stem = RAW_GEOMETRY.sub("", stem).strip("_.- ") or stem
+    return f"{prefix}_Clip_{stem}"
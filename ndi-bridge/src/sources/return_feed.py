@@ -0,0 +1,375 @@
+"""
+Return Feed - Receives the program NDI source and publishes it to mediasoup
+as a small real-time VP8/H.264 producer the phones show as a confidence monitor
+"""
+
+import asyncio
+import logging
+import random
+import socket
+import threading
+import time
+from fractions import Fraction
+from typing import Dict, Optional
+
+import cv2
+import numpy as np
+
+from webrtc.rtp_packet import is_keyframe_request, is_rtcp
+from webrtc.signaling import WebRTCSignaling
+
+try:
+    import NDIlib as ndi
+    NDI_AVAILABLE = True
+except ImportError:
+    ndi = None
+    NDI_AVAILABLE = False
+
+try:
+    import gi
+    gi.require_version('Gst', '1.0')
+    from gi.repository import Gst
+    Gst.init(None)
+    GST_AVAILABLE = True
+except (ImportError, ValueError):
+    Gst = None
+    GST_AVAILABLE = False
+
+logger = logging.getLogger(__name__)
+
+RETURN_FEED_PAYLOAD_TYPE = 96
+RTP_MTU = 1200
+# Phones ask again while a keyframe is in flight; honour one request per interval
+KEYFRAME_REQUEST_INTERVAL = 0.5
+SOURCE_SEARCH_MS = 1000
+
+# Encoder and payloader per codec: no lookahead, no B-frames, a keyframe every 2 s
+ENCODERS = {
+    "VP8": (
+        "vp8enc deadline=1 cpu-used=8 lag-in-frames=0 error-resilient=partitions "
+        "end-usage=cbr target-bitrate={bitrate} keyframe-max-dist={gop} threads=2",
+        "rtpvp8pay picture-id-mode=15-bit"
+    ),
+    "H264": (
+        # Main profile matches the router's profile-level-id 4d0032
+        "x264enc tune=zerolatency speed-preset=ultrafast bitrate={kbps} key-int-max={gop} threads=2 "
+        "! video/x-h264,profile=main",
+        "rtph264pay config-interval=-1 aggregate-mode=zero-latency"
+    )
+}
+
+
+class ReturnFeed:
+    """
+    Program return feed for the phones.
+
+    The NDI source is received at the lowest bandwidth -- the sender's
+    proxy stream, so there is little to decode -- through an NDI
+    frame-sync, which hands out the latest frame without queueing. Each
+    tick of our own clock takes that frame, scales it with OpenCV's SIMD
+    INTER_AREA and converts it to I420 for the encoder. The realtime
+    encoder has no lookahead, and the payloader's RTP goes straight to a
+    comedia PlainTransport whose producer the phones consume, so the
+    chain adds about one frame interval on top of the phone's jitter
+    buffer, well under 200 ms. Keyframe requests (PLI/FIR) arriving on
+    the same port force a keyframe.
+    """
+
+    def __init__(self, source_name: str, backend_url: str, width: int = 640, height: int = 360,
+                 fps: float = 25.0, bitrate: int = 800000, codec: str = "VP8"):
+        """
+        Initialize return feed
+
+        Args:
+            source_name: NDI source to receive; a full name or part of one
+            backend_url: Backend Socket.io URL
+            width: Encoded width
+            height: Encoded height
+            fps: Encoded frame rate
+            bitrate: Target bitrate in bits per second
+            codec: VP8 or H264
+        """
+        self.source_name = source_name
+        self.width = width
+        self.height = height
+        self.fps = fps
+        self.bitrate = bitrate
+        self.codec = codec.upper()
+        self.ssrc = random.getrandbits(32)
+
+        self.signaling = WebRTCSignaling(backend_url)
+        self.producer_id: Optional[str] = None
+        self.target: Optional[tuple] = None
+        self.sock: Optional[socket.socket] = None
+
+        self.pipeline = None
+        self.appsrc = None
+        self.appsink = None
+        self.finder = None
+        self.receiver = None
+        self.framesync = None
+        self.connected_source: Optional[str] = None
+
+        self._scaled = np.empty((height, width, 4), dtype=np.uint8)
+        self._i420 = np.empty((height * 3 // 2, width), dtype=np.uint8)
+        # Capture time per buffer PTS: written by the capture thread, read
+        # back on the encoder's streaming thread
+        self._push_times: Dict[int, float] = {}
+        self._push_lock = threading.Lock()
+        self._last_keyframe_request = 0.0
+        self._stop = threading.Event()
+        self._thread: Optional[threading.Thread] = None
+        self.stats = {
+            "frames_encoded": 0, "packets_sent": 0, "bytes_sent": 0,
+            "keyframe_requests": 0, "latency_ms": 0.0
+        }
+
+    async def start(self) -> bool:
+        """
+        Publish the feed and start receiving the NDI source
+
+        Returns:
+            bool: True if the feed is running (the NDI source may still be missing)
+        """
+        if not NDI_AVAILABLE or not GST_AVAILABLE:
+            logger.warning("Return feed needs the NDI SDK and GStreamer; not starting it")
+            return False
+        if self.codec not in ENCODERS:
+            logger.error(f"Unsupported return feed codec: {self.codec}")
+            return False
+
+        try:
+            self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+            self.sock.setblocking(False)
+            self.sock.bind(("0.0.0.0", 0))
+
+            if not await self.signaling.connect() or not await self._publish():
+                await self.stop()
+                return False
+            # The backend drops the producer with our connection; publish again on reconnect
+            self.signaling.on_connected = lambda: asyncio.ensure_future(self._publish())
+
+            self._build_encoder()
+            self._thread = threading.Thread(target=self._run, name="return-feed", daemon=True)
+            self._thread.start()
+            logger.info(
+                f"📺 Return feed '{self.source_name}' -> {self.codec} {self.width}x{self.height} "
+                f"@ {self.fps:g} fps, {self.bitrate // 1000} kbps"
+            )
+            return True
+
+        except Exception as e:
+            logger.error(f"Failed to start return feed: {e}")
+            await self.stop()
+            return False
+
+    async def stop(self):
+        """Stop encoding and release the NDI receiver and the producer"""
+        self._stop.set()
+        if self._thread:
+            await asyncio.get_running_loop().run_in_executor(None, self._thread.join)
+            self._thread = None
+        if self.pipeline:
+            self.pipeline.set_state(Gst.State.NULL)
+            self.pipeline = None
+            self.appsrc = None
+            self.appsink = None
+        if self.framesync:
+            ndi.framesync_destroy(self.framesync)
+            self.framesync = None
+        if self.receiver:
+            ndi.recv_destroy(self.receiver)
+            self.receiver = None
+        if self.finder:
+            ndi.find_destroy(self.finder)
+            self.finder = None
+        # Closing our connection closes the producer on the backend
+        await self.signaling.disconnect()
+        if self.sock:
+            self.sock.close()
+            self.sock = None
+
+    async def _publish(self) -> bool:
+        """Create the producer on the backend and learn where to send RTP"""
+        try:
+            response = await self.signaling.sio.call('ndi-bridge-return-feed', {
+                'codec': self.codec,
+                'payload_type': RETURN_FEED_PAYLOAD_TYPE,
+                'ssrc': self.ssrc
+            }, timeout=10)
+            if not response or not response.get('success'):
+                logger.error(f"Backend refused the return feed: {(response or {}).get('error')}")
+                return False
+
+            transport = response['transport']
+            self.producer_id = response['producer_id']
+            self.target = (transport['ip'], int(transport['port']))
+            # A new consumer needs a keyframe to start decoding
+            self._last_keyframe_request = 0.0
+            self._request_keyframe()
+            logger.info(f"📺 Return feed producer {self.producer_id} at {self.target[0]}:{self.target[1]}")
+            return True
+
+        except Exception as e:
+            logger.error(f"Failed to publish return feed: {e}")
+            return False
+
+    def _build_encoder(self):
+        """appsrc (I420) -> encoder -> RTP payloader -> appsink"""
+        encoder, payloader = ENCODERS[self.codec]
+        gop = max(1, int(round(self.fps * 2)))
+        rate = Fraction(self.fps).limit_denominator(1001)
+        pipeline_str = (
+            f"appsrc name=src is-live=true format=time do-timestamp=false "
+            f"caps=video/x-raw,format=I420,width={self.width},height={self.height},"
+            f"framerate={rate.numerator}/{rate.denominator} "
+            f"! {encoder.format(bitrate=self.bitrate, kbps=self.bitrate // 1000, gop=gop)} "
+            f"! {payloader} pt={RETURN_FEED_PAYLOAD_TYPE} ssrc={self.ssrc} mtu={RTP_MTU} "
+            f"! appsink name=sink emit-signals=true sync=false"
+        )
+        logger.info(f"Return feed pipeline: {pipeline_str}")
+
+        self.pipeline = Gst.parse_launch(pipeline_str)
+        self.appsrc = self.pipeline.get_by_name("src")
+        self.appsink = self.pipeline.get_by_name("sink")
+        self.appsink.connect("new-sample", self._on_sample)
+        self.pipeline.set_state(Gst.State.PLAYING)
+
+    def _on_sample(self, appsink):
+        """Send one RTP packet from the payloader (GStreamer streaming thread)"""
+        sample = appsink.emit("pull-sample")
+        if sample is None or self.target is None:
+            return Gst.FlowReturn.OK
+        buffer = sample.get_buffer()
+        success, map_info = buffer.map(Gst.MapFlags.READ)
+        if not success:
+            return Gst.FlowReturn.OK
+        try:
+            packet = bytes(map_info.data)
+        finally:
+            buffer.unmap(map_info)
+
+        try:
+            self.sock.sendto(packet, self.target)
+            self.stats["packets_sent"] += 1
+            self.stats["bytes_sent"] += len(packet)
+        except OSError as e:
+            logger.debug(f"Return feed send failed: {e}")
+
+        # The marker closes a frame: NDI capture to last packet on the wire
+        if len(packet) > 1 and packet[1] & 0x80:
+            with self._push_lock:
+                pushed = self._push_times.pop(buffer.pts, None)
+            if pushed is not None:
+                latency = (time.monotonic() - pushed) * 1000.0
+                self.stats["latency_ms"] += 0.1 * (latency - self.stats["latency_ms"])
+        return Gst.FlowReturn.OK
+
+    def _run(self):
+        """Capture, scale and encode at the feed rate (own thread)"""
+        interval = 1.0 / self.fps
+        duration = int(Gst.SECOND / self.fps)
+        index = 0
+        next_time = time.monotonic()
+        while not self._stop.is_set():
+            if self.framesync is None:
+                if not self._connect_source():
+                    continue
+                next_time = time.monotonic()
+
+            captured = time.monotonic()
+            frame = self._capture()
+            if frame is not None:
+                buffer = Gst.Buffer.new_wrapped(frame.tobytes())
+                buffer.pts = index * duration
+                buffer.duration = duration
+                with self._push_lock:
+                    self._push_times[buffer.pts] = captured
+                    if len(self._push_times) > 2 * self.fps:
+                        # Frames the encoder dropped never reach the sink
+                        del self._push_times[next(iter(self._push_times))]
+                self.appsrc.emit("push-buffer", buffer)
+                self.stats["frames_encoded"] += 1
+                index += 1
+
+            self._read_feedback()
+            next_time += interval
+            delay = next_time - time.monotonic()
+            if delay < -interval:
+                next_time = time.monotonic()
+            self._stop.wait(max(0.0, delay))
+
+    def _connect_source(self) -> bool:
+        """Look for the NDI source for a moment and connect a frame-sync to it"""
+        if self.finder is None:
+            self.finder = ndi.find_create_v2()
+        ndi.find_wait_for_sources(self.finder, SOURCE_SEARCH_MS)
+        sources = ndi.find_get_current_sources(self.finder)
+        source = next((s for s in sources if s.ndi_name == self.source_name), None)
+        source = source or next((s for s in sources if self.source_name in s.ndi_name), None)
+        if source is None:
+            return False
+
+        recv_create = ndi.RecvCreateV3()
+        recv_create.color_format = ndi.RECV_COLOR_FORMAT_BGRX_BGRA
+        recv_create.bandwidth = ndi.RECV_BANDWIDTH_LOWEST
+        self.receiver = ndi.recv_create_v3(recv_create)
+        ndi.recv_connect(self.receiver, source)
+        self.framesync = ndi.framesync_create(self.receiver)
+        self.connected_source = source.ndi_name
+        logger.info(f"📺 Return feed receiving '{source.ndi_name}'")
+        return True
+
+    def _capture(self) -> Optional[np.ndarray]:
+        """
+        Latest frame of the source, scaled and converted for the encoder
+
+        Returns:
+            np.ndarray: I420 frame, None before the source sends video
+        """
+        frame = ndi.framesync_capture_video(self.framesync, ndi.FRAME_FORMAT_TYPE_PROGRESSIVE)
+        try:
+            if not frame.xres or frame.data is None or frame.data.size == 0:
+                return None
+            cv2.resize(frame.data, (self.width, self.height), dst=self._scaled, interpolation=cv2.INTER_AREA)
+        finally:
+            ndi.framesync_free_video(self.framesync, frame)
+        return cv2.cvtColor(self._scaled, cv2.COLOR_BGRA2YUV_I420, dst=self._i420)
+
+    def _read_feedback(self):
+        """Drain RTCP from the transport and honour keyframe requests"""
+        while True:
+            try:
+                data = self.sock.recv(2048)
+            except (BlockingIOError, OSError):
+                return
+            if is_rtcp(data) and is_keyframe_request(data, self.ssrc):
+                self.stats["keyframe_requests"] += 1
+                self._request_keyframe()
+
+    def _request_keyframe(self):
+        """Ask the encoder for a keyframe, at most once per KEYFRAME_REQUEST_INTERVAL"""
+        now = time.monotonic()
+        if self.appsink is None or now - self._last_keyframe_request < KEYFRAME_REQUEST_INTERVAL:
+            return
+        self._last_keyframe_request = now
+        structure = Gst.Structure.new_from_string("GstForceKeyUnit, all-headers=(boolean)true")
+        self.appsink.send_event(Gst.Event.new_custom(Gst.EventType.CUSTOM_UPSTREAM, structure))
+
+    def get_stats(self) -> dict:
+        """
+        Get return feed statistics
+
+        Returns:
+            dict: Source, encoding and counters
+        """
+        return {
+            "source_name": self.source_name,
+            "connected_source": self.connected_source,
+            "producer_id": self.producer_id,
+            "codec": self.codec,
+            "resolution": f"{self.width}x{self.height}",
+            "fps": self.fps,
+            "bitrate": self.bitrate,
+            **self.stats
+        }
@@ -16,6 +16,31 @@ frames_dropped = Counter('ndi_bridge_frames_dropped_total', 'Total frames droppe
 frame_processing_latency = Histogram('ndi_bridge_frame_latency_seconds', 'Frame processing latency', ['stream_id'])
 rtp_packets_received = Counter('ndi_bridge_rtp_packets_total', 'RTP packets received', ['stream_id'])
 rtp_errors = Counter('ndi_bridge_rtp_errors_total', 'RTP reception errors', ['stream_id', 'error_type'])
+cpu_budget_remaining = Gauge('ndi_bridge_cpu_budget_remaining_cores', 'Remaining CPU budget in cores')
+stream_cost = Gauge('ndi_bridge_stream_cost_cores', 'Measured CPU cost per stream in cores', ['stream_id'])
+admission_decisions = Counter('ndi_bridge_admission_decisions_total', 'Admission control decisions', ['decision'])
+streams_shed = Counter('ndi_bridge_streams_shed_total', 'Running streams lowered to free CPU budget')
+rtp_fraction_lost = Gauge('ndi_bridge_rtp_fraction_lost', 'RTP packet loss over the last report interval', ['stream_id'])
+rtp_jitter = Gauge('ndi_bridge_rtp_jitter_seconds', 'RTP interarrival jitter', ['stream_id'])
+fec_recovered = Counter('ndi_bridge_fec_recovered_packets_total', 'Lost RTP packets recovered from FEC', ['stream_id'])
+fec_unrecovered = Counter('ndi_bridge_fec_unrecovered_packets_total', 'Lost RTP packets FEC could not recover', ['stream_id'])
+rtp_wakeup_latency = Histogram(
+    'ndi_bridge_rtp_wakeup_latency_seconds', 'Kernel packet arrival to user-space read', ['mode'],
+    buckets=(5e-6, 1e-5, 2.5e-5, 5e-5, 1e-4, 2.5e-4, 5e-4, 1e-3, 2.5e-3, 5e-3, 1e-2)
+)
+rtp_frame_interarrival = Histogram(
+    'ndi_bridge_rtp_frame_interarrival_seconds', 'Time between the first packets of consecutive frames',
+    ['stream_id'], buckets=(0.01, 0.02, 0.03, 0.04, 0.05, 0.075, 0.1, 0.15, 0.25, 0.5, 1.0)
+)
+jitter_buffer_latency = Gauge('ndi_bridge_jitter_buffer_latency_seconds', 'Jitter buffer latency', ['stream_id'])
+house_clock_skew = Histogram(
+    'ndi_bridge_house_clock_skew_seconds', 'Delay from house clock tick to frame submission',
+    buckets=(1e-4, 2.5e-4, 5e-4, 1e-3, 2e-3, 4e-3, 8e-3, 16e-3, 33e-3)
+)
+audio_clock_drift = Gauge('ndi_bridge_audio_clock_drift_ppm', 'Phone audio clock drift against the bridge clock', ['stream_id'])
+audio_buffer_level = Gauge('ndi_bridge_audio_buffer_seconds', 'ASRC buffer occupancy', ['stream_id'])
+audio_underruns = Counter('ndi_bridge_audio_underruns_total', 'Audio blocks padded with silence', ['stream_id'])
+receiver_bitrate_estimate = Gauge('ndi_bridge_receiver_bitrate_estimate_bps', 'Bitrate estimate sent upstream via REMB', ['stream_id'])
 
 def start_metrics_server(port: int = 9090):
     """
@@ -61,3 +86,55 @@ def update_active_streams(count: int):
 def record_stream_created():
     """Record a stream creation event"""
     streams_total.inc()
+
+def update_cpu_budget(remaining: float):
+    """Update the remaining CPU budget gauge"""
+    cpu_budget_remaining.set(remaining)
+
+def record_stream_cost(stream_id: str, cost: float):
+    """Record the measured CPU cost of a stream"""
+    stream_cost.labels(stream_id=stream_id).set(cost)
+
+def record_admission_decision(decision: str):
+    """Record an admission control decision"""
+    admission_decisions.labels(decision=decision).inc()
+
+def record_stream_shed():
+    """Record a running stream being lowered"""
+    streams_shed.inc()
+
+def record_receiver_feedback(stream_id: str, fraction_lost: float, jitter_seconds: float, bitrate: int):
+    """Record loss, jitter and the bitrate estimate reported upstream"""
+    rtp_fraction_lost.labels(stream_id=stream_id).set(fraction_lost)
+    rtp_jitter.labels(stream_id=stream_id).set(jitter_seconds)
+    receiver_bitrate_estimate.labels(stream_id=stream_id).set(bitrate)
+
+def record_fec_recovery(stream_id: str, recovered: int, unrecovered: int):
+    """Record packets recovered and not recovered by FEC"""
+    if recovered > 0:
+        fec_recovered.labels(stream_id=stream_id).inc(recovered)
+    if unrecovered > 0:
+        fec_unrecovered.labels(stream_id=stream_id).inc(unrecovered)
+
+def record_wakeup_latency(mode: str, latency_seconds: float):
+    """Record the delay between kernel arrival and our read of a packet"""
+    rtp_wakeup_latency.labels(mode=mode).observe(max(0.0, latency_seconds))
+
+def record_frame_interarrival(stream_id: str, seconds: float):
+    """Record the gap between frames as seen at the kernel"""
+    rtp_frame_interarrival.labels(stream_id=stream_id).observe(seconds)
+
+def record_jitter_buffer_latency(stream_id: str, seconds: float):
+    """Record the jitter buffer latency chosen from measured jitter"""
+    jitter_buffer_latency.labels(stream_id=stream_id).set(seconds)
+
+def record_house_clock_skew(seconds: float):
+    """Record how far after its tick a sender submitted its frame"""
+    house_clock_skew.observe(max(0.0, seconds))
+
+def record_audio_clock(stream_id: str, drift_ppm: float, level_seconds: float, underruns: int = 0):
+    """Record audio clock drift, ASRC buffer level and new underruns"""
+    audio_clock_drift.labels(stream_id=stream_id).set(drift_ppm)
+    audio_buffer_level.labels(stream_id=stream_id).set(level_seconds)
+    if underruns > 0:
+        audio_underruns.labels(stream_id=stream_id).inc(underruns)
@@ -0,0 +1,107 @@
+"""
+Congestion Control - Receiver-side bitrate estimation for REMB feedback
+"""
+
+import logging
+from typing import Optional
+
+logger = logging.getLogger(__name__)
+
+
+class BitrateController:
+    """
+    Receiver-side bitrate estimator in the spirit of GCC: the loss-based
+    part backs off proportionally to packet loss and probes upwards while
+    the path is clean, rising interarrival jitter is treated as queue
+    build-up, and the estimate is capped further while the bridge host is
+    over its CPU budget so phones stop sending more than we can decode.
+    """
+
+    def __init__(
+        self,
+        min_bitrate: int = 150_000,
+        max_bitrate: int = 1_500_000,
+        start_bitrate: int = 1_000_000,
+        loss_low: float = 0.02,
+        loss_high: float = 0.10,
+        jitter_threshold_ms: float = 30.0,
+        increase_factor: float = 1.08,
+        jitter_decrease_factor: float = 0.85
+    ):
+        """
+        Initialize bitrate controller
+
+        Args:
+            min_bitrate: Floor of the estimate in bits per second
+            max_bitrate: Ceiling of the estimate in bits per second
+            start_bitrate: Initial estimate
+            loss_low: Loss fraction below which the estimate may grow
+            loss_high: Loss fraction above which the estimate backs off
+            jitter_threshold_ms: Jitter treated as queue build-up
+            increase_factor: Multiplicative increase per clean report
+            jitter_decrease_factor: Multiplicative decrease on high jitter
+        """
+        self.min_bitrate = min_bitrate
+        self.max_bitrate = max_bitrate
+        self.loss_low = loss_low
+        self.loss_high = loss_high
+        self.jitter_threshold_ms = jitter_threshold_ms
+        self.increase_factor = increase_factor
+        self.jitter_decrease_factor = jitter_decrease_factor
+
+        self.bitrate = float(max(min_bitrate, min(max_bitrate, start_bitrate)))
+        self.last_reason = "start"
+
+    def update(
+        self,
+        fraction_lost: float,
+        jitter_ms: float,
+        incoming_bitrate: Optional[float] = None,
+        cpu_load: float = 0.0
+    ) -> int:
+        """
+        Update the estimate from one receiver report interval
+
+        Args:
+            fraction_lost: Packet loss since the last update (0..1)
+            jitter_ms: Interarrival jitter in milliseconds
+            incoming_bitrate: Measured receive rate in bits per second
+            cpu_load: Used share of the bridge CPU budget (1.0 = at budget)
+
+        Returns:
+            int: New bitrate estimate in bits per second
+        """
+        rate = self.bitrate
+
+        if fraction_lost > self.loss_high:
+            rate *= 1.0 - 0.5 * fraction_lost
+            self.last_reason = "loss"
+        elif jitter_ms > self.jitter_threshold_ms:
+            rate *= self.jitter_decrease_factor
+            self.last_reason = "jitter"
+        elif fraction_lost < self.loss_low:
+            rate *= self.increase_factor
+            # Do not run away from what the sender actually delivers
+            if incoming_bitrate:
+                rate = min(rate, max(self.bitrate, 1.5 * incoming_bitrate))
+            self.last_reason = "increase"
+        else:
+            self.last_reason = "hold"
+
+        if cpu_load > 1.0:
+            # Scale the stream down by the overload so decode cost fits again
+            reference = min(rate, incoming_bitrate) if incoming_bitrate else rate
+            rate = min(rate, reference / cpu_load)
+            self.last_reason = "cpu"
+
+        self.bitrate = max(self.min_bitrate, min(self.max_bitrate, rate))
+        return int(self.bitrate)
+
+    def get_stats(self) -> dict:
+        """Get controller state"""
+        return {
+            "bitrate": int(self.bitrate),
+            "min_bitrate": self.min_bitrate,
+            "max_bitrate": self.max_bitrate,
+            "reason": self.last_reason
+        }
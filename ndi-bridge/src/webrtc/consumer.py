@@ -30,6 +30,28 @@ class WebRTCConsumer:
         self.on_error = on_error
         self.is_connected = False
         self.consumers: Dict[str, dict] = {}
+        self.rtp_receivers: Dict[str, Any] = {}
+        
+        # Receiver selection and congestion feedback
+        self.receiver_mode = "native"  # "native" or "aiortc"
+        self.min_bitrate = 150_000
+        self.max_bitrate = 1_500_000
+        self.on_bitrate_estimate: Optional[Callable[[str, int], None]] = None
+        self.cpu_load: Optional[Callable[[], float]] = None
+        
+        # Socket backend for the native receiver ("udp", "busy_poll" or "af_xdp")
+        self.socket_backend = "udp"
+        self.busy_poll_core: Optional[int] = None
+        self.busy_poll_spin_us = 500
+        self.busy_poller = None
+        self.xdp_interface = "eth0"
+        self.xdp_queue = 0
+        self.xdp_port_range = (10000, 10100)
+        self.xdp_native_mode = False
+        self.packet_source = None
+        self.decode_threads = 0  # decoder threads per stream, 0 for one per CPU
+        self.test_pattern_size = (1280, 720)
+        self.audio_receivers: Dict[str, object] = {}
         
         # Set up signaling callbacks
         self.signaling.on_connected = self._on_connected
@@ -67,6 +89,14 @@ class WebRTCConsumer:
             for stream_id in list(self.consumers.keys()):
                 await self.stop_stream(stream_id)
             
+            if self.packet_source:
+                self.packet_source.stop()
+                self.packet_source = None
+            
+            if self.busy_poller:
+                self.busy_poller.stop()
+                self.busy_poller = None
+            
             # Disconnect signaling
             await self.signaling.disconnect()
             self.is_connected = False
@@ -113,6 +143,30 @@ class WebRTCConsumer:
             logger.info(f"Transport info: {transport_info}")
             logger.info(f"RTP parameters: {rtp_parameters}")
             
+            return await self.receive_stream(stream_id, producer_id, transport_info, rtp_parameters, consumer_id)
+            
+        except Exception as e:
+            logger.error(f"Failed to consume stream {stream_id}: {e}")
+            if self.on_error:
+                self.on_error(f"consume-{stream_id}", e)
+            return False
+    
+    async def receive_stream(self, stream_id: str, producer_id: str, transport_info: dict,
+                             rtp_parameters: dict, consumer_id: Optional[str] = None) -> bool:
+        """
+        Start RTP reception for a consumer the backend already created
+        
+        Args:
+            stream_id: Unique stream identifier
+            producer_id: Mediasoup producer ID
+            transport_info: PlainTransport tuple from the backend
+            rtp_parameters: Consumer RTP parameters
+            consumer_id: Mediasoup consumer ID
+            
+        Returns:
+            bool: True if reception started
+        """
+        try:
             # For PlainTransport, we need to receive RTP packets directly
             # Store consumer info for RTP reception
             self.consumers[stream_id] = {
@@ -129,7 +183,7 @@ class WebRTCConsumer:
             return True
             
         except Exception as e:
-            logger.error(f"Failed to consume stream {stream_id}: {e}")
+            logger.error(f"Failed to start reception for {stream_id}: {e}")
             if self.on_error:
                 self.on_error(f"consume-{stream_id}", e)
             return False
@@ -139,9 +193,6 @@ class WebRTCConsumer:
         Receive real RTP packets from Mediasoup PlainTransport
         """
         try:
-            from webrtc.rtp_receiver import RTPReceiver
-            from webrtc.gstreamer_receiver import GStreamerRTPReceiver
-            
             # Extract transport details
             transport_ip = transport_info.get('ip')
             transport_port = transport_info.get('port')
@@ -149,6 +200,17 @@ class WebRTCConsumer:
             logger.info(f"🎥 Starting real RTP reception for {stream_id}")
             logger.info(f"📡 Transport: {transport_ip}:{transport_port}")
             
+            codec = rtp_parameters.get('codecs', [{}])[0].get('mimeType', 'video/VP8').split('/')[1]
+            
+            # Own socket with loss/jitter/CPU-aware REMB feedback
+            if self.receiver_mode == "native" and await self._start_native_receiver(
+                stream_id, transport_ip, transport_port, codec, rtp_parameters
+            ):
+                return
+            
+            from webrtc.rtp_receiver import RTPReceiver
+            from webrtc.gstreamer_receiver import GStreamerRTPReceiver
+            
             # Try aiortc first
             rtp_receiver = RTPReceiver(
                 stream_id=stream_id,
@@ -160,24 +222,22 @@ class WebRTCConsumer:
             # Start receiving with aiortc
             if await rtp_receiver.start(rtp_parameters):
                 # Store receiver for cleanup
-                self.rtp_receivers = getattr(self, 'rtp_receivers', {})
                 self.rtp_receivers[stream_id] = rtp_receiver
                 logger.info(f"✅ Real RTP reception started for {stream_id}")
             else:
                 logger.warning(f"⚠️ aiortc failed for {stream_id}, trying GStreamer fallback")
                 
                 # Fallback to GStreamer
-                codec = rtp_parameters.get('codecs', [{}])[0].get('mimeType', 'video/VP8').split('/')[1]
                 gst_receiver = GStreamerRTPReceiver(
                     stream_id=stream_id,
                     transport_ip=transport_ip,
                     transport_port=transport_port,
                     codec=codec,
-                    on_frame=lambda frame: self._forward_frame_to_ndi(stream_id, frame)
+                    on_frame=lambda frame: self._forward_frame_to_ndi(stream_id, frame),
+                    decode_threads=self.decode_threads
                 )
                 
                 if await gst_receiver.start():
-                    self.rtp_receivers = getattr(self, 'rtp_receivers', {})
                     self.rtp_receivers[stream_id] = gst_receiver
                     logger.info(f"✅ GStreamer RTP reception started for {stream_id}")
                 else:
@@ -191,6 +251,126 @@ class WebRTCConsumer:
             logger.info(f"Falling back to test pattern for {stream_id}")
             await self._generate_test_pattern_loop(stream_id)
 
+    async def _start_native_receiver(self, stream_id: str, transport_ip: str, transport_port: int,
+                                     codec: str, rtp_parameters: dict) -> bool:
+        """Start the native receiver, False to fall back to aiortc/GStreamer"""
+        from webrtc.congestion import BitrateController
+        from webrtc.fec import FecDecoder
+        from webrtc.native_receiver import NativeRTPReceiver
+        
+        clock_rate = rtp_parameters.get('codecs', [{}])[0].get('clockRate', 90000)
+        receiver = NativeRTPReceiver(
+            stream_id=stream_id,
+            transport_ip=transport_ip,
+            transport_port=transport_port,
+            codec=codec,
+            clock_rate=clock_rate,
+            on_frame=lambda frame: self._forward_frame_to_ndi(stream_id, frame),
+            on_bitrate=lambda bitrate: self._on_bitrate(stream_id, bitrate),
+            cpu_load=self.cpu_load,
+            controller=BitrateController(min_bitrate=self.min_bitrate, max_bitrate=self.max_bitrate),
+            fec=FecDecoder.from_rtp_parameters(rtp_parameters),
+            packet_source=self._get_packet_source(),
+            busy_poller=self._get_busy_poller(),
+            decode_threads=self.decode_threads
+        )
+        
+        if not await receiver.start():
+            logger.warning(f"⚠️ Native receiver failed for {stream_id}, trying aiortc")
+            return False
+        
+        self.rtp_receivers[stream_id] = receiver
+        logger.info(f"✅ Native RTP reception started for {stream_id}")
+        return True
+    
+    def _get_packet_source(self):
+        """Shared AF_XDP ingest, started on first use; None for plain UDP"""
+        if self.socket_backend != "af_xdp":
+            return None
+        if self.packet_source is None:
+            from webrtc.xdp_socket import XdpPacketSource
+            
+            source = XdpPacketSource(
+                interface=self.xdp_interface,
+                queue_id=self.xdp_queue,
+                port_min=self.xdp_port_range[0],
+                port_max=self.xdp_port_range[1],
+                native=self.xdp_native_mode
+            )
+            if not source.start():
+                logger.warning("⚠️ AF_XDP ingest unavailable, receiving over UDP sockets")
+                self.socket_backend = "udp"
+                return None
+            self.packet_source = source
+        return self.packet_source
+    
+    def _get_busy_poller(self):
+        """Shared busy-poll reader thread, started on first use"""
+        if self.socket_backend != "busy_poll":
+            return None
+        if self.busy_poller is None:
+            from webrtc.rtp_socket import BusyPollReader
+            
+            self.busy_poller = BusyPollReader(core=self.busy_poll_core, spin_budget_us=self.busy_poll_spin_us)
+            self.busy_poller.start()
+        return self.busy_poller
+    
+    def _on_bitrate(self, stream_id: str, bitrate: int):
+        """Forward a bitrate estimate change"""
+        if self.on_bitrate_estimate:
+            self.on_bitrate_estimate(stream_id, bitrate)
+    
+    async def set_decoding(self, stream_id: str, active: bool) -> bool:
+        """
+        Suspend or resume decoding of a stream
+        
+        Only the native receiver supports this; it keeps caching the current
+        GOP while suspended so resuming needs no keyframe request.
+        
+        Args:
+            stream_id: Stream identifier
+            active: True to decode, False to suspend
+            
+        Returns:
+            bool: True if the receiver is now in the requested state
+        """
+        receiver = self.rtp_receivers.get(stream_id)
+        if not receiver or not hasattr(receiver, 'resume_decoding'):
+            return False
+        if active:
+            return await receiver.resume_decoding()
+        await receiver.suspend_decoding()
+        return True
+    
+    def attach_packets(self, stream_id: str, callback: Callable[[bytes], None]) -> Optional[int]:
+        """
+        Attach to a stream's compressed packets, starting at the last keyframe
+        
+        Args:
+            stream_id: Stream identifier
+            callback: Receives RTP packets in wire format
+            
+        Returns:
+            int: Subscription id, or None if the receiver has no GOP cache
+        """
+        receiver = self.rtp_receivers.get(stream_id)
+        if not receiver or not hasattr(receiver, 'attach'):
+            return None
+        return receiver.attach(callback)
+    
+    def detach_packets(self, stream_id: str, subscription: int):
+        """Detach from a stream's compressed packets"""
+        receiver = self.rtp_receivers.get(stream_id)
+        if receiver and hasattr(receiver, 'detach'):
+            receiver.detach(subscription)
+    
+    def get_receiver_stats(self, stream_id: str) -> Optional[dict]:
+        """Get statistics of the RTP receiver of a stream"""
+        receiver = self.rtp_receivers.get(stream_id)
+        if receiver and hasattr(receiver, 'get_stats'):
+            return receiver.get_stats()
+        return None
+    
     def _forward_frame_to_ndi(self, stream_id: str, frame: np.ndarray):
         """Forward received frame to NDI pipeline"""
         if self.on_frame_received:
@@ -211,7 +391,7 @@ class WebRTCConsumer:
         import numpy as np
         
         # Create test pattern
-        width, height = 1280, 720
+        width, height = self.test_pattern_size
         img = np.zeros((height, width, 3), dtype=np.uint8)
         
         # Add moving elements
@@ -250,7 +430,7 @@ class WebRTCConsumer:
             np.ndarray: Test pattern image in BGR format
         """
         # Create test pattern using only numpy
-        width, height = 1280, 720
+        width, height = self.test_pattern_size
         img = np.zeros((height, width, 3), dtype=np.uint8)
         
         # Add moving elements using simple math
@@ -328,6 +508,43 @@ class WebRTCConsumer:
         except Exception as e:
             logger.error(f"Error in test pattern generation for {stream_id}: {e}")
     
+    async def receive_audio(self, stream_id: str, transport_info: dict, rtp_parameters: dict,
+                            on_audio: Callable, on_packet_timing: Optional[Callable] = None) -> bool:
+        """
+        Start Opus reception for a stream's audio consumer
+        
+        Args:
+            stream_id: Stream identifier
+            transport_info: PlainTransport tuple of the audio consumer
+            rtp_parameters: Audio consumer RTP parameters
+            on_audio: Receives decoded float32 (frames, channels) blocks
+            on_packet_timing: Receives (RTP timestamp, arrival) per packet
+            
+        Returns:
+            bool: True if reception started
+        """
+        from webrtc.native_receiver import NativeRTPReceiver
+        
+        codec = rtp_parameters.get('codecs', [{}])[0]
+        receiver = NativeRTPReceiver(
+            stream_id=f"{stream_id}-audio",
+            transport_ip=transport_info.get('ip'),
+            transport_port=transport_info.get('port'),
+            codec=codec.get('mimeType', 'audio/opus').split('/')[1],
+            clock_rate=codec.get('clockRate', 48000),
+            on_frame=on_audio,
+            packet_source=self._get_packet_source(),
+            busy_poller=self._get_busy_poller(),
+            on_packet_timing=on_packet_timing
+        )
+        
+        if not await receiver.start():
+            logger.warning(f"⚠️ Audio reception failed for {stream_id}")
+            return False
+        
+        self.audio_receivers[stream_id] = receiver
+        return True
+    
     async def stop_stream(self, stream_id: str) -> bool:
         """
         Stop consuming a specific stream
@@ -339,12 +556,15 @@ class WebRTCConsumer:
             bool: True if stream stopped successfully
         """
         try:
+            audio_receiver = self.audio_receivers.pop(stream_id, None)
+            if audio_receiver:
+                await audio_receiver.stop()
+            
             if stream_id in self.consumers:
                 # Stop RTP receiver if exists
-                rtp_receivers = getattr(self, 'rtp_receivers', {})
-                if stream_id in rtp_receivers:
-                    await rtp_receivers[stream_id].stop()
-                    del rtp_receivers[stream_id]
+                if stream_id in self.rtp_receivers:
+                    await self.rtp_receivers[stream_id].stop()
+                    del self.rtp_receivers[stream_id]
                 
                 # Remove consumer
                 del self.consumers[stream_id]
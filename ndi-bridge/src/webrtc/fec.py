@@ -0,0 +1,384 @@
+"""
+FEC Recovery - RED (RFC 2198), ULPFEC (RFC 5109) and FlexFEC (flexfec-03)
+decoding for the native RTP receiver
+"""
+
+import logging
+import struct
+from collections import OrderedDict
+from dataclasses import dataclass
+from typing import Dict, List, Optional, Tuple
+
+from webrtc.rtp_packet import RTP_VERSION, RtpPacket
+
+logger = logging.getLogger(__name__)
+
+
+def decapsulate_red(payload: bytes) -> List[Tuple[int, int, bytes]]:
+    """
+    Split a RED payload into its blocks
+
+    Args:
+        payload: RTP payload of a RED packet
+
+    Returns:
+        list: (payload type, timestamp offset, data) per block, primary last
+    """
+    headers = []
+    offset = 0
+    while True:
+        if offset >= len(payload):
+            return []
+        if payload[offset] & 0x80:
+            if offset + 4 > len(payload):
+                return []
+            word = struct.unpack_from("!I", payload, offset)[0]
+            headers.append(((word >> 24) & 0x7F, (word >> 10) & 0x3FFF, word & 0x3FF))
+            offset += 4
+        else:
+            headers.append((payload[offset] & 0x7F, 0, None))
+            offset += 1
+            break
+
+    blocks = []
+    for payload_type, ts_offset, length in headers:
+        if length is None:
+            length = len(payload) - offset
+        if offset + length > len(payload):
+            return []
+        blocks.append((payload_type, ts_offset, payload[offset:offset + length]))
+        offset += length
+    return blocks
+
+
+@dataclass
+class FecPacket:
+    """
+    Parsed FEC packet reduced to what XOR recovery needs
+    """
+    protected_ssrc: int
+    protected_seqs: List[int]
+    flags: bytes            # P, X, CC, M, PT recovery (first two header bytes)
+    ts_recovery: int
+    length_recovery: int
+    protection_length: int
+    payload: bytes
+
+
+def parse_ulpfec(packet: RtpPacket, fec_payload: bytes) -> Optional[FecPacket]:
+    """
+    Parse a ULPFEC packet (RFC 5109), level 0 only
+
+    Args:
+        packet: Outer RTP packet (SSRC of the protected stream)
+        fec_payload: ULPFEC header and payload
+
+    Returns:
+        FecPacket: Parsed FEC packet or None if malformed
+    """
+    if len(fec_payload) < 14:
+        return None
+    long_mask = bool(fec_payload[0] & 0x40)
+    mask_bytes = 6 if long_mask else 2
+    header_size = 10 + 2 + mask_bytes
+    if len(fec_payload) < header_size:
+        return None
+
+    sn_base, ts_recovery, length_recovery = struct.unpack_from("!HIH", fec_payload, 2)
+    protection_length = struct.unpack_from("!H", fec_payload, 10)[0]
+    mask = int.from_bytes(fec_payload[12:12 + mask_bytes], "big")
+    mask_bits = mask_bytes * 8
+
+    seqs = [
+        (sn_base + i) & 0xFFFF
+        for i in range(mask_bits)
+        if mask & (1 << (mask_bits - 1 - i))
+    ]
+    return FecPacket(
+        protected_ssrc=packet.ssrc,
+        protected_seqs=seqs,
+        flags=bytes(fec_payload[0:2]),
+        ts_recovery=ts_recovery,
+        length_recovery=length_recovery,
+        protection_length=protection_length,
+        payload=bytes(fec_payload[header_size:header_size + protection_length])
+    )
+
+
+def parse_flexfec(packet: RtpPacket) -> Optional[FecPacket]:
+    """
+    Parse a FlexFEC packet in the flexfec-03 format used by libwebrtc
+    (single protected SSRC, flexible mask)
+
+    Args:
+        packet: FlexFEC RTP packet
+
+    Returns:
+        FecPacket: Parsed FEC packet or None if malformed or unsupported
+    """
+    data = packet.payload
+    if len(data) < 20 or data[0] & 0x80:  # R bit: retransmission, not FEC
+        return None
+    if data[0] & 0x40:  # F bit: fixed masks are not produced by libwebrtc
+        return None
+
+    length_recovery, ts_recovery = struct.unpack_from("!HI", data, 2)
+    ssrc_count = data[8]
+    if ssrc_count != 1:
+        return None
+    protected_ssrc, sn_base = struct.unpack_from("!IH", data, 12)
+
+    # k-bit terminated mask: 15, 15+31 or 15+31+63 bits
+    offset = 18
+    mask_bits: List[int] = []
+    for width, size in ((15, 2), (31, 4), (63, 8)):
+        if offset + size > len(data):
+            return None
+        chunk = int.from_bytes(data[offset:offset + size], "big")
+        last = bool(chunk >> (size * 8 - 1))
+        mask_bits.extend((chunk >> (width - 1 - i)) & 1 for i in range(width))
+        offset += size
+        if last:
+            break
+    else:
+        return None
+
+    seqs = [(sn_base + i) & 0xFFFF for i, bit in enumerate(mask_bits) if bit]
+    payload = bytes(data[offset:])
+    return FecPacket(
+        protected_ssrc=protected_ssrc,
+        protected_seqs=seqs,
+        flags=bytes(data[0:2]),
+        ts_recovery=ts_recovery,
+        length_recovery=length_recovery,
+        protection_length=len(payload),
+        payload=payload
+    )
+
+
+def _xor_into(target: bytearray, data: bytes):
+    if len(data) > len(target):
+        target.extend(bytes(len(data) - len(target)))
+    for index, value in enumerate(data):
+        target[index] ^= value
+
+
+class FecDecoder:
+    """
+    Recovers lost media packets from RED/ULPFEC or FlexFEC without waiting
+    for a retransmission. Media packets come out de-encapsulated from RED;
+    recovered packets are emitted as soon as a FEC packet has exactly one
+    of its protected packets missing.
+    """
+
+    def __init__(
+        self,
+        red_pt: Optional[int] = None,
+        ulpfec_pt: Optional[int] = None,
+        flexfec_pt: Optional[int] = None,
+        window: int = 512,
+        max_fec_packets: int = 64,
+        recovery_horizon: int = 64
+    ):
+        """
+        Initialize FEC decoder
+
+        Args:
+            red_pt: Payload type of RED
+            ulpfec_pt: Payload type of ULPFEC inside RED
+            flexfec_pt: Payload type of the FlexFEC stream
+            window: Media packets kept for recovery
+            max_fec_packets: FEC packets kept while waiting for media
+            recovery_horizon: Packets after which a gap counts as unrecovered
+        """
+        self.red_pt = red_pt
+        self.ulpfec_pt = ulpfec_pt
+        self.flexfec_pt = flexfec_pt
+        self.window = window
+        self.max_fec_packets = max_fec_packets
+        self.recovery_horizon = recovery_horizon
+
+        self.media: "OrderedDict[int, RtpPacket]" = OrderedDict()
+        self.fec_packets: List[FecPacket] = []
+        self.media_ssrc: Optional[int] = None
+
+        # Loss tracking in extended sequence numbers
+        self._highest: Optional[int] = None
+        self._missing: Dict[int, bool] = {}
+
+        self.stats = {
+            "fec_packets": 0,
+            "recovered": 0,
+            "unrecovered": 0
+        }
+
+    @classmethod
+    def from_rtp_parameters(cls, rtp_parameters: dict) -> Optional["FecDecoder"]:
+        """
+        Build a decoder from consumer RTP parameters
+
+        Args:
+            rtp_parameters: Mediasoup consumer RTP parameters
+
+        Returns:
+            FecDecoder: Decoder, or None if no FEC codec was negotiated
+        """
+        payload_types = {}
+        for codec in rtp_parameters.get("codecs", []):
+            mime = codec.get("mimeType", "").lower()
+            payload_types[mime.split("/")[-1]] = codec.get("payloadType")
+
+        red_pt = payload_types.get("red")
+        ulpfec_pt = payload_types.get("ulpfec")
+        flexfec_pt = payload_types.get("flexfec-03")
+        if red_pt is None and flexfec_pt is None:
+            return None
+        return cls(red_pt=red_pt, ulpfec_pt=ulpfec_pt, flexfec_pt=flexfec_pt)
+
+    def is_fec_stream(self, packet: RtpPacket) -> bool:
+        """True for packets of the separate FlexFEC stream"""
+        return self.flexfec_pt is not None and packet.payload_type == self.flexfec_pt
+
+    def process(self, packet: RtpPacket) -> List[RtpPacket]:
+        """
+        Feed one received packet
+
+        Args:
+            packet: Received RTP packet
+
+        Returns:
+            list: Media packets ready for depacketization, recovered ones included
+        """
+        if self.is_fec_stream(packet):
+            fec = parse_flexfec(packet)
+            return self._add_fec(fec) if fec else []
+
+        if self.red_pt is not None and packet.payload_type == self.red_pt:
+            blocks = decapsulate_red(packet.payload)
+            if not blocks:
+                return []
+            payload_type, _, data = blocks[-1]
+            if payload_type == self.ulpfec_pt:
+                # FEC shares the media sequence space, so it fills a gap too
+                self._track_sequence(packet.sequence_number)
+                self._missing.pop(self._extend(packet.sequence_number), None)
+                fec = parse_ulpfec(packet, data)
+                return self._add_fec(fec) if fec else []
+            packet = RtpPacket(
+                payload_type=payload_type,
+                sequence_number=packet.sequence_number,
+                timestamp=packet.timestamp,
+                ssrc=packet.ssrc,
+                marker=packet.marker,
+                payload=data,
+                csrcs=packet.csrcs,
+                extension_profile=packet.extension_profile,
+                extension=packet.extension
+            )
+
+        if packet.sequence_number in self.media:
+            # Already recovered from FEC, or a duplicate
+            return []
+
+        self.media_ssrc = packet.ssrc
+        self._track_sequence(packet.sequence_number)
+        self._store(packet)
+        return [packet] + self._try_recover()
+
+    def _add_fec(self, fec: FecPacket) -> List[RtpPacket]:
+        self.stats["fec_packets"] += 1
+        self.fec_packets.append(fec)
+        if len(self.fec_packets) > self.max_fec_packets:
+            self.fec_packets.pop(0)
+        return self._try_recover()
+
+    def _store(self, packet: RtpPacket):
+        self.media[packet.sequence_number] = packet
+        self.media.move_to_end(packet.sequence_number)
+        while len(self.media) > self.window:
+            self.media.popitem(last=False)
+        self._missing.pop(self._extend(packet.sequence_number), None)
+
+    def _try_recover(self) -> List[RtpPacket]:
+        recovered = []
+        progress = True
+        while progress:
+            progress = False
+            for fec in list(self.fec_packets):
+                missing = [seq for seq in fec.protected_seqs if seq not in self.media]
+                if not missing:
+                    self.fec_packets.remove(fec)
+                elif len(missing) == 1:
+                    self.fec_packets.remove(fec)
+                    packet = self._recover(fec, missing[0])
+                    if packet:
+                        self._store(packet)
+                        self.stats["recovered"] += 1
+                        recovered.append(packet)
+                        progress = True
+        return recovered
+
+    def _recover(self, fec: FecPacket, seq: int) -> Optional[RtpPacket]:
+        """XOR the FEC bit string with every other protected packet"""
+        flags = bytearray(fec.flags)
+        length = fec.length_recovery
+        timestamp = fec.ts_recovery
+        payload = bytearray(fec.payload)
+
+        for protected_seq in fec.protected_seqs:
+            if protected_seq == seq:
+                continue
+            media = self.media[protected_seq]
+            raw = media.serialize()
+            flags[0] ^= raw[0]
+            flags[1] ^= raw[1]
+            length ^= len(raw) - 12
+            timestamp ^= media.timestamp
+            _xor_into(payload, raw[12:12 + fec.protection_length])
+
+        if length > len(payload):
+            logger.debug(f"FEC recovery of {seq} failed: length {length} beyond protected data")
+            return None
+
+        data = bytearray(struct.pack(
+            "!BBHII",
+            (RTP_VERSION << 6) | (flags[0] & 0x3F),
+            flags[1],
+            seq,
+            timestamp & 0xFFFFFFFF,
+            fec.protected_ssrc
+        ))
+        data += payload[:length]
+        return RtpPacket.parse(bytes(data))
+
+    def _extend(self, seq: int) -> int:
+        """Extended sequence number closest to the highest seen"""
+        if self._highest is None:
+            return seq
+        base = self._highest & ~0xFFFF
+        candidates = (base - 0x10000 + seq, base + seq, base + 0x10000 + seq)
+        return min(candidates, key=lambda value: abs(value - self._highest))
+
+    def _track_sequence(self, seq: int):
+        """Record gaps and expire the ones FEC can no longer fill"""
+        extended = self._extend(seq)
+        if self._highest is None:
+            self._highest = extended
+            return
+        if extended > self._highest:
+            for gap in range(max(self._highest + 1, extended - self.window), extended):
+                self._missing[gap] = True
+            self._highest = extended
+
+        horizon = self._highest - self.recovery_horizon
+        for gap in [gap for gap in self._missing if gap <= horizon]:
+            del self._missing[gap]
+            self.stats["unrecovered"] += 1
+
+    def get_stats(self) -> dict:
+        """Get FEC statistics"""
+        return {
+            **self.stats,
+            "pending_loss": len(self._missing),
+            "pending_fec": len(self.fec_packets)
+        }
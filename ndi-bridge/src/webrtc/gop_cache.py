@@ -0,0 +1,203 @@
+"""
+GOP Cache - Keeps the compressed packets since the last keyframe so a newly
+attached decoder can catch up to "now" without waiting for a keyframe
+"""
+
+import logging
+from typing import Callable, Dict, List, Optional
+
+from webrtc.rtp_packet import RtpPacket
+
+logger = logging.getLogger(__name__)
+
+
+def _vp8_is_keyframe(payload: bytes) -> bool:
+    """First packet of a VP8 keyframe (RFC 7741 payload descriptor)"""
+    if not payload:
+        return False
+    first = payload[0]
+    start_of_partition = bool(first & 0x10)
+    partition_id = first & 0x07
+    if not start_of_partition or partition_id != 0:
+        return False
+
+    offset = 1
+    if first & 0x80:
+        if len(payload) < 2:
+            return False
+        extension = payload[1]
+        offset = 2
+        if extension & 0x80:  # I: picture id, 7 or 15 bits
+            if len(payload) <= offset:
+                return False
+            offset += 2 if payload[offset] & 0x80 else 1
+        if extension & 0x40:  # L: TL0PICIDX
+            offset += 1
+        if extension & 0x30:  # T or K: TID/KEYIDX byte
+            offset += 1
+
+    # VP8 payload header: P bit clear means keyframe
+    return len(payload) > offset and not payload[offset] & 0x01
+
+
+def _vp9_is_keyframe(payload: bytes) -> bool:
+    """First packet of a VP9 keyframe (P bit clear on a start of frame)"""
+    if not payload:
+        return False
+    first = payload[0]
+    inter_predicted = bool(first & 0x40)
+    start_of_frame = bool(first & 0x08)
+    return start_of_frame and not inter_predicted
+
+
+def _h264_is_keyframe(payload: bytes) -> bool:
+    """Packet carrying SPS or the start of an IDR slice (RFC 6184)"""
+    if not payload:
+        return False
+    nal_type = payload[0] & 0x1F
+    if nal_type in (5, 7):
+        return True
+    if nal_type == 24:  # STAP-A
+        offset = 1
+        while offset + 2 < len(payload):
+            size = int.from_bytes(payload[offset:offset + 2], "big")
+            if payload[offset + 2] & 0x1F in (5, 7):
+                return True
+            offset += 2 + size
+        return False
+    if nal_type == 28 and len(payload) > 1:  # FU-A start of an IDR
+        return bool(payload[1] & 0x80) and payload[1] & 0x1F == 5
+    return False
+
+
+KEYFRAME_DETECTORS: Dict[str, Callable[[bytes], bool]] = {
+    "VP8": _vp8_is_keyframe,
+    "VP9": _vp9_is_keyframe,
+    "H264": _h264_is_keyframe,
+}
+
+
+def is_keyframe_start(codec: str, payload: bytes) -> bool:
+    """
+    Tell whether an RTP payload starts a keyframe
+
+    Args:
+        codec: Codec name (VP8, VP9, H264)
+        payload: RTP payload
+
+    Returns:
+        bool: True if the packet begins a keyframe
+    """
+    detector = KEYFRAME_DETECTORS.get(codec.upper())
+    return bool(detector and detector(payload))
+
+
+class GopCache:
+    """
+    Per-stream cache of the RTP packets of the current group of pictures.
+
+    A keyframe starts a new GOP and drops the previous one. Subscribers
+    get the cached GOP first and every live packet after it, so they can
+    decode up to the live edge at once instead of asking for a PLI.
+    """
+
+    def __init__(self, codec: str, max_bytes: int = 8 * 1024 * 1024):
+        """
+        Initialize GOP cache
+
+        Args:
+            codec: Codec name used for keyframe detection
+            max_bytes: Cache limit; a longer GOP is dropped until the next keyframe
+        """
+        self.codec = codec
+        self.max_bytes = max_bytes
+
+        self.packets: List[bytes] = []
+        self.size = 0
+        self.valid = False  # True once a keyframe has been seen and the GOP fits
+        self.keyframe_timestamp: Optional[int] = None
+
+        self.subscribers: Dict[int, Callable[[bytes], None]] = {}
+        self._next_subscriber = 0
+
+        self.stats = {
+            "keyframes": 0,
+            "overflows": 0,
+            "attaches": 0
+        }
+
+    def add(self, packet: RtpPacket, data: Optional[bytes] = None):
+        """
+        Add a media packet
+
+        Args:
+            packet: Parsed media packet
+            data: Wire bytes of the packet if already serialized (copied if a view)
+        """
+        data = bytes(data) if data is not None else packet.serialize()
+
+        if packet.timestamp != self.keyframe_timestamp and is_keyframe_start(self.codec, packet.payload):
+            self.packets = []
+            self.size = 0
+            self.valid = True
+            self.keyframe_timestamp = packet.timestamp
+            self.stats["keyframes"] += 1
+
+        if self.valid:
+            self.packets.append(data)
+            self.size += len(data)
+            if self.size > self.max_bytes:
+                logger.warning(f"GOP exceeds {self.max_bytes} bytes, dropping cache until next keyframe")
+                self.packets = []
+                self.size = 0
+                self.valid = False
+                self.stats["overflows"] += 1
+
+        for callback in list(self.subscribers.values()):
+            callback(data)
+
+    def snapshot(self) -> List[bytes]:
+        """
+        Packets from the last keyframe up to now
+
+        Returns:
+            list: Wire packets, empty if no complete GOP is cached
+        """
+        return list(self.packets) if self.valid else []
+
+    def frame_count(self) -> int:
+        """Number of frames (distinct RTP timestamps) a new consumer is replayed"""
+        return len({data[4:8] for data in self.snapshot()})
+
+    def attach(self, callback: Callable[[bytes], None]) -> int:
+        """
+        Attach a consumer: replay the cached GOP, then follow live packets
+
+        Args:
+            callback: Receives wire packets
+
+        Returns:
+            int: Subscription id for detach()
+        """
+        for data in self.snapshot():
+            callback(data)
+
+        subscription = self._next_subscriber
+        self._next_subscriber += 1
+        self.subscribers[subscription] = callback
+        self.stats["attaches"] += 1
+        return subscription
+
+    def detach(self, subscription: int):
+        """Stop following live packets"""
+        self.subscribers.pop(subscription, None)
+
+    def get_stats(self) -> dict:
+        """Get cache statistics"""
+        return {
+            **self.stats,
+            "valid": self.valid,
+            "packets": len(self.packets),
+            "bytes": self.size,
+            "subscribers": len(self.subscribers)
+        }
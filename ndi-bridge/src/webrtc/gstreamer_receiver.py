@@ -8,12 +8,17 @@ gi.require_version('Gst', '1.0')
 from gi.repository import Gst, GLib
 import numpy as np
 import logging
+import os
+import time
 from typing import Optional, Callable
 
 logger = logging.getLogger(__name__)
 
 Gst.init(None)
 
+# vp8dec rejects a "threads" value above 16
+VP8_MAX_THREADS = 16
+
 class GStreamerRTPReceiver:
     """
     Alternative RTP receiver using GStreamer
@@ -26,15 +31,24 @@ class GStreamerRTPReceiver:
         transport_ip: str,
         transport_port: int,
         codec: str = "VP8",
-        on_frame: Optional[Callable] = None
+        on_frame: Optional[Callable] = None,
+        use_appsrc: bool = False,
+        decode_threads: int = 0
     ):
         self.stream_id = stream_id
         self.transport_ip = transport_ip
         self.transport_port = transport_port
         self.codec = codec
         self.on_frame = on_frame
+        # With appsrc the caller owns the socket and pushes RTP packets in
+        self.use_appsrc = use_appsrc
+        # Decoder and colour-convert threads, 0 for one per CPU (4K60 needs several)
+        self.decode_threads = decode_threads or os.cpu_count() or 1
         
         self.pipeline: Optional[Gst.Pipeline] = None
+        self.appsrc = None
+        self.jitterbuffer = None
+        self._base_time = 0.0  # wall clock at PLAYING, for arrival timestamps
         self.mainloop: Optional[GLib.MainLoop] = None
         self.is_running = False
         
@@ -42,25 +56,39 @@ class GStreamerRTPReceiver:
         """Start GStreamer RTP reception"""
         try:
             # Build GStreamer pipeline based on codec
+            source = self._source_element()
             if self.codec.upper() == "VP8":
                 pipeline_str = (
-                    f"udpsrc port={self.transport_port} "
-                    f"! application/x-rtp,media=video,encoding-name=VP8 "
+                    f"{source} "
+                    f"! application/x-rtp,media=video,clock-rate=90000,encoding-name=VP8 "
+                    f"{self._jitter_buffer()}"
                     f"! rtpvp8depay "
-                    f"! vp8dec "
-                    f"! videoconvert "
-                    f"! video/x-raw,format=BGR "
+                    f"! vp8dec threads={min(self.decode_threads, VP8_MAX_THREADS)} "
+                    f"{self._convert()}"
                     f"! appsink name=sink emit-signals=true"
                 )
             elif self.codec.upper() == "H264":
                 pipeline_str = (
-                    f"udpsrc port={self.transport_port} "
-                    f"! application/x-rtp,media=video,encoding-name=H264 "
+                    f"{source} "
+                    f"! application/x-rtp,media=video,clock-rate=90000,encoding-name=H264 "
+                    f"{self._jitter_buffer()}"
                     f"! rtph264depay "
                     f"! h264parse "
-                    f"! avdec_h264 "
-                    f"! videoconvert "
-                    f"! video/x-raw,format=BGR "
+                    f"! avdec_h264 max-threads={self.decode_threads} "
+                    f"{self._convert()}"
+                    f"! appsink name=sink emit-signals=true"
+                )
+            elif self.codec.upper() == "OPUS":
+                # PLC keeps the sample count continuous across losses and DTX
+                # gaps, which the ASRC FIFO downstream depends on
+                pipeline_str = (
+                    f"{source} "
+                    f"! application/x-rtp,media=audio,clock-rate=48000,encoding-name=OPUS "
+                    f"{self._jitter_buffer()}"
+                    f"! rtpopusdepay "
+                    f"! opusdec plc=true "
+                    f"! audioconvert "
+                    f"! audio/x-raw,format=F32LE,rate=48000,channels=2,layout=interleaved "
                     f"! appsink name=sink emit-signals=true"
                 )
             else:
@@ -73,9 +101,13 @@ class GStreamerRTPReceiver:
             # Get appsink and connect signal
             appsink = self.pipeline.get_by_name("sink")
             appsink.connect("new-sample", self._on_new_sample)
+            if self.use_appsrc:
+                self.appsrc = self.pipeline.get_by_name("src")
+                self.jitterbuffer = self.pipeline.get_by_name("jitter")
             
             # Start pipeline
             self.pipeline.set_state(Gst.State.PLAYING)
+            self._base_time = time.time()
             self.is_running = True
             
             logger.info(f"✅ GStreamer RTP receiver started for {self.stream_id}")
@@ -85,6 +117,52 @@ class GStreamerRTPReceiver:
             logger.error(f"Failed to start GStreamer receiver: {e}")
             return False
     
+    def _source_element(self) -> str:
+        """RTP source: our own UDP socket or packets pushed by the caller"""
+        if self.use_appsrc:
+            # Buffers carry the packet arrival time we stamp in push_rtp
+            return "appsrc name=src is-live=true format=time do-timestamp=false"
+        return f"udpsrc port={self.transport_port}"
+    
+    def _convert(self) -> str:
+        """Threaded conversion straight to BGRA, which NDI sends without another pass"""
+        return f"! videoconvert n-threads={self.decode_threads} ! video/x-raw,format=BGRA "
+    
+    def _jitter_buffer(self) -> str:
+        """Reorder pushed packets; udpsrc pipelines keep their old behaviour"""
+        return "! rtpjitterbuffer name=jitter latency=50 drop-on-latency=true " if self.use_appsrc else ""
+    
+    def set_latency(self, latency_ms: int):
+        """
+        Retune the jitter buffer
+        
+        Args:
+            latency_ms: Jitter buffer latency in milliseconds
+        """
+        if self.jitterbuffer:
+            self.jitterbuffer.set_property("latency", int(latency_ms))
+    
+    def push_rtp(self, data: bytes, arrival: Optional[float] = None) -> bool:
+        """
+        Push one RTP packet into an appsrc pipeline
+        
+        Args:
+            data: Raw RTP packet
+            arrival: Wall-clock arrival time, preferably the kernel receive
+                timestamp; the jitter buffer reads it as the buffer DTS
+            
+        Returns:
+            bool: True if the packet was accepted
+        """
+        if not self.appsrc or not self.is_running:
+            return False
+        buffer = Gst.Buffer.new_wrapped(bytes(data))
+        running_time = max(0, int(((arrival or time.time()) - self._base_time) * Gst.SECOND))
+        buffer.dts = running_time
+        buffer.pts = running_time
+        result = self.appsrc.emit("push-buffer", buffer)
+        return result == Gst.FlowReturn.OK
+    
     def _on_new_sample(self, appsink):
         """Callback for new video sample"""
         try:
@@ -95,6 +173,9 @@ class GStreamerRTPReceiver:
                 
                 # Extract frame dimensions
                 structure = caps.get_structure(0)
+                if structure.get_name().startswith("audio/"):
+                    self._forward_audio(buffer, structure.get_value("channels"))
+                    return Gst.FlowReturn.OK
                 width = structure.get_value("width")
                 height = structure.get_value("height")
                 
@@ -103,7 +184,7 @@ class GStreamerRTPReceiver:
                 if success:
                     # Convert to numpy array
                     frame_data = np.ndarray(
-                        shape=(height, width, 3),
+                        shape=(height, width, 4),
                         dtype=np.uint8,
                         buffer=map_info.data
                     )
@@ -119,12 +200,25 @@ class GStreamerRTPReceiver:
         
         return Gst.FlowReturn.OK
     
+    def _forward_audio(self, buffer, channels: int):
+        """Hand decoded interleaved float samples on as (frames, channels)"""
+        success, map_info = buffer.map(Gst.MapFlags.READ)
+        if not success:
+            return
+        try:
+            samples = np.frombuffer(map_info.data, dtype=np.float32).reshape(-1, channels)
+            if self.on_frame:
+                self.on_frame(samples.copy())
+        finally:
+            buffer.unmap(map_info)
+    
     async def stop(self):
         """Stop GStreamer pipeline"""
         try:
             if self.pipeline:
                 self.pipeline.set_state(Gst.State.NULL)
                 self.pipeline = None
+                self.appsrc = None
             
             self.is_running = False
             logger.info(f"GStreamer receiver stopped for {self.stream_id}")
@@ -0,0 +1,132 @@
+"""
+Layer Selector - Picks simulcast/SVC layers to match NDI output resolution
+"""
+
+import logging
+import re
+from dataclasses import dataclass
+from typing import List, Optional, Tuple
+
+logger = logging.getLogger(__name__)
+
+SCALABILITY_MODE_RE = re.compile(r"^[LS](\d+)T(\d+)")
+
+
+@dataclass(frozen=True)
+class LayerChoice:
+    """
+    Preferred layers for a mediasoup consumer
+    """
+    spatial_layer: int
+    temporal_layer: int
+    width: int
+    height: int
+    fps: float
+
+
+def parse_scalability_mode(mode: Optional[str]) -> Tuple[int, int]:
+    """
+    Parse a scalability mode such as "L3T3", "S2T3" or "L1T3_KEY"
+
+    Args:
+        mode: Scalability mode string
+
+    Returns:
+        tuple: (spatial layer count, temporal layer count)
+    """
+    match = SCALABILITY_MODE_RE.match(mode or "")
+    if not match:
+        return 1, 1
+    return int(match.group(1)), int(match.group(2))
+
+
+class LayerSelector:
+    """
+    Chooses the smallest spatial and temporal layer of a simulcast or SVC
+    consumer that still meets the NDI output resolution and frame rate,
+    and the top layers while the source is on program.
+    """
+
+    def __init__(
+        self,
+        source_width: int,
+        source_height: int,
+        source_fps: float,
+        scalability_mode: Optional[str] = None,
+        producer_encodings: Optional[List[dict]] = None
+    ):
+        """
+        Initialize layer selector
+
+        Args:
+            source_width: Width of the top spatial layer
+            source_height: Height of the top spatial layer
+            source_fps: Frame rate of the top temporal layer
+            scalability_mode: Consumer encoding scalability mode
+            producer_encodings: Producer encodings (simulcast scale factors)
+        """
+        self.spatial_layers, self.temporal_layers = parse_scalability_mode(scalability_mode)
+        self.source_fps = source_fps
+
+        # Resolution of each spatial layer, lowest first
+        scales = self._spatial_scales(producer_encodings or [])
+        self.layer_sizes = [
+            (int(source_width / scale), int(source_height / scale)) for scale in scales
+        ]
+
+    @property
+    def has_layers(self) -> bool:
+        """True if the consumer offers more than one layer to choose from"""
+        return self.spatial_layers > 1 or self.temporal_layers > 1
+
+    def top(self) -> LayerChoice:
+        """Highest spatial and temporal layer"""
+        width, height = self.layer_sizes[-1]
+        return LayerChoice(self.spatial_layers - 1, self.temporal_layers - 1, width, height, self.source_fps)
+
+    def select(self, target_width: int, target_height: int, target_fps: float,
+               on_program: bool = False) -> LayerChoice:
+        """
+        Select the cheapest layers meeting the target output
+
+        Args:
+            target_width: NDI output width
+            target_height: NDI output height
+            target_fps: NDI output frame rate
+            on_program: Source is on program, always take the top layers
+
+        Returns:
+            LayerChoice: Preferred layers
+        """
+        if on_program:
+            return self.top()
+
+        spatial = self.spatial_layers - 1
+        for index, (width, height) in enumerate(self.layer_sizes):
+            if width >= target_width and height >= target_height:
+                spatial = index
+                break
+
+        temporal = self.temporal_layers - 1
+        for index in range(self.temporal_layers):
+            if self._layer_fps(index) >= target_fps - 0.5:
+                temporal = index
+                break
+
+        width, height = self.layer_sizes[spatial]
+        return LayerChoice(spatial, temporal, width, height, self._layer_fps(temporal))
+
+    def _layer_fps(self, temporal_layer: int) -> float:
+        # Each temporal layer doubles the frame rate of the one below
+        return self.source_fps / (2 ** (self.temporal_layers - 1 - temporal_layer))
+
+    def _spatial_scales(self, producer_encodings: List[dict]) -> List[float]:
+        """Downscale factor of each spatial layer, lowest layer first"""
+        scales = [
+            float(encoding.get("scaleResolutionDownBy") or 0)
+            for encoding in producer_encodings
+        ]
+        if len(scales) == self.spatial_layers and all(scale > 0 for scale in scales):
+            return sorted(scales, reverse=True)
+        # SVC and simulcast without explicit factors halve resolution per layer
+        return [2.0 ** (self.spatial_layers - 1 - index) for index in range(self.spatial_layers)]
@@ -0,0 +1,611 @@
+"""
+Native RTP Receiver - Receives RTP from a Mediasoup PlainTransport on our own
+UDP socket and sends RTCP receiver feedback (RR + REMB) upstream
+"""
+
+import asyncio
+import logging
+import random
+import socket
+import threading
+import time
+from typing import TYPE_CHECKING, Callable, Optional, Tuple
+
+import numpy as np
+
+from webrtc.congestion import BitrateController
+from webrtc.fec import FecDecoder
+from webrtc.gop_cache import GopCache
+from webrtc.rtp_socket import BusyPollReader, open_rtp_socket, receive_datagram
+from webrtc.rtp_packet import (
+    RtpPacket, build_empty_receiver_report, build_receiver_report, build_remb,
+    is_rtcp, parse_sender_report_ntp
+)
+from utils.metrics import (
+    record_fec_recovery, record_frame_interarrival, record_jitter_buffer_latency, record_receiver_feedback,
+    record_rtp_error, record_rtp_packet, record_wakeup_latency
+)
+
+if TYPE_CHECKING:
+    # Only loaded (by the consumer) when AF_XDP ingest is enabled
+    from webrtc.xdp_socket import XdpPacketSource
+
+logger = logging.getLogger(__name__)
+
+# Jitter buffer latency follows the measured network jitter within these bounds
+JITTER_BUFFER_MIN_MS = 20
+JITTER_BUFFER_MAX_MS = 250
+JITTER_BUFFER_JITTER_FACTOR = 4
+
+
+def _signed32(value: int) -> int:
+    value &= 0xFFFFFFFF
+    return value - 0x100000000 if value & 0x80000000 else value
+
+
+class ReceptionStats:
+    """
+    Per-source reception statistics as described in RFC 3550 appendix A
+    """
+
+    def __init__(self, clock_rate: int = 90000):
+        self.clock_rate = clock_rate
+        self.base_seq: Optional[int] = None
+        self.max_seq = 0
+        self.cycles = 0
+        self.received = 0
+        self.bytes_received = 0
+        self.expected_prior = 0
+        self.received_prior = 0
+        self.jitter = 0.0  # RTP timestamp units
+        self._last_arrival: Optional[float] = None
+        self._last_timestamp = 0
+        self._frame_arrival: Optional[float] = None
+        self._frame_timestamp = 0
+
+    def update(self, packet: RtpPacket, arrival: float, size: int) -> Optional[float]:
+        """
+        Account for one received packet
+
+        Args:
+            packet: Parsed RTP packet
+            arrival: Arrival time in seconds, ideally the kernel receive timestamp
+            size: Datagram size in bytes
+
+        Returns:
+            float: Seconds since the previous frame's first packet when this
+            packet starts a newer frame, else None
+        """
+        seq = packet.sequence_number
+        if self.base_seq is None:
+            self.base_seq = seq
+            self.max_seq = seq
+        else:
+            delta = (seq - self.max_seq) & 0xFFFF
+            if 0 < delta < 0x8000:
+                if seq < self.max_seq:
+                    self.cycles += 0x10000
+                self.max_seq = seq
+            # Otherwise duplicate or late packet, still counts as received
+
+        self.received += 1
+        self.bytes_received += size
+
+        # Interarrival jitter (RFC 3550 A.8)
+        arrival_ts = arrival * self.clock_rate
+        if self._last_arrival is not None:
+            d = (arrival_ts - self._last_arrival) - _signed32(packet.timestamp - self._last_timestamp)
+            self.jitter += (abs(d) - self.jitter) / 16.0
+        self._last_arrival = arrival_ts
+        self._last_timestamp = packet.timestamp
+
+        frame_interarrival = None
+        if self._frame_arrival is None or _signed32(packet.timestamp - self._frame_timestamp) > 0:
+            if self._frame_arrival is not None:
+                frame_interarrival = arrival - self._frame_arrival
+            self._frame_arrival = arrival
+            self._frame_timestamp = packet.timestamp
+        return frame_interarrival
+
+    @property
+    def extended_highest_sequence(self) -> int:
+        return self.cycles + self.max_seq
+
+    @property
+    def expected(self) -> int:
+        if self.base_seq is None:
+            return 0
+        return self.extended_highest_sequence - self.base_seq + 1
+
+    @property
+    def cumulative_lost(self) -> int:
+        return self.expected - self.received
+
+    @property
+    def jitter_ms(self) -> float:
+        return self.jitter * 1000.0 / self.clock_rate
+
+    def interval_report(self) -> Tuple[float, int]:
+        """
+        Loss since the previous call (RFC 3550 A.3)
+
+        Returns:
+            tuple: (fraction lost 0..1, fraction lost as 8-bit fixed point)
+        """
+        expected = self.expected
+        expected_interval = expected - self.expected_prior
+        received_interval = self.received - self.received_prior
+        self.expected_prior = expected
+        self.received_prior = self.received
+
+        lost_interval = expected_interval - received_interval
+        if expected_interval <= 0 or lost_interval <= 0:
+            return 0.0, 0
+        fraction = lost_interval / expected_interval
+        return fraction, min(255, (lost_interval << 8) // expected_interval)
+
+
+class NativeRTPReceiver:
+    """
+    Receives RTP on a local UDP socket, hands packets to a GStreamer appsrc
+    decoder and reports loss, jitter and a REMB bitrate estimate back to
+    the PlainTransport
+    """
+
+    def __init__(
+        self,
+        stream_id: str,
+        transport_ip: str,
+        transport_port: int,
+        codec: str = "VP8",
+        clock_rate: int = 90000,
+        on_frame: Optional[Callable[[np.ndarray], None]] = None,
+        on_bitrate: Optional[Callable[[int], None]] = None,
+        cpu_load: Optional[Callable[[], float]] = None,
+        controller: Optional[BitrateController] = None,
+        feedback_interval: float = 1.0,
+        fec: Optional[FecDecoder] = None,
+        packet_source: Optional["XdpPacketSource"] = None,
+        busy_poller: Optional[BusyPollReader] = None,
+        decode_threads: int = 0,
+        on_packet_timing: Optional[Callable[[int, float], None]] = None
+    ):
+        """
+        Initialize native RTP receiver
+
+        Args:
+            stream_id: Stream identifier
+            transport_ip: PlainTransport IP
+            transport_port: PlainTransport port (RTP and RTCP muxed)
+            codec: Video codec name
+            clock_rate: RTP clock rate of the codec
+            on_frame: Callback for decoded frames
+            on_bitrate: Callback when the bitrate estimate changes noticeably
+            cpu_load: Returns the used share of the bridge CPU budget
+            controller: Bitrate controller (defaults to BitrateController())
+            feedback_interval: Seconds between RTCP feedback packets
+            fec: RED/ULPFEC/FlexFEC decoder when FEC was negotiated
+            packet_source: AF_XDP ingest to take media from instead of the UDP socket
+            busy_poller: Spinning reader thread to read the socket on instead of the event loop
+            decode_threads: Decoder threads, 0 for one per CPU
+            on_packet_timing: Called with (RTP timestamp, arrival) of every media
+                packet, for audio clock recovery
+        """
+        self.stream_id = stream_id
+        self.transport_ip = transport_ip
+        self.transport_port = transport_port
+        self.codec = codec
+        self.on_frame = on_frame
+        self.on_bitrate = on_bitrate
+        self.cpu_load = cpu_load
+        self.controller = controller or BitrateController()
+        self.feedback_interval = feedback_interval
+        self.fec = fec
+        self.packet_source = packet_source
+        self.busy_poller = busy_poller
+        self.decode_threads = decode_threads
+        self.on_packet_timing = on_packet_timing
+
+        self.ssrc = random.getrandbits(32)
+        self.media_ssrc: Optional[int] = None
+        self.reception = ReceptionStats(clock_rate)
+        self.gop_cache = GopCache(codec)
+        self.decoder = None
+        self.decoder_subscription: Optional[int] = None
+        self.decoding_suspended = False
+        self.sock: Optional[socket.socket] = None
+        # Packets may arrive on the busy-poll thread while the loop sends feedback
+        self._lock = threading.Lock()
+        self.feedback_task: Optional[asyncio.Task] = None
+        # Loop that on_frame runs on; decoded frames come in on GStreamer's thread
+        self._loop: Optional[asyncio.AbstractEventLoop] = None
+        self.is_running = False
+
+        # Last SR from the sender, for round-trip time in the RR
+        self._last_sr = 0
+        self._last_sr_arrival: Optional[float] = None
+        self._last_reported_bitrate: Optional[int] = None
+        self._last_feedback_time: Optional[float] = None
+        self._last_feedback_bytes = 0
+        self._reported_fec = {"recovered": 0, "unrecovered": 0}
+        self._packet_arrival: Optional[float] = None  # arrival of the packet being handled
+        # Frames of the replayed GOP still to come out of the decoder; they
+        # only bring it to the live edge and are not sent on
+        self._replayed_frames = 0
+        self._max_frame_interarrival = 0.0
+
+        self.stats = {
+            "packets_received": 0,
+            "rtcp_received": 0,
+            "malformed_packets": 0,
+            "fraction_lost": 0.0,
+            "jitter_ms": 0.0,
+            "incoming_bitrate": 0.0,
+            "bitrate_estimate": int(self.controller.bitrate),
+            "timestamp_source": "user",
+            "frame_interarrival_max_ms": 0.0,
+            "jitter_buffer_ms": None,
+            "replayed_frames_dropped": 0
+        }
+
+    async def start(self) -> bool:
+        """
+        Open the socket, start the decoder and announce ourselves to the transport
+
+        Returns:
+            bool: True if started successfully
+        """
+        try:
+            self._loop = asyncio.get_running_loop()
+            if not await self.resume_decoding():
+                logger.warning(f"No decoder available for native receiver {self.stream_id}")
+                return False
+
+            if self.busy_poller:
+                self.sock = open_rtp_socket(busy_poll_us=50, busy_poll_budget=64)
+                self.busy_poller.register(self.sock, self._on_datagram)
+            else:
+                self.sock = open_rtp_socket()
+                asyncio.get_running_loop().add_reader(self.sock.fileno(), self._read_socket)
+            self.is_running = True
+
+            # Steered packets bypass the socket; it still sends RTCP and gets
+            # anything the XDP program passes up the stack
+            if self.packet_source:
+                self.packet_source.register((self.transport_ip, self.transport_port), self._on_datagram)
+
+            # comedia: the transport only sends once it has heard from us
+            self._send_rtcp(build_empty_receiver_report(self.ssrc))
+            self.feedback_task = asyncio.create_task(self._feedback_loop())
+
+            local_port = self.sock.getsockname()[1]
+            logger.info(
+                f"✅ Native RTP receiver for {self.stream_id} on port {local_port} "
+                f"-> {self.transport_ip}:{self.transport_port}"
+            )
+            return True
+
+        except Exception as e:
+            logger.error(f"Failed to start native RTP receiver for {self.stream_id}: {e}")
+            await self.stop()
+            return False
+
+    def _create_decoder(self):
+        """GStreamer pipeline fed through appsrc"""
+        try:
+            from webrtc.gstreamer_receiver import GStreamerRTPReceiver
+        except Exception as e:
+            logger.warning(f"GStreamer not available for decoding: {e}")
+            return None
+
+        return GStreamerRTPReceiver(
+            stream_id=self.stream_id,
+            transport_ip=self.transport_ip,
+            transport_port=self.transport_port,
+            codec=self.codec,
+            on_frame=self._on_decoded,
+            use_appsrc=True,
+            decode_threads=self.decode_threads
+        )
+
+    def _read_socket(self):
+        """Drain the socket from the event loop"""
+        for _ in range(64):
+            try:
+                data, addr, arrival = receive_datagram(self.sock)
+            except (BlockingIOError, OSError):
+                return
+            if arrival is not None:
+                record_wakeup_latency("udp", time.time() - arrival)
+            self._on_datagram(data, addr, arrival)
+
+    def _on_datagram(self, data: bytes, addr=None, kernel_arrival: Optional[float] = None):
+        """
+        Handle one datagram from the transport
+
+        With AF_XDP ingest data is a view of a UMEM frame that is recycled
+        after this returns; anything kept must be copied.
+
+        Args:
+            data: Datagram
+            addr: Source address
+            kernel_arrival: Kernel receive time (CLOCK_REALTIME), if known
+        """
+        # Kernel timestamps keep scheduler and wake-up delay out of the
+        # jitter estimate; time.time() shares their clock as a fallback
+        if kernel_arrival is not None:
+            arrival = kernel_arrival
+            self.stats["timestamp_source"] = "kernel"
+        else:
+            arrival = time.time()
+
+        with self._lock:
+            self._packet_arrival = arrival
+            try:
+                self._handle_datagram(data, arrival)
+            finally:
+                self._packet_arrival = None
+
+    def _handle_datagram(self, data: bytes, arrival: float):
+        """Account, recover and cache one datagram; called with the lock held"""
+        if is_rtcp(data):
+            self.stats["rtcp_received"] += 1
+            lsr = parse_sender_report_ntp(data)
+            if lsr is not None:
+                self._last_sr = lsr
+                self._last_sr_arrival = time.monotonic()
+            return
+
+        packet = RtpPacket.parse(data)
+        if packet is None:
+            self.stats["malformed_packets"] += 1
+            record_rtp_error(self.stream_id, "malformed")
+            return
+
+        if self.fec is None:
+            self._account(packet, arrival, len(data))
+            self.gop_cache.add(packet, data)
+            return
+
+        # Loss statistics describe the media SSRC only, before recovery
+        if not self.fec.is_fec_stream(packet):
+            self._account(packet, arrival, len(data))
+        for media in self.fec.process(packet):
+            self.gop_cache.add(media)
+
+    def _account(self, packet: RtpPacket, arrival: float, size: int):
+        self.media_ssrc = packet.ssrc
+        frame_interarrival = self.reception.update(packet, arrival, size)
+        if frame_interarrival is not None:
+            self._max_frame_interarrival = max(self._max_frame_interarrival, frame_interarrival)
+            record_frame_interarrival(self.stream_id, frame_interarrival)
+        self.stats["packets_received"] += 1
+        record_rtp_packet(self.stream_id)
+        if self.on_packet_timing:
+            self.on_packet_timing(packet.timestamp, arrival)
+
+    def attach(self, callback: Callable[[bytes], None]) -> int:
+        """
+        Attach a packet consumer (scaler, replay, switcher)
+
+        The consumer first gets every packet since the last keyframe, so it
+        can decode to the live edge at once, then follows live packets.
+
+        Args:
+            callback: Receives RTP packets in wire format
+
+        Returns:
+            int: Subscription id for detach()
+        """
+        with self._lock:
+            return self.gop_cache.attach(callback)
+
+    def detach(self, subscription: int):
+        """Detach a packet consumer"""
+        with self._lock:
+            self.gop_cache.detach(subscription)
+
+    def _on_decoded(self, frame: np.ndarray):
+        """Decoder output; called on the decoder's streaming thread"""
+        if self._replayed_frames > 0:
+            self._replayed_frames -= 1
+            self.stats["replayed_frames_dropped"] += 1
+            return
+        if not self.on_frame or self._loop is None or self._loop.is_closed():
+            return
+        # on_frame schedules pipeline work, which needs the event loop's thread
+        self._loop.call_soon_threadsafe(self._deliver_frame, frame)
+
+    def _deliver_frame(self, frame: np.ndarray):
+        """Hand a decoded frame to on_frame on the event loop"""
+        if self.is_running and self.on_frame:
+            self.on_frame(frame)
+
+    async def suspend_decoding(self):
+        """Stop decoding to save CPU; packets keep flowing into the GOP cache"""
+        if self.decoder is None:
+            return
+        self.detach(self.decoder_subscription)
+        await self.decoder.stop()
+        self.decoder = None
+        self.decoder_subscription = None
+        self.decoding_suspended = True
+        logger.info(f"⏸️ Decoding suspended for {self.stream_id}")
+
+    async def resume_decoding(self) -> bool:
+        """
+        Start a decoder primed from the GOP cache, no keyframe request needed
+
+        Returns:
+            bool: True if a decoder is running
+        """
+        if self.decoder is not None:
+            return True
+
+        decoder = self._create_decoder()
+        if decoder is None or not await decoder.start():
+            return False
+
+        self.decoder = decoder
+        # Live packets carry their arrival time into the jitter buffer; the
+        # replayed GOP is stamped on push. Its frames are stale by up to a
+        # GOP, so they are decoded for reference but not output
+        with self._lock:
+            self._replayed_frames = self.gop_cache.frame_count()
+            self.decoder_subscription = self.gop_cache.attach(
+                lambda data: decoder.push_rtp(data, self._packet_arrival)
+            )
+        if self.decoding_suspended:
+            logger.info(f"▶️ Decoding resumed for {self.stream_id} from {len(self.gop_cache.packets)} cached packets")
+        self.decoding_suspended = False
+        return True
+
+    async def _feedback_loop(self):
+        """Send RR + REMB every feedback interval"""
+        while self.is_running:
+            try:
+                await asyncio.sleep(self.feedback_interval)
+                self.send_feedback()
+            except asyncio.CancelledError:
+                break
+            except Exception as e:
+                logger.error(f"Error sending RTCP feedback for {self.stream_id}: {e}")
+
+    def send_feedback(self) -> Optional[int]:
+        """
+        Update the bitrate estimate and send it upstream
+
+        Returns:
+            int: Current bitrate estimate, None if no media has arrived yet
+        """
+        if self.media_ssrc is None:
+            # Keep knocking until the comedia transport starts sending
+            self._send_rtcp(build_empty_receiver_report(self.ssrc))
+            return None
+
+        now = time.monotonic()
+        with self._lock:
+            fraction_lost, fraction_fixed = self.reception.interval_report()
+            jitter_ms = self.reception.jitter_ms
+            jitter = int(self.reception.jitter)
+            cumulative_lost = self.reception.cumulative_lost
+            extended_highest_sequence = self.reception.extended_highest_sequence
+            bytes_received = self.reception.bytes_received
+            max_frame_interarrival = self._max_frame_interarrival
+            self._max_frame_interarrival = 0.0
+
+        incoming_bitrate = None
+        if self._last_feedback_time is not None and now > self._last_feedback_time:
+            delta_bytes = bytes_received - self._last_feedback_bytes
+            incoming_bitrate = delta_bytes * 8 / (now - self._last_feedback_time)
+        self._last_feedback_time = now
+        self._last_feedback_bytes = bytes_received
+
+        cpu_load = self.cpu_load() if self.cpu_load else 0.0
+        bitrate = self.controller.update(fraction_lost, jitter_ms, incoming_bitrate, cpu_load)
+
+        delay_since_last_sr = 0
+        if self._last_sr_arrival is not None:
+            delay_since_last_sr = int((now - self._last_sr_arrival) * 65536)
+
+        report = build_receiver_report(
+            sender_ssrc=self.ssrc,
+            media_ssrc=self.media_ssrc,
+            fraction_lost=fraction_fixed,
+            cumulative_lost=cumulative_lost,
+            extended_highest_sequence=extended_highest_sequence,
+            jitter=jitter,
+            last_sr=self._last_sr,
+            delay_since_last_sr=delay_since_last_sr
+        )
+        self._send_rtcp(report + build_remb(self.ssrc, bitrate, [self.media_ssrc]))
+
+        self.stats.update({
+            "fraction_lost": fraction_lost,
+            "jitter_ms": jitter_ms,
+            "incoming_bitrate": incoming_bitrate or 0.0,
+            "bitrate_estimate": bitrate,
+            "frame_interarrival_max_ms": max_frame_interarrival * 1000.0
+        })
+        record_receiver_feedback(self.stream_id, fraction_lost, jitter_ms / 1000.0, bitrate)
+        self._tune_jitter_buffer(jitter_ms)
+        if self.fec:
+            self._record_fec()
+
+        # Only bother the backend when the estimate moved by 10% or more
+        last = self._last_reported_bitrate
+        if self.on_bitrate and (last is None or abs(bitrate - last) >= 0.1 * last):
+            self._last_reported_bitrate = bitrate
+            self.on_bitrate(bitrate)
+
+        return bitrate
+
+    def _tune_jitter_buffer(self, jitter_ms: float):
+        """Size the decoder's jitter buffer from the measured network jitter"""
+        if self.decoder is None or not hasattr(self.decoder, "set_latency"):
+            return
+
+        target = int(min(JITTER_BUFFER_MAX_MS, max(
+            JITTER_BUFFER_MIN_MS, JITTER_BUFFER_MIN_MS + JITTER_BUFFER_JITTER_FACTOR * jitter_ms
+        )))
+        current = self.stats["jitter_buffer_ms"]
+        if current is None or abs(target - current) >= 5:
+            self.decoder.set_latency(target)
+            self.stats["jitter_buffer_ms"] = target
+            record_jitter_buffer_latency(self.stream_id, target / 1000.0)
+
+    def _record_fec(self):
+        """Export recovered/unrecovered counts since the last report"""
+        fec_stats = self.fec.get_stats()
+        recovered = fec_stats["recovered"] - self._reported_fec["recovered"]
+        unrecovered = fec_stats["unrecovered"] - self._reported_fec["unrecovered"]
+        self._reported_fec = {"recovered": fec_stats["recovered"], "unrecovered": fec_stats["unrecovered"]}
+        record_fec_recovery(self.stream_id, recovered, unrecovered)
+
+    def _send_rtcp(self, data: bytes):
+        if self.sock:
+            try:
+                self.sock.sendto(data, (self.transport_ip, self.transport_port))
+            except (BlockingIOError, OSError) as e:
+                logger.debug(f"RTCP send failed for {self.stream_id}: {e}")
+
+    def get_stats(self) -> dict:
+        """Get receiver statistics"""
+        return {
+            **self.stats,
+            "cumulative_lost": self.reception.cumulative_lost,
+            "bytes_received": self.reception.bytes_received,
+            "controller": self.controller.get_stats(),
+            "fec": self.fec.get_stats() if self.fec else None,
+            "gop_cache": self.gop_cache.get_stats(),
+            "decoding_suspended": self.decoding_suspended
+        }
+
+    async def stop(self):
+        """Stop receiving and close the socket"""
+        self.is_running = False
+
+        if self.packet_source:
+            self.packet_source.unregister((self.transport_ip, self.transport_port))
+
+        if self.feedback_task:
+            self.feedback_task.cancel()
+            self.feedback_task = None
+
+        if self.sock:
+            if self.busy_poller:
+                self.busy_poller.unregister(self.sock)
+            else:
+                try:
+                    asyncio.get_running_loop().remove_reader(self.sock.fileno())
+                except RuntimeError:
+                    pass
+            self.sock.close()
+            self.sock = None
+
+        if self.decoder:
+            self.detach(self.decoder_subscription)
+            await self.decoder.stop()
+            self.decoder = None
+
+        logger.info(f"Native RTP receiver stopped for {self.stream_id}")
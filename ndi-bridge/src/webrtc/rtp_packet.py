@@ -0,0 +1,256 @@
+"""
+RTP/RTCP packet helpers - Parsing RTP and building receiver feedback
+"""
+
+import struct
+from dataclasses import dataclass
+from typing import List, Optional
+
+RTP_VERSION = 2
+
+# RTCP packet types
+RTCP_SR = 200
+RTCP_RR = 201
+RTCP_SDES = 202
+RTCP_BYE = 203
+RTCP_RTPFB = 205
+RTCP_PSFB = 206
+
+# Payload-specific feedback formats
+PSFB_PLI = 1
+PSFB_FIR = 4
+PSFB_REMB = 15
+
+
+@dataclass
+class RtpPacket:
+    """
+    Parsed RTP packet (RFC 3550)
+    """
+    payload_type: int
+    sequence_number: int
+    timestamp: int
+    ssrc: int
+    marker: bool
+    payload: bytes
+    csrcs: List[int]
+    extension_profile: Optional[int] = None
+    extension: bytes = b""
+    padding: int = 0
+
+    @classmethod
+    def parse(cls, data: bytes) -> Optional["RtpPacket"]:
+        """
+        Parse an RTP packet
+
+        Args:
+            data: Raw datagram
+
+        Returns:
+            RtpPacket: Parsed packet or None if malformed
+        """
+        if len(data) < 12 or data[0] >> 6 != RTP_VERSION:
+            return None
+
+        first, second, sequence_number, timestamp, ssrc = struct.unpack_from("!BBHII", data)
+        csrc_count = first & 0x0F
+        offset = 12 + 4 * csrc_count
+        if len(data) < offset:
+            return None
+        csrcs = list(struct.unpack_from(f"!{csrc_count}I", data, 12)) if csrc_count else []
+
+        extension_profile = None
+        extension = b""
+        if first & 0x10:
+            if len(data) < offset + 4:
+                return None
+            extension_profile, length = struct.unpack_from("!HH", data, offset)
+            extension = data[offset + 4:offset + 4 + 4 * length]
+            offset += 4 + 4 * length
+
+        end = len(data)
+        padding = 0
+        if first & 0x20:
+            padding = data[-1]
+            end -= padding
+        if end < offset:
+            return None
+
+        return cls(
+            payload_type=second & 0x7F,
+            sequence_number=sequence_number,
+            timestamp=timestamp,
+            ssrc=ssrc,
+            marker=bool(second & 0x80),
+            payload=bytes(data[offset:end]),
+            csrcs=csrcs,
+            extension_profile=extension_profile,
+            extension=bytes(extension),
+            padding=padding
+        )
+
+    def serialize(self) -> bytes:
+        """Serialize back to wire format"""
+        first = (RTP_VERSION << 6) | len(self.csrcs)
+        if self.padding:
+            first |= 0x20
+        if self.extension_profile is not None:
+            first |= 0x10
+        second = (0x80 if self.marker else 0) | self.payload_type
+        header = struct.pack("!BBHII", first, second, self.sequence_number, self.timestamp, self.ssrc)
+        header += b"".join(struct.pack("!I", csrc) for csrc in self.csrcs)
+        if self.extension_profile is not None:
+            header += struct.pack("!HH", self.extension_profile, len(self.extension) // 4) + self.extension
+        padding = bytes(self.padding - 1) + bytes([self.padding]) if self.padding else b""
+        return header + self.payload + padding
+
+
+def is_rtcp(data: bytes) -> bool:
+    """
+    Tell RTCP from RTP on a muxed port (RFC 5761)
+
+    Args:
+        data: Raw datagram
+
+    Returns:
+        bool: True if the datagram is RTCP
+    """
+    return len(data) >= 2 and 192 <= data[1] <= 223
+
+
+def build_receiver_report(sender_ssrc: int, media_ssrc: int, fraction_lost: int, cumulative_lost: int,
+                          extended_highest_sequence: int, jitter: int, last_sr: int = 0,
+                          delay_since_last_sr: int = 0) -> bytes:
+    """
+    Build an RTCP receiver report with one report block
+
+    Args:
+        sender_ssrc: Our SSRC
+        media_ssrc: SSRC of the reported stream
+        fraction_lost: Loss since last report, 8-bit fixed point
+        cumulative_lost: Total packets lost
+        extended_highest_sequence: Highest sequence number with cycles
+        jitter: Interarrival jitter in RTP timestamp units
+        last_sr: Middle 32 bits of the last SR NTP timestamp
+        delay_since_last_sr: Delay since last SR in 1/65536 s
+
+    Returns:
+        bytes: RTCP RR packet
+    """
+    cumulative_lost = max(-0x800000, min(0x7FFFFF, cumulative_lost)) & 0xFFFFFF
+    header = struct.pack("!BBHI", (RTP_VERSION << 6) | 1, RTCP_RR, 7, sender_ssrc)
+    block = struct.pack(
+        "!IIIIII",
+        media_ssrc,
+        (fraction_lost & 0xFF) << 24 | cumulative_lost,
+        extended_highest_sequence & 0xFFFFFFFF,
+        jitter & 0xFFFFFFFF,
+        last_sr & 0xFFFFFFFF,
+        delay_since_last_sr & 0xFFFFFFFF
+    )
+    return header + block
+
+
+def build_empty_receiver_report(sender_ssrc: int) -> bytes:
+    """
+    Build an RTCP receiver report without report blocks
+
+    Sent before any media arrives so a comedia PlainTransport learns our
+    address and starts sending.
+
+    Args:
+        sender_ssrc: Our SSRC
+
+    Returns:
+        bytes: RTCP RR packet
+    """
+    return struct.pack("!BBHI", RTP_VERSION << 6, RTCP_RR, 1, sender_ssrc)
+
+
+def build_remb(sender_ssrc: int, bitrate: int, media_ssrcs: List[int]) -> bytes:
+    """
+    Build an RTCP REMB packet (draft-alvestrand-rmcat-remb)
+
+    Args:
+        sender_ssrc: Our SSRC
+        bitrate: Estimated maximum bitrate in bits per second
+        media_ssrcs: SSRCs the estimate applies to
+
+    Returns:
+        bytes: RTCP PSFB REMB packet
+    """
+    exponent = 0
+    mantissa = max(0, int(bitrate))
+    while mantissa > 0x3FFFF:
+        mantissa >>= 1
+        exponent += 1
+
+    body = b"REMB" + struct.pack(
+        "!BBH", len(media_ssrcs), (exponent << 2) | (mantissa >> 16), mantissa & 0xFFFF
+    )
+    body += b"".join(struct.pack("!I", ssrc) for ssrc in media_ssrcs)
+    length = (8 + len(body)) // 4  # in 32-bit words minus one, header is 12 bytes
+    return struct.pack("!BBHII", (RTP_VERSION << 6) | PSFB_REMB, RTCP_PSFB, length, sender_ssrc, 0) + body
+
+
+def build_pli(sender_ssrc: int, media_ssrc: int) -> bytes:
+    """
+    Build an RTCP picture loss indication
+
+    Args:
+        sender_ssrc: Our SSRC
+        media_ssrc: SSRC of the stream that needs a keyframe
+
+    Returns:
+        bytes: RTCP PSFB PLI packet
+    """
+    return struct.pack("!BBHII", (RTP_VERSION << 6) | PSFB_PLI, RTCP_PSFB, 2, sender_ssrc, media_ssrc)
+
+
+def parse_sender_report_ntp(data: bytes) -> Optional[int]:
+    """
+    Extract the middle 32 bits of the NTP timestamp from an RTCP SR
+
+    Args:
+        data: Compound RTCP packet
+
+    Returns:
+        int: LSR value for receiver reports, or None if no SR present
+    """
+    offset = 0
+    while offset + 4 <= len(data):
+        packet_type = data[offset + 1]
+        length = (struct.unpack_from("!H", data, offset + 2)[0] + 1) * 4
+        if packet_type == RTCP_SR and offset + 16 <= len(data):
+            ntp_msw, ntp_lsw = struct.unpack_from("!II", data, offset + 8)
+            return ((ntp_msw & 0xFFFF) << 16) | (ntp_lsw >> 16)
+        offset += length
+    return None
+
+
+def is_keyframe_request(data: bytes, media_ssrc: int) -> bool:
+    """
+    Tell whether compound RTCP asks a sender for a keyframe (PLI or FIR)
+
+    Args:
+        data: Compound RTCP packet
+        media_ssrc: SSRC of the stream we send
+
+    Returns:
+        bool: True if a PLI or FIR names our stream
+    """
+    offset = 0
+    while offset + 12 <= len(data):
+        fmt = data[offset] & 0x1F
+        packet_type = data[offset + 1]
+        length = (struct.unpack_from("!H", data, offset + 2)[0] + 1) * 4
+        if packet_type == RTCP_PSFB:
+            if fmt == PSFB_PLI and struct.unpack_from("!I", data, offset + 8)[0] == media_ssrc:
+                return True
+            if fmt == PSFB_FIR:
+                # FCI entries: SSRC, sequence number, 3 reserved bytes
+                for entry in range(offset + 12, min(offset + length, len(data)) - 7, 8):
+                    if struct.unpack_from("!I", data, entry)[0] == media_ssrc:
+                        return True
+        offset += length
+    return False
@@ -0,0 +1,199 @@
+"""
+RTP Sockets - UDP sockets with kernel receive timestamps and a busy-polling
+reader thread for latency-critical ingest
+"""
+
+import logging
+import os
+import select
+import socket
+import struct
+import threading
+import time
+from typing import Callable, Dict, Optional, Tuple
+
+from utils.metrics import record_wakeup_latency
+
+logger = logging.getLogger(__name__)
+
+# Linux socket options not exported by the socket module
+SO_TIMESTAMPNS = 35
+SCM_TIMESTAMPNS = SO_TIMESTAMPNS
+SO_BUSY_POLL = 46
+SO_PREFER_BUSY_POLL = 69
+SO_BUSY_POLL_BUDGET = 70
+
+_TIMESPEC = struct.Struct("@qq")
+_ANCILLARY_SIZE = socket.CMSG_SPACE(_TIMESPEC.size)
+MAX_DATAGRAM = 2048
+
+
+def open_rtp_socket(busy_poll_us: int = 0, busy_poll_budget: int = 0) -> socket.socket:
+    """
+    Open a non-blocking UDP socket that reports kernel receive timestamps
+
+    Args:
+        busy_poll_us: SO_BUSY_POLL time in microseconds, 0 to leave interrupts alone
+        busy_poll_budget: Packets per busy-poll round, 0 for the kernel default
+
+    Returns:
+        socket.socket: Socket bound to an ephemeral port
+    """
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setblocking(False)
+    sock.setsockopt(socket.SOL_SOCKET, SO_TIMESTAMPNS, 1)
+
+    if busy_poll_us:
+        # Values above net.core.busy_read need CAP_NET_ADMIN; keep going without
+        options = [(SO_BUSY_POLL, busy_poll_us), (SO_PREFER_BUSY_POLL, 1)]
+        if busy_poll_budget:
+            options.append((SO_BUSY_POLL_BUDGET, busy_poll_budget))
+        for option, value in options:
+            try:
+                sock.setsockopt(socket.SOL_SOCKET, option, value)
+            except OSError as e:
+                logger.warning(f"Could not set socket option {option}={value}: {e}")
+
+    sock.bind(("0.0.0.0", 0))
+    return sock
+
+
+def receive_datagram(sock: socket.socket) -> Tuple[bytes, tuple, Optional[float]]:
+    """
+    Read one datagram with its kernel arrival time
+
+    Args:
+        sock: Socket opened with open_rtp_socket()
+
+    Returns:
+        tuple: (data, address, arrival as CLOCK_REALTIME seconds or None)
+
+    Raises:
+        BlockingIOError: When no datagram is queued
+    """
+    data, ancillary, _, addr = sock.recvmsg(MAX_DATAGRAM, _ANCILLARY_SIZE)
+    for level, kind, payload in ancillary:
+        if level == socket.SOL_SOCKET and kind == SCM_TIMESTAMPNS and len(payload) >= _TIMESPEC.size:
+            seconds, nanoseconds = _TIMESPEC.unpack_from(payload)
+            return data, addr, seconds + nanoseconds / 1e9
+    return data, addr, None
+
+
+class BusyPollReader:
+    """
+    Receive thread that spins on its sockets from a dedicated core.
+
+    After spin_budget_us without traffic it falls back to a blocking poll,
+    so an idle show does not burn the core. Handlers run on this thread.
+    """
+
+    def __init__(self, core: Optional[int] = None, spin_budget_us: int = 500):
+        """
+        Initialize busy-poll reader
+
+        Args:
+            core: CPU to pin the thread to, None to leave placement to the scheduler
+            spin_budget_us: Idle time spent spinning before blocking
+        """
+        self.core = core
+        self.spin_budget = spin_budget_us / 1e6
+
+        self.sockets: Dict[int, Tuple[socket.socket, Callable]] = {}
+        self._lock = threading.Lock()
+        self._changed = True
+        self.thread: Optional[threading.Thread] = None
+        self.running = False
+
+        self.stats = {
+            "packets": 0,
+            "spins": 0,
+            "blocks": 0
+        }
+
+    def start(self) -> bool:
+        """Start the receive thread"""
+        self.running = True
+        self.thread = threading.Thread(target=self._run, name="rtp-busy-poll", daemon=True)
+        self.thread.start()
+        logger.info(
+            f"✅ Busy-poll ingest on core {self.core if self.core is not None else 'any'} "
+            f"with {self.spin_budget * 1e6:.0f}µs spin budget"
+        )
+        return True
+
+    def register(self, sock: socket.socket, handler: Callable[[bytes, tuple, Optional[float]], None]):
+        """
+        Read a socket on the busy-poll thread
+
+        Args:
+            sock: Socket opened with open_rtp_socket()
+            handler: Called on the reader thread with (data, address, arrival)
+        """
+        with self._lock:
+            self.sockets[sock.fileno()] = (sock, handler)
+            self._changed = True
+
+    def unregister(self, sock: socket.socket):
+        """Stop reading a socket"""
+        with self._lock:
+            self.sockets.pop(sock.fileno(), None)
+            self._changed = True
+
+    def _run(self):
+        if self.core is not None:
+            try:
+                os.sched_setaffinity(0, {self.core})
+            except OSError as e:
+                logger.warning(f"Could not pin busy-poll thread to core {self.core}: {e}")
+
+        poller = select.poll()
+        sockets = []
+        idle_since = time.perf_counter()
+
+        while self.running:
+            if self._changed:
+                with self._lock:
+                    for fd, _ in sockets:
+                        poller.unregister(fd)
+                    sockets = [(fd, entry) for fd, entry in self.sockets.items()]
+                    for fd, _ in sockets:
+                        poller.register(fd, select.POLLIN)
+                    self._changed = False
+
+            received = False
+            for _, (sock, handler) in sockets:
+                while True:
+                    try:
+                        data, addr, arrival = receive_datagram(sock)
+                    except (BlockingIOError, OSError):
+                        break
+                    received = True
+                    self.stats["packets"] += 1
+                    if arrival is not None:
+                        record_wakeup_latency("busy_poll", time.time() - arrival)
+                    try:
+                        handler(data, addr, arrival)
+                    except Exception as e:
+                        logger.error(f"Error handling busy-poll packet from {addr}: {e}")
+
+            now = time.perf_counter()
+            if received:
+                idle_since = now
+            elif now - idle_since < self.spin_budget:
+                self.stats["spins"] += 1
+            else:
+                # Spin budget used up: sleep until traffic returns
+                self.stats["blocks"] += 1
+                poller.poll(100)
+                idle_since = time.perf_counter()
+
+    def get_stats(self) -> dict:
+        """Get reader statistics"""
+        return {**self.stats, "sockets": len(self.sockets), "core": self.core}
+
+    def stop(self):
+        """Stop the receive thread"""
+        self.running = False
+        if self.thread:
+            self.thread.join(timeout=1.0)
+            self.thread = None
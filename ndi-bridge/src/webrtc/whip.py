@@ -0,0 +1,226 @@
+"""
+WHIP Ingest - Lets phones and encoders publish straight to the bridge over
+WHIP (WebRTC-HTTP Ingestion Protocol, RFC 9725), without the SFU hop
+"""
+
+import asyncio
+import logging
+import re
+import time
+import uuid
+from datetime import datetime
+from typing import Dict, Iterable, List, Optional
+
+import numpy as np
+
+try:
+    from aiortc import RTCConfiguration, RTCPeerConnection, RTCSessionDescription
+    AIORTC_AVAILABLE = True
+except ImportError:
+    AIORTC_AVAILABLE = False
+
+logger = logging.getLogger(__name__)
+
+AUDIO_SCALE = 1.0 / 32768.0
+
+
+def whip_device_name(name: Optional[str], resource_id: str, taken: Iterable[str] = ()) -> str:
+    """
+    Device name of a WHIP publisher: the ?name= it sent, else WHIP_<id>
+
+    A name already in `taken` gets the resource id appended, so two
+    publishers never share an NDI source name.
+    """
+    name = re.sub(r"[^A-Za-z0-9 _.-]", "", name or "").strip()[:32]
+    if not name:
+        return f"WHIP_{resource_id[:6]}"
+    return f"{name}_{resource_id[:6]}" if name in taken else name
+
+
+class WhipSession:
+    """
+    One WHIP publisher: its peer connection and the tasks reading its tracks
+    """
+
+    def __init__(self, resource_id: str, device_name: str, pc):
+        self.resource_id = resource_id
+        self.stream_id = f"whip-{resource_id}"
+        self.device_name = device_name
+        self.pc = pc
+        self.answer_sdp = ""
+        self.tasks: List[asyncio.Task] = []
+        self.created_at = datetime.now()
+        self.stats = {"video_frames": 0, "audio_frames": 0}
+
+
+class WhipIngest:
+    """
+    WHIP endpoint backend.
+
+    A publisher POSTs its SDP offer; aiortc answers it, terminates
+    ICE/DTLS/SRTP, depacketizes and decodes, and every decoded frame is
+    pushed into a regular stream pipeline with its own NDI source, so
+    LUTs, overlays, the house clock and admission control all apply.
+    With no SFU in between there is one network hop and no PlainTransport
+    re-packetization. ICE uses host candidates only -- this is for a
+    single LAN -- so the answer is ready without a STUN round trip, and
+    trickle ICE is not offered.
+    """
+
+    def __init__(self, stream_manager):
+        """
+        Initialize WHIP ingest
+
+        Args:
+            stream_manager: StreamManager that owns the NDI outputs
+        """
+        self.stream_manager = stream_manager
+        self.sessions: Dict[str, WhipSession] = {}
+
+    async def publish(self, offer_sdp: str, name: Optional[str] = None) -> Optional[WhipSession]:
+        """
+        Accept a WHIP offer
+
+        Args:
+            offer_sdp: SDP offer from the POST body
+            name: Device name requested by the publisher
+
+        Returns:
+            WhipSession: Session with the SDP answer, None if the offer was not accepted
+        """
+        if not AIORTC_AVAILABLE:
+            logger.error("WHIP ingest needs aiortc")
+            return None
+        if len(self.sessions) >= self.stream_manager.max_streams:
+            logger.warning("Rejecting WHIP publisher: max_streams reached")
+            return None
+
+        resource_id = uuid.uuid4().hex[:12]
+        pc = RTCPeerConnection(RTCConfiguration(iceServers=[]))
+        taken = [s.device_name for s in self.sessions.values()] + [
+            stream.get("stream_info", {}).get("device_name") for stream in self.stream_manager.active_streams.values()
+        ]
+        session = WhipSession(resource_id, whip_device_name(name, resource_id, taken), pc)
+
+        @pc.on("track")
+        def on_track(track):
+            if track.kind == "video":
+                session.tasks.append(asyncio.create_task(self._receive_video(session, track)))
+            elif track.kind == "audio":
+                session.tasks.append(asyncio.create_task(self._receive_audio(session, track)))
+
+        @pc.on("connectionstatechange")
+        async def on_connection_state_change():
+            logger.info(f"WHIP {session.stream_id} connection {pc.connectionState}")
+            if pc.connectionState in ("failed", "closed"):
+                await self.delete(resource_id)
+
+        try:
+            await pc.setRemoteDescription(RTCSessionDescription(sdp=offer_sdp, type="offer"))
+            await pc.setLocalDescription(await pc.createAnswer())
+        except Exception as e:
+            logger.error(f"Invalid WHIP offer: {e}")
+            await pc.close()
+            return None
+
+        session.answer_sdp = pc.localDescription.sdp
+        self.sessions[resource_id] = session
+        logger.info(f"📥 WHIP publisher '{session.device_name}' -> {session.stream_id}")
+        return session
+
+    async def delete(self, resource_id: str) -> bool:
+        """
+        End a WHIP session (DELETE on its resource, or a dropped connection)
+
+        Args:
+            resource_id: Resource from the Location header
+
+        Returns:
+            bool: True if the session existed
+        """
+        session = self.sessions.pop(resource_id, None)
+        if session is None:
+            return False
+
+        for task in session.tasks:
+            task.cancel()
+        await asyncio.gather(*session.tasks, return_exceptions=True)
+        await session.pc.close()
+        if session.stream_id in self.stream_manager.active_streams:
+            await self.stream_manager.stop_stream(session.stream_id)
+        logger.info(f"WHIP session {session.stream_id} ended")
+        return True
+
+    async def close(self):
+        """End all sessions"""
+        for resource_id in list(self.sessions):
+            await self.delete(resource_id)
+
+    async def _receive_video(self, session: WhipSession, track):
+        """Decode video and feed the stream's pipeline, starting its NDI output on the first frame"""
+        loop = asyncio.get_running_loop()
+        try:
+            while True:
+                frame = await track.recv()
+                # Colour conversion runs in libswscale off the event loop
+                image = await loop.run_in_executor(None, lambda: frame.to_ndarray(format="bgra"))
+
+                pipeline = self.stream_manager.pipelines.get(session.stream_id)
+                if pipeline is None:
+                    if not await self.stream_manager.start_whip_stream(
+                        session.stream_id, session.device_name, image.shape[1], image.shape[0]
+                    ):
+                        asyncio.create_task(self.delete(session.resource_id))
+                        return
+                    pipeline = self.stream_manager.pipelines[session.stream_id]
+
+                await pipeline.add_frame(image)
+                session.stats["video_frames"] += 1
+
+        except asyncio.CancelledError:
+            raise
+        except Exception as e:
+            # MediaStreamError when the track ends
+            logger.info(f"WHIP video track of {session.stream_id} ended: {e}")
+
+    async def _receive_audio(self, session: WhipSession, track):
+        """Feed decoded Opus (48 kHz s16) into the stream's audio pipeline once it runs"""
+        try:
+            while True:
+                frame = await track.recv()
+                audio_pipeline = self.stream_manager.audio_pipelines.get(session.stream_id)
+                if audio_pipeline is None:
+                    continue
+                channels = len(frame.layout.channels)
+                samples = frame.to_ndarray().reshape(-1, channels).astype(np.float32) * AUDIO_SCALE
+                if frame.pts is not None:
+                    audio_pipeline.observe(frame.pts, time.time())
+                audio_pipeline.push(samples)
+                session.stats["audio_frames"] += 1
+
+        except asyncio.CancelledError:
+            raise
+        except Exception as e:
+            logger.info(f"WHIP audio track of {session.stream_id} ended: {e}")
+
+    def get_stats(self) -> dict:
+        """
+        Get WHIP session statistics
+
+        Returns:
+            dict: Sessions with their stream, device and counters
+        """
+        return {
+            "sessions": [
+                {
+                    "resource_id": session.resource_id,
+                    "stream_id": session.stream_id,
+                    "device_name": session.device_name,
+                    "connection_state": session.pc.connectionState,
+                    "created_at": session.created_at.isoformat(),
+                    **session.stats
+                }
+                for session in self.sessions.values()
+            ],
+            "total": len(self.sessions)
+        }
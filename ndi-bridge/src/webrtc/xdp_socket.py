@@ -0,0 +1,549 @@
+"""
+AF_XDP Receive Backend - Kernel-bypass RTP ingest for dense deployments
+
+An XDP program steers UDP packets whose source port lies in the mediasoup
+PlainTransport port range into an AF_XDP socket; everything else continues
+up the normal network stack. Received packets stay in their UMEM frame
+(the frame is the packet's arena slot) until the receiver callback has
+run, then the frame goes back to the fill ring.
+
+Everything is done with raw syscalls (no libbpf/libxdp, no clang), so the
+backend works on any kernel with AF_XDP and BPF links (5.9+) and can be
+exercised over a veth pair in generic (skb) mode without a special NIC.
+The rings are driven from Python without memory barriers, which is only
+correct on x86-64's total store order, so other architectures are refused.
+"""
+
+import asyncio
+import collections
+import ctypes
+import logging
+import mmap
+import os
+import platform
+import select
+import socket
+import struct
+import threading
+from typing import Callable, Dict, Optional, Tuple
+
+logger = logging.getLogger(__name__)
+
+AF_XDP = 44
+SOL_XDP = 283
+
+# setsockopt/getsockopt options (linux/if_xdp.h)
+XDP_MMAP_OFFSETS = 1
+XDP_RX_RING = 2
+XDP_UMEM_REG = 4
+XDP_UMEM_FILL_RING = 5
+XDP_UMEM_COMPLETION_RING = 6
+XDP_STATISTICS = 7
+
+XDP_COPY = 1 << 1
+XDP_PGOFF_RX_RING = 0
+XDP_UMEM_PGOFF_FILL_RING = 0x100000000
+
+# bpf() commands, map/program types and attach flags
+BPF_MAP_CREATE = 0
+BPF_MAP_UPDATE_ELEM = 2
+BPF_PROG_LOAD = 5
+BPF_LINK_CREATE = 28
+BPF_MAP_TYPE_XSKMAP = 17
+BPF_PROG_TYPE_XDP = 6
+BPF_XDP = 37
+BPF_FUNC_REDIRECT_MAP = 51
+XDP_FLAGS_SKB_MODE = 1 << 1
+XDP_FLAGS_DRV_MODE = 1 << 2
+XDP_PASS = 2
+
+# Ring index accesses rely on x86-64 ordering (see _Ring)
+SUPPORTED_MACHINES = ("x86_64", "AMD64")
+SYS_BPF = 321
+
+ETH_IPV4_UDP_HEADERS = 14 + 20 + 8
+
+_libc = ctypes.CDLL(None, use_errno=True)
+
+
+def _bpf(cmd: int, attr: bytes) -> int:
+    """Issue a bpf() syscall, raising OSError on failure"""
+    buffer = ctypes.create_string_buffer(attr, max(len(attr), 128))
+    result = _libc.syscall(SYS_BPF, cmd, buffer, len(buffer))
+    if result < 0:
+        errno = ctypes.get_errno()
+        raise OSError(errno, f"bpf({cmd}) failed: {os.strerror(errno)}")
+    return result
+
+
+def _insn(code: int, dst: int = 0, src: int = 0, off: int = 0, imm: int = 0) -> bytes:
+    return struct.pack("<BBhi", code, (src << 4) | dst, off, imm)
+
+
+def build_steering_program(xsks_map_fd: int, port_min: int, port_max: int) -> bytes:
+    """
+    Assemble the XDP steering program
+
+    Equivalent C:
+
+        if (eth->h_proto != htons(ETH_P_IP) || ip->ihl != 5 ||
+            ip->protocol != IPPROTO_UDP || ip->frag_off & htons(0x3fff))
+            return XDP_PASS;
+        port = ntohs(udp->source);
+        if (port < PORT_MIN || port > PORT_MAX)
+            return XDP_PASS;
+        return bpf_redirect_map(&xsks, ctx->rx_queue_index, XDP_PASS);
+
+    Args:
+        xsks_map_fd: XSKMAP file descriptor
+        port_min: Lowest PlainTransport port
+        port_max: Highest PlainTransport port
+
+    Returns:
+        bytes: eBPF instructions
+    """
+    program = []
+    jumps = []  # (index, label) of forward jumps to patch
+
+    def emit(code, dst=0, src=0, off=0, imm=0, label=None):
+        if label:
+            jumps.append((len(program), label))
+        program.append([code, dst, src, off, imm])
+
+    emit(0xbf, 6, 1)                       # r6 = ctx
+    emit(0x61, 2, 6, 0)                    # r2 = ctx->data
+    emit(0x61, 3, 6, 4)                    # r3 = ctx->data_end
+    emit(0xbf, 4, 2)                       # r4 = r2
+    emit(0x07, 4, imm=ETH_IPV4_UDP_HEADERS)  # r4 += 42
+    emit(0x2d, 4, 3, label="pass")         # if r4 > data_end goto pass
+    emit(0x69, 5, 2, 12)                   # r5 = eth->h_proto
+    emit(0x55, 5, imm=0x0008, label="pass")  # != htons(0x0800)
+    emit(0x71, 5, 2, 14)                   # r5 = version/ihl
+    emit(0x57, 5, imm=0x0F)
+    emit(0x55, 5, imm=5, label="pass")     # options present
+    emit(0x71, 5, 2, 23)                   # r5 = ip->protocol
+    emit(0x55, 5, imm=17, label="pass")    # not UDP
+    emit(0x69, 5, 2, 20)                   # r5 = ip->frag_off
+    emit(0x57, 5, imm=0xFF3F)              # & htons(0x3fff)
+    emit(0x55, 5, imm=0, label="pass")     # fragment
+    emit(0x69, 5, 2, 34)                   # r5 = udp->source
+    emit(0xdc, 5, imm=16)                  # r5 = be16(r5)
+    emit(0xa5, 5, imm=port_min, label="pass")
+    emit(0x25, 5, imm=port_max, label="pass")
+    emit(0x18, 1, 1, imm=xsks_map_fd)      # r1 = &xsks (pseudo map fd)
+    emit(0x00)
+    emit(0x61, 2, 6, 16)                   # r2 = ctx->rx_queue_index
+    emit(0xb7, 3, imm=XDP_PASS)            # fall back to the stack
+    emit(0x85, imm=BPF_FUNC_REDIRECT_MAP)
+    emit(0x95)                             # exit
+    labels = {"pass": len(program)}
+    emit(0xb7, 0, imm=XDP_PASS)            # pass: r0 = XDP_PASS
+    emit(0x95)
+
+    for index, label in jumps:
+        program[index][3] = labels[label] - index - 1
+
+    return b"".join(_insn(*instruction) for instruction in program)
+
+
+def load_xdp_program(instructions: bytes) -> int:
+    """
+    Load an XDP program
+
+    Args:
+        instructions: eBPF instructions
+
+    Returns:
+        int: Program file descriptor
+    """
+    insns = ctypes.create_string_buffer(instructions, len(instructions))
+    license = ctypes.create_string_buffer(b"GPL")
+    log = ctypes.create_string_buffer(65536)
+    attr = struct.pack(
+        "<IIQQIIQII16s",
+        BPF_PROG_TYPE_XDP,
+        len(instructions) // 8,
+        ctypes.addressof(insns),
+        ctypes.addressof(license),
+        1,
+        len(log),
+        ctypes.addressof(log),
+        0,
+        0,
+        b"rtp_steer"
+    )
+    try:
+        return _bpf(BPF_PROG_LOAD, attr)
+    except OSError as e:
+        raise OSError(e.errno, f"{e.strerror}\n{log.value.decode(errors='replace')}")
+
+
+def create_xsks_map(entries: int) -> int:
+    """Create an XSKMAP indexed by RX queue"""
+    return _bpf(BPF_MAP_CREATE, struct.pack("<IIIII", BPF_MAP_TYPE_XSKMAP, 4, 4, entries, 0))
+
+
+def update_map(map_fd: int, key: int, value: int):
+    """Set a u32 -> u32 map entry"""
+    key_buffer = ctypes.c_uint32(key)
+    value_buffer = ctypes.c_uint32(value)
+    _bpf(BPF_MAP_UPDATE_ELEM, struct.pack(
+        "<IIQQQ", map_fd, 0, ctypes.addressof(key_buffer), ctypes.addressof(value_buffer), 0
+    ))
+
+
+def attach_xdp(prog_fd: int, ifindex: int, native: bool = False) -> int:
+    """
+    Attach an XDP program through a BPF link; it detaches when the link fd closes
+
+    Args:
+        prog_fd: Program file descriptor
+        ifindex: Interface index
+        native: Driver mode instead of generic (skb) mode
+
+    Returns:
+        int: Link file descriptor
+    """
+    flags = XDP_FLAGS_DRV_MODE if native else XDP_FLAGS_SKB_MODE
+    return _bpf(BPF_LINK_CREATE, struct.pack("<IIII", prog_fd, ifindex, BPF_XDP, flags))
+
+
+class _Ring:
+    """
+    Single-producer/single-consumer ring shared with the kernel
+
+    Index loads and stores are single aligned 32-bit accesses on the mmap
+    with no explicit barriers. The kernel pairs them with acquire/release,
+    and x86-64 never reorders a store with an earlier store or a load with
+    an earlier load, so descriptors are visible before the producer index
+    that publishes them and read only after it. Weakly ordered CPUs
+    (arm64) would need dmb barriers Python cannot issue, so XdpSocket
+    refuses to run there.
+    """
+
+    def __init__(self, memory: mmap.mmap, offsets: Tuple[int, int, int], size: int, desc_size: int):
+        self.memory = memory
+        self.producer_off, self.consumer_off, self.desc_off = offsets
+        self.size = size
+        self.mask = size - 1
+        self.desc_size = desc_size
+
+    @property
+    def producer(self) -> int:
+        return struct.unpack_from("<I", self.memory, self.producer_off)[0]
+
+    @producer.setter
+    def producer(self, value: int):
+        struct.pack_into("<I", self.memory, self.producer_off, value & 0xFFFFFFFF)
+
+    @property
+    def consumer(self) -> int:
+        return struct.unpack_from("<I", self.memory, self.consumer_off)[0]
+
+    @consumer.setter
+    def consumer(self, value: int):
+        struct.pack_into("<I", self.memory, self.consumer_off, value & 0xFFFFFFFF)
+
+    def desc_offset(self, index: int) -> int:
+        return self.desc_off + (index & self.mask) * self.desc_size
+
+
+class XdpSocket:
+    """
+    AF_XDP socket with its own UMEM, receive only
+    """
+
+    def __init__(self, ifindex: int, queue_id: int = 0, frame_count: int = 4096,
+                 frame_size: int = 2048, ring_size: int = 2048, copy_mode: bool = True):
+        """
+        Create, register and bind an AF_XDP socket
+
+        Args:
+            ifindex: Interface index
+            queue_id: RX queue to bind to
+            frame_count: UMEM frames (packet arena slots)
+            frame_size: Bytes per frame, power of two
+            ring_size: Fill/RX ring entries, power of two
+            copy_mode: Force copy mode (required for generic XDP)
+        """
+        if platform.machine() not in SUPPORTED_MACHINES:
+            raise OSError(f"AF_XDP ingest needs x86-64 memory ordering, not {platform.machine()}")
+
+        self.ifindex = ifindex
+        self.queue_id = queue_id
+        self.frame_size = frame_size
+        self.frame_count = frame_count
+
+        self.sock = socket.socket(AF_XDP, socket.SOCK_RAW, 0)
+        fd = self.sock.fileno()
+
+        # UMEM: page-aligned anonymous memory shared with the kernel
+        self.umem = mmap.mmap(-1, frame_count * frame_size, flags=mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS)
+        self._umem_anchor = ctypes.c_char.from_buffer(self.umem)
+        umem_addr = ctypes.addressof(self._umem_anchor)
+        self.sock.setsockopt(SOL_XDP, XDP_UMEM_REG, struct.pack(
+            "<QQIIII", umem_addr, frame_count * frame_size, frame_size, 0, 0, 0
+        ))
+
+        self.sock.setsockopt(SOL_XDP, XDP_UMEM_FILL_RING, ring_size)
+        self.sock.setsockopt(SOL_XDP, XDP_UMEM_COMPLETION_RING, ring_size)
+        self.sock.setsockopt(SOL_XDP, XDP_RX_RING, ring_size)
+
+        offsets = struct.unpack("<16Q", self.sock.getsockopt(SOL_XDP, XDP_MMAP_OFFSETS, 128))
+        rx_off, fill_off = offsets[0:3], offsets[8:11]
+
+        self._rx_map = mmap.mmap(fd, rx_off[2] + ring_size * 16, mmap.MAP_SHARED,
+                                 mmap.PROT_READ | mmap.PROT_WRITE, offset=XDP_PGOFF_RX_RING)
+        self._fill_map = mmap.mmap(fd, fill_off[2] + ring_size * 8, mmap.MAP_SHARED,
+                                   mmap.PROT_READ | mmap.PROT_WRITE, offset=XDP_UMEM_PGOFF_FILL_RING)
+        self.rx = _Ring(self._rx_map, rx_off, ring_size, 16)
+        self.fill = _Ring(self._fill_map, fill_off, ring_size, 8)
+
+        sockaddr = struct.pack("<HHIII", AF_XDP, XDP_COPY if copy_mode else 0, ifindex, queue_id, 0)
+        if _libc.bind(fd, ctypes.c_char_p(sockaddr), len(sockaddr)) != 0:
+            errno = ctypes.get_errno()
+            self.close()
+            raise OSError(errno, f"AF_XDP bind failed: {os.strerror(errno)}")
+
+        # Frames not currently owned by the kernel
+        self.free_frames = collections.deque(range(0, frame_count * frame_size, frame_size))
+        self.refill()
+
+    def fileno(self) -> int:
+        return self.sock.fileno()
+
+    def refill(self):
+        """Hand free frames to the kernel through the fill ring"""
+        producer = self.fill.producer
+        room = self.fill.size - (producer - self.fill.consumer) % 0x100000000
+        count = min(room, len(self.free_frames))
+        for index in range(count):
+            struct.pack_into("<Q", self._fill_map, self.fill.desc_offset(producer + index), self.free_frames.popleft())
+        if count:
+            self.fill.producer = producer + count
+
+    def receive(self, limit: int = 64):
+        """
+        Take received descriptors off the RX ring
+
+        Args:
+            limit: Maximum packets to take
+
+        Returns:
+            list: (frame address, data offset, length) per packet
+        """
+        consumer = self.rx.consumer
+        available = (self.rx.producer - consumer) % 0x100000000
+        packets = []
+        for index in range(min(available, limit)):
+            addr, length = struct.unpack_from("<QI", self._rx_map, self.rx.desc_offset(consumer + index))
+            frame = addr & ~(self.frame_size - 1)
+            packets.append((frame, addr, length))
+        if packets:
+            self.rx.consumer = consumer + len(packets)
+        return packets
+
+    def statistics(self) -> dict:
+        """Kernel-side drop counters"""
+        names = ("rx_dropped", "rx_invalid_descs", "tx_invalid_descs", "rx_ring_full",
+                 "rx_fill_ring_empty_descs", "tx_ring_empty_descs")
+        try:
+            values = struct.unpack("<6Q", self.sock.getsockopt(SOL_XDP, XDP_STATISTICS, 48))
+            return dict(zip(names, values))
+        except OSError:
+            return {}
+
+    def close(self):
+        """Unmap the rings, close the socket and free the UMEM"""
+        for memory in (getattr(self, "_rx_map", None), getattr(self, "_fill_map", None)):
+            if memory:
+                memory.close()
+        # The kernel drops its UMEM reference with the socket
+        self.sock.close()
+        # The ctypes anchor is an export of the mmap; close() refuses while it lives
+        self._umem_anchor = None
+        self.umem.close()
+
+
+class XdpPacketSource:
+    """
+    Shared AF_XDP ingest for all native receivers of a process.
+
+    A polling thread drains the RX ring and hands each packet, still in its
+    UMEM frame, to the receiver registered for the packet's source address
+    on the event loop. The frame returns to the fill ring once that
+    callback has returned, so callbacks must copy anything they keep.
+    Each RX ring poll is handed to the loop as one batch, so the loop is
+    woken once per poll rather than once per packet.
+    """
+
+    def __init__(self, interface: str, queue_id: int = 0, port_min: int = 10000,
+                 port_max: int = 10100, native: bool = False):
+        """
+        Initialize AF_XDP packet source
+
+        Args:
+            interface: Network interface receiving the PlainTransport traffic
+            queue_id: RX queue to bind
+            port_min: Lowest PlainTransport port (UDP source port)
+            port_max: Highest PlainTransport port
+            native: Attach in driver mode instead of generic mode
+        """
+        self.interface = interface
+        self.queue_id = queue_id
+        self.port_min = port_min
+        self.port_max = port_max
+        self.native = native
+
+        self.xsk: Optional[XdpSocket] = None
+        self.loop: Optional[asyncio.AbstractEventLoop] = None
+        self.thread: Optional[threading.Thread] = None
+        self.running = False
+
+        self.routes: Dict[Tuple[str, int], Callable] = {}
+        self._recycled = collections.deque()
+        # Batches queued on the loop and not yet delivered; they hold UMEM views
+        self._in_flight = collections.deque()
+        self._fds = []
+
+        self.stats = {
+            "packets": 0,
+            "unrouted": 0,
+            "batches": 0
+        }
+
+    def start(self, loop: Optional[asyncio.AbstractEventLoop] = None) -> bool:
+        """
+        Load the steering program, bind the socket and start polling
+
+        Returns:
+            bool: True if AF_XDP ingest is running
+        """
+        try:
+            self.loop = loop or asyncio.get_running_loop()
+            ifindex = socket.if_nametoindex(self.interface)
+
+            self.xsk = XdpSocket(ifindex, self.queue_id, copy_mode=not self.native)
+            map_fd = create_xsks_map(max(64, self.queue_id + 1))
+            update_map(map_fd, self.queue_id, self.xsk.fileno())
+            prog_fd = load_xdp_program(build_steering_program(map_fd, self.port_min, self.port_max))
+            link_fd = attach_xdp(prog_fd, ifindex, self.native)
+            self._fds = [link_fd, prog_fd, map_fd]
+
+            self.running = True
+            self.thread = threading.Thread(target=self._poll_loop, name=f"xdp-{self.interface}", daemon=True)
+            self.thread.start()
+
+            logger.info(
+                f"✅ AF_XDP ingest on {self.interface} queue {self.queue_id} "
+                f"for source ports {self.port_min}-{self.port_max} ({'native' if self.native else 'generic'} mode)"
+            )
+            return True
+
+        except Exception as e:
+            logger.error(f"Failed to start AF_XDP ingest on {self.interface}: {e}")
+            self.stop()
+            return False
+
+    def register(self, remote: Tuple[str, int], callback: Callable):
+        """
+        Route packets from a PlainTransport tuple to a receiver
+
+        Args:
+            remote: (ip, port) of the PlainTransport
+            callback: Called on the event loop with (data, remote)
+        """
+        self.routes[remote] = callback
+
+    def unregister(self, remote: Tuple[str, int]):
+        """Stop routing packets from a PlainTransport tuple"""
+        self.routes.pop(remote, None)
+
+    def _poll_loop(self):
+        poller = select.poll()
+        poller.register(self.xsk.fileno(), select.POLLIN)
+        view = memoryview(self.xsk.umem)
+
+        try:
+            while self.running:
+                self._return_frames()
+                packets = self.xsk.receive()
+                if not packets:
+                    poller.poll(100)
+                    continue
+
+                self.stats["batches"] += 1
+                batch = []
+                for frame, addr, length in packets:
+                    self.stats["packets"] += 1
+                    if length < ETH_IPV4_UDP_HEADERS:
+                        self.xsk.free_frames.append(frame)
+                        continue
+
+                    headers = view[addr:addr + ETH_IPV4_UDP_HEADERS]
+                    remote = (socket.inet_ntoa(headers[26:30]), struct.unpack_from("!H", headers, 34)[0])
+                    headers.release()
+                    callback = self.routes.get(remote)
+                    if callback is None:
+                        self.stats["unrouted"] += 1
+                        self.xsk.free_frames.append(frame)
+                        continue
+
+                    batch.append((callback, frame, view[addr + ETH_IPV4_UDP_HEADERS:addr + length], remote))
+
+                if batch:
+                    self._in_flight.append(batch)
+                    self.loop.call_soon_threadsafe(self._deliver_batch, batch)
+        finally:
+            view.release()
+
+    def _deliver_batch(self, batch: list):
+        """Deliver one poll's packets on the event loop"""
+        try:
+            self._in_flight.remove(batch)
+        except ValueError:
+            return  # released by stop()
+        for callback, frame, payload, remote in batch:
+            self._deliver(callback, frame, payload, remote)
+
+    def _deliver(self, callback: Callable, frame: int, payload: memoryview, remote: Tuple[str, int]):
+        try:
+            callback(payload, remote)
+        except Exception as e:
+            logger.error(f"Error handling AF_XDP packet from {remote}: {e}")
+        finally:
+            payload.release()
+            self._recycled.append(frame)
+
+    def _return_frames(self):
+        while self._recycled:
+            self.xsk.free_frames.append(self._recycled.popleft())
+        self.xsk.refill()
+
+    def get_stats(self) -> dict:
+        """Get ingest statistics"""
+        return {
+            **self.stats,
+            "routes": len(self.routes),
+            "kernel": self.xsk.statistics() if self.xsk else {}
+        }
+
+    def stop(self):
+        """Detach the program and close the socket"""
+        self.running = False
+        if self.thread:
+            self.thread.join(timeout=1.0)
+            self.thread = None
+
+        # Undelivered packets still view the UMEM, which cannot be freed under them
+        while self._in_flight:
+            for _, _, payload, _ in self._in_flight.popleft():
+                payload.release()
+
+        for fd in self._fds:
+            os.close(fd)
+        self._fds = []
+
+        if self.xsk:
+            self.xsk.close()
+            self.xsk = None
@@ -4,19 +4,47 @@ Integration Tests for NDI Bridge
 
 import pytest
 import asyncio
+import cv2
 import numpy as np
 from unittest.mock import Mock, AsyncMock, patch
 import sys
 import os
+import socket
+import struct
+import threading
+import time
 
 # Add src to path
 sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
 
-from services.stream_manager import StreamManager
-from ndi.sender import NDISender
+from services.stream_manager import StreamManager, create_stream_manager
+from ndi.sender import NDISender, ndi_frame_rate
+from ndi.converter import NDIConverter
 from webrtc.consumer import WebRTCConsumer
 from processing.pipeline import StreamPipeline
+from processing.band_pipeline import BandConverter
+from processing.denoise import TemporalDenoiser
+from processing.frame_rate import FrameRateConverter
+from processing.scheduler import DeadlineMissed, DeadlineScheduler
+from processing.house_clock import HouseClock
+from processing.asrc import AudioClockConverter, DriftEstimator, PolyphaseResampler
+from processing.keyer import ChromaKeyer
+from processing.lut3d import ColorStatistics, LUT3D
+from processing.overlay import NameStrap, Overlay, OverlayLayer
 from config.settings import Settings
+from services.admission import AdmissionController, AdmissionDecision, OutputProfile
+from services.supervisor import StreamSupervisor, WorkerHandle, split_core_groups
+from sources.clip_source import ClipSource, open_clip
+from sources.return_feed import ReturnFeed
+from webrtc.layer_selector import LayerSelector, parse_scalability_mode
+from webrtc.congestion import BitrateController
+from webrtc.native_receiver import NativeRTPReceiver, ReceptionStats
+from webrtc.rtp_packet import RtpPacket, build_empty_receiver_report, build_pli, build_remb, is_keyframe_request, is_rtcp
+from webrtc.fec import FecDecoder, decapsulate_red
+from webrtc.gop_cache import GopCache, is_keyframe_start
+from webrtc.xdp_socket import XdpPacketSource, build_steering_program
+from webrtc.rtp_socket import BusyPollReader, open_rtp_socket, receive_datagram
+from webrtc.whip import whip_device_name
 
 
 class TestNDISender:
@@ -51,6 +79,14 @@ class TestNDISender:
         assert stats["source_name"] == "TestSource"
         assert stats["is_initialized"] == False
         assert stats["frame_count"] == 0
+    
+    def test_ndi_frame_rates(self):
+        """Test NTSC rates are sent as N/1001 and others as integer rates"""
+        assert ndi_frame_rate(23.976) == (24000, 1001)
+        assert ndi_frame_rate(29.97) == (30000, 1001)
+        assert ndi_frame_rate(59.94) == (60000, 1001)
+        assert ndi_frame_rate(25) == (25, 1)
+        assert ndi_frame_rate(60.0) == (60, 1)
 
 
 class TestStreamPipeline:
@@ -114,6 +150,448 @@ class TestStreamPipeline:
         assert stats["queue_size"] == 0
 
 
+class TestBandConverter:
+    """Test row-banded scaling and conversion"""
+    
+    def test_matches_full_frame_resize(self):
+        """Test stitched bands equal a full-frame resize for down- and upscaling"""
+        source = np.random.randint(0, 255, (360, 640, 3), dtype=np.uint8)
+        for width, height, interpolation in [(320, 180, cv2.INTER_AREA), (1280, 720, cv2.INTER_LINEAR), (640, 360, cv2.INTER_AREA)]:
+            expected = cv2.cvtColor(cv2.resize(source, (width, height), interpolation=interpolation), cv2.COLOR_BGR2BGRA)
+            assert np.array_equal(BandConverter(bands=6, interpolation=interpolation).convert(source, width, height), expected)
+    
+    def test_bands_start_as_rows_arrive(self):
+        """Test a band is scheduled only once the source rows it needs are decoded"""
+        converter = BandConverter(bands=4)
+        source = np.zeros((720, 1280, 3), dtype=np.uint8)
+        converter.begin_frame(source.shape, 640, 360)
+        
+        converter.rows_ready(source, 100)
+        assert len(converter._futures) == 0
+        converter.rows_ready(source, 360)
+        assert len(converter._futures) == 1
+        assert converter.finish().shape == (360, 640, 4)
+        assert len(converter._futures) == 4
+    
+    def test_4k_frames_use_every_worker(self):
+        """Test 4K frames split into at least one band per worker and BGRA passes through"""
+        converter = BandConverter(bands=2, scheduler=DeadlineScheduler(workers=6))
+        source = np.zeros((2160, 3840, 3), dtype=np.uint8)
+        assert converter.convert(source, 3840, 2160).shape == (2160, 3840, 4)
+        assert len(converter._band_plan) >= 6
+        
+        bgra = np.zeros((2160, 3840, 4), dtype=np.uint8)
+        assert converter.convert(bgra, 3840, 2160) is bgra
+        converter.scheduler.shutdown()
+    
+    def test_temporal_denoise_in_band_pass(self):
+        """Test banded denoising matches a full-frame pass, removes noise and keeps motion"""
+        rng = np.random.default_rng(1)
+        clean = np.tile(np.linspace(40, 200, 320).astype(np.uint8), (240, 1))
+        clean = np.dstack([clean, clean, clean, np.full_like(clean, 255)])
+        banded, full = TemporalDenoiser(), TemporalDenoiser()
+        converter = BandConverter(bands=5)
+        for _ in range(8):
+            noise = rng.normal(0, 3, clean.shape).astype(np.int16)
+            noise[..., 3] = 0
+            noisy = np.clip(clean + noise, 0, 255).astype(np.uint8)
+            out = converter.convert(noisy, 320, 240, denoiser=banded)
+            assert np.array_equal(out, full.apply(noisy))
+        error = lambda frame: np.std(frame[..., :3].astype(int) - clean[..., :3])
+        assert error(out) < 0.7 * error(noisy)
+        assert np.all(out[..., 3] == 255)
+        
+        # A large change is motion and passes straight through
+        moved = np.roll(clean, 100, axis=1)
+        assert np.abs(converter.convert(moved, 320, 240, denoiser=banded).astype(int) - moved).max() <= 1
+    
+    def test_denoise_dropped_band_not_used_as_history(self):
+        """Test rows whose first band was dropped are primed by the next frame, not filtered against garbage"""
+        denoiser = TemporalDenoiser()
+        frame = np.full((40, 16, 4), 200, dtype=np.uint8)
+        out = np.empty_like(frame)
+        assert not denoiser.prepare(frame.shape)
+        denoiser.apply_rows(frame[:20], out[:20], 0, 20, fresh=True)  # rows 20-40 dropped
+        
+        assert denoiser.prepare(frame.shape)
+        denoiser.apply_rows(frame[20:], out[20:], 20, 40)
+        assert np.array_equal(out[20:], frame[20:])
+
+    
+    def test_late_band_settles_frame_before_next(self):
+        """Test no band of a dropped frame is still queued or running once finish raises"""
+        scheduler = DeadlineScheduler(workers=2)
+        converter = BandConverter(bands=6, scheduler=scheduler)
+        ran = []
+        
+        def convert_band(source, index):
+            if index == 0:
+                raise DeadlineMissed("late")
+            time.sleep(0.05)
+            ran.append(index)
+        
+        frame = np.zeros((120, 160, 3), dtype=np.uint8)
+        with patch.object(converter, "_convert_band", side_effect=convert_band):
+            with pytest.raises(DeadlineMissed):
+                asyncio.run(converter.convert_async(frame, 160, 120))
+            assert all(future.done() for future in converter._futures)
+            settled = list(ran)
+            time.sleep(0.15)
+        assert ran == settled and len(ran) < 5
+        scheduler.shutdown()
+
+class TestDeadlineScheduler:
+    """Test earliest-deadline-first frame scheduling"""
+    
+    def test_nearest_deadline_runs_first(self):
+        """Test queued work runs in deadline order, not submission order"""
+        scheduler = DeadlineScheduler(workers=1)
+        gate = threading.Event()
+        order = []
+        blocker = scheduler.submit(gate.wait)
+        now = time.monotonic()
+        futures = [
+            scheduler.submit(order.append, name, deadline=now + offset)
+            for name, offset in [("4k", 0.5), ("720p-a", 0.1), ("720p-b", 0.2)]
+        ]
+        gate.set()
+        for future in [blocker] + futures:
+            future.result(timeout=1)
+        assert order == ["720p-a", "720p-b", "4k"]
+        scheduler.shutdown()
+    
+    def test_late_work_dropped(self):
+        """Test work that cannot make its deadline is dropped before it runs"""
+        scheduler = DeadlineScheduler(workers=1)
+        ran = []
+        late = scheduler.submit(ran.append, "late", deadline=time.monotonic() - 0.01)
+        with pytest.raises(DeadlineMissed):
+            late.result(timeout=1)
+        assert scheduler.submit(ran.append, "open").result(timeout=1) is None
+        assert ran == ["open"]
+        assert scheduler.get_stats()["dropped_late"] == 1
+        scheduler.shutdown()
+
+
+class TestHouseClock:
+    """Test the shared house clock"""
+    
+    def test_tick_grid_is_epoch_aligned(self):
+        """Test independent clocks agree on tick instants"""
+        first = HouseClock(fps=25.0, phase_ms=10.0)
+        second = HouseClock(fps=25.0, phase_ms=10.0)
+        index, tick = first.next_tick(now=1000.015)
+        assert (index, tick) == second.next_tick(now=1000.049)
+        assert tick == pytest.approx(1000.05)
+        assert first.next_tick(now=tick)[0] == index + 1
+    
+    @pytest.mark.asyncio
+    async def test_pipelines_send_on_shared_tick(self):
+        """Test every pipeline submits its frame on the same tick, repeating when idle"""
+        clock = HouseClock(fps=50.0)
+        senders = [Mock(send_frame=AsyncMock(return_value=True)) for _ in range(2)]
+        pipelines = [StreamPipeline(f"s{i}", sender) for i, sender in enumerate(senders)]
+        frame = np.zeros((4, 4, 4), dtype=np.uint8)
+        for pipeline in pipelines:
+            pipeline.house_clock = clock
+            pipeline.pending_frame = frame
+            pipeline.clock_subscription = clock.subscribe(pipeline._on_tick)
+        
+        await asyncio.sleep(0.1)
+        for pipeline in pipelines:
+            clock.unsubscribe(pipeline.clock_subscription)
+        
+        timecodes = [[call.kwargs["timecode"] for call in sender.send_frame.call_args_list] for sender in senders]
+        common = min(len(timecodes[0]), len(timecodes[1]))
+        assert common >= 2
+        assert timecodes[0][:common] == timecodes[1][:common]
+        assert pipelines[0].stats["frames_repeated"] >= 1
+        assert clock.task is None
+    
+    def test_blend_conversion_30_to_25(self):
+        """Test 30 fps converted to 25 fps moves evenly instead of judder, blending in bands"""
+        converter = FrameRateConverter(output_fps=25.0)
+        scheduler = DeadlineScheduler(workers=2)
+        start, pushed, levels = 1000.0, 0, []
+        for tick in range(40):
+            tick_time = start + tick / 25.0
+            while start + pushed / 30.0 <= tick_time:
+                converter.push(np.full((8, 8, 4), pushed * 5, dtype=np.uint8), start + pushed / 30.0)
+                pushed += 1
+            levels.append(int(asyncio.run(converter.render(tick_time, scheduler, bands=2))[0, 0, 0]))
+        scheduler.shutdown()
+        
+        # Source moves 5 levels per 1/30 s, so 6 per output frame; repeat would step 5,5,5,5,10
+        steps = np.diff(levels[5:])
+        assert steps.min() >= 5 and steps.max() <= 7
+        assert converter.stats["frames_blended"] > converter.stats["frames_copied"]
+
+
+class TestAudioClockConversion:
+    """Test drift-compensating audio resampling"""
+    
+    def test_resampler_is_transparent(self):
+        """Test a tone survives resampling at a drift ratio with high SNR"""
+        ratio = 1.0007
+        tone = np.sin(2 * np.pi * 997 * np.arange(48000) / 48000).astype(np.float32)[:, None]
+        resampler = PolyphaseResampler(channels=1)
+        resampler.write(tone)
+        output = resampler.read(40000, ratio)[1000:39000, 0]
+        
+        phase = 2 * np.pi * 997 * ratio * np.arange(1000, 39000) / 48000
+        basis = np.c_[np.sin(phase), np.cos(phase)]
+        fit = basis @ np.linalg.lstsq(basis, output, rcond=None)[0]
+        snr = 10 * np.log10(fit.var() / (output - fit).var())
+        assert snr > 80
+    
+    def test_drift_estimated_through_jitter(self):
+        """Test the sender clock offset is recovered from jittery arrivals"""
+        rng = np.random.default_rng(1)
+        estimator = DriftEstimator(48000)
+        for sample in range(0, 48000 * 30, 960):
+            estimator.observe(sample, sample / 48000 / (1 + 80e-6) + rng.exponential(0.005))
+        assert estimator.ready
+        assert abs(estimator.ppm - 80) < 10
+    
+    def test_buffer_level_held_against_drift(self):
+        """Test a fast phone clock neither underruns nor grows the buffer"""
+        rng = np.random.default_rng(2)
+        converter = AudioClockConverter(channels=1, target_ms=40.0)
+        rate = 48000 * (1 + 200e-6)
+        packet, sent, now, levels = 960, 0, 0.0, []
+        while now < 120:
+            arrival = sent * packet / rate + rng.uniform(0, 0.01)
+            if arrival <= now:
+                converter.observe(sent * packet, arrival)
+                converter.push(np.zeros((packet, 1), dtype=np.float32))
+                sent += 1
+                continue
+            assert len(converter.pull(480)) == 480
+            now += 0.01
+            levels.append(converter.stats["level_ms"])
+        
+        assert converter.stats["underruns"] == 0
+        assert converter.stats["overflows"] == 0
+        assert abs(np.mean(levels[-3000:]) + 10 - 40) < 5  # level before each 10 ms pull
+
+class TestColorLUT:
+    """Test 3D LUT colour correction"""
+
+    def test_cube_lut_tetrahedral_accuracy(self, tmp_path):
+        """Test a .cube LUT of an affine colour transform is reproduced within 1 LSB"""
+        matrix = np.array([[0.7, 0.2, 0.1], [0.1, 0.8, 0.1], [0.05, 0.15, 0.8]])
+        axis = np.linspace(0, 1, 17)
+        b, g, r = np.meshgrid(axis, axis, axis, indexing="ij")
+        entries = np.stack((r, g, b), axis=-1).reshape(-1, 3) @ matrix.T * 0.9 + 0.05
+        cube = tmp_path / "Phone.cube"
+        cube.write_text('TITLE "warm"\nLUT_3D_SIZE 17\n' + "\n".join(" ".join(f"{v:.6f}" for v in row) for row in entries))
+
+        lut = LUT3D.load_cube(str(cube))
+        frame = np.random.default_rng(0).integers(0, 256, (64, 64, 4), dtype=np.uint8)
+        output = lut.apply(frame)
+
+        expected = (frame[..., 2::-1] / 255.0 @ matrix.T * 0.9 + 0.05) * 255
+        assert np.abs(output[..., 2::-1] - expected).max() <= 1.0
+        assert np.array_equal(output[..., 3], frame[..., 3])
+        assert np.abs(LUT3D.identity(33).apply(frame).astype(int) - frame).max() <= 1
+
+    def test_lut_fused_into_bands(self):
+        """Test the banded conversion applies the LUT exactly like a separate pass"""
+        lut = LUT3D(LUT3D.identity(9).table ** 0.8)
+        source = np.random.default_rng(1).integers(0, 256, (360, 640, 3), dtype=np.uint8)
+        converter = BandConverter(bands=4)
+        fused = converter.convert(source, 320, 180, lut=lut)
+        assert np.array_equal(fused, lut.apply(converter.convert(source, 320, 180)))
+
+    def test_auto_match_moves_toward_reference(self):
+        """Test a LUT derived from statistics pulls a colour cast onto the reference"""
+        y, x = np.mgrid[:360, :640]
+        reference = np.stack((60 + x * 120 // 640, 50 + y * 150 // 360, 200 - (x + y) * 120 // 1000), axis=-1).astype(np.uint8)
+        cast = np.clip(reference.astype(int) * [0.85, 1.0, 1.15] + [0, 0, 10], 0, 255).astype(np.uint8)
+
+        stats = {}
+        for name, frame in (("ref", reference), ("cast", cast)):
+            stats[name] = ColorStatistics()
+            for second in range(5):
+                stats[name].update(frame, now=float(second + 1))
+        lut = LUT3D.from_statistics(stats["cast"].mean, stats["cast"].std, stats["ref"].mean, stats["ref"].std)
+
+        before = np.abs(cast.astype(int) - reference).mean()
+        after = np.abs(lut.apply(cast).astype(int) - reference).mean()
+        assert after < before * 0.5
+
+    def test_lut_apply_is_realtime(self):
+        """Test a prepared LUT maps a 720p BGRA frame in place well inside a frame interval"""
+        lut = LUT3D(LUT3D.identity(17).table ** 0.8).prepare()
+        frame = np.random.default_rng(2).integers(0, 256, (720, 1280, 4), dtype=np.uint8)
+        alpha = frame[..., 3].copy()
+
+        timings = []
+        for _ in range(10):
+            started = time.perf_counter()
+            lut.apply(frame, out=frame)
+            timings.append(time.perf_counter() - started)
+        assert min(timings) < 0.020
+        assert np.array_equal(frame[..., 3], alpha)
+
+
+class TestChromaKeyer:
+    """Test chroma keying into a real alpha channel"""
+
+    def test_key_spill_and_bands(self):
+        """Test the screen keys out, the subject stays opaque with spill removed, bands match"""
+        frame = np.empty((240, 320, 3), dtype=np.uint8)
+        frame[:] = (64, 177, 0)                 # green screen (BGR)
+        frame[60:180, 80:240] = (80, 120, 200)  # skin tone
+        frame[170:180, 80:240] = (100, 160, 120)  # green-fringed edge
+        keyer = ChromaKeyer("green")
+
+        keyed = keyer.apply(frame)
+        assert keyed[0, 0, 3] == 0
+        assert keyed[120, 160, 3] == 255
+        assert np.array_equal(keyed[120, 160, :3], frame[120, 160])
+        assert 0 < keyed[59, 160, 3] < 255  # softened edge
+        assert keyed[175, 160, 1] < frame[175, 160, 1]  # spill pulled out of green
+
+        # Keyed per band in the converter, with blur context from the neighbouring bands
+        scheduler = DeadlineScheduler(workers=2)
+        converter = BandConverter(bands=5, scheduler=scheduler)
+        banded = converter.convert(frame, 320, 240, keyer=keyer)
+        assert np.array_equal(banded, keyed)
+        wide = ChromaKeyer("green", edge=20.0)  # blur margin wider than a band
+        assert np.array_equal(converter.convert(frame, 320, 240, keyer=wide), wide.apply(frame))
+        scheduler.shutdown()
+
+    def test_uyva_layout(self):
+        """Test UYVA is a limited-range BT.709 UYVY plane followed by the alpha plane"""
+        frame = np.zeros((4, 8, 4), dtype=np.uint8)
+        frame[..., :3] = 255
+        frame[:, :4, 3] = 0
+        frame[:, 4:, 3] = 200
+        uyva = NDIConverter.bgra_to_uyva(frame)
+
+        uyvy = uyva[:8 * 4 * 2].reshape(4, 8, 2)
+        assert np.all(uyvy[..., 1] == 235)  # white luma
+        assert np.all(np.abs(uyvy[..., 0].astype(int) - 128) <= 1)  # neutral chroma
+        alpha = uyva[8 * 4 * 2:].reshape(4, 8)
+        assert np.all(alpha[:, :4] == 0) and np.all(alpha[:, 4:] == 200)
+
+
+class TestOverlay:
+    """Test logo and name strap compositing"""
+
+    def test_premultiplied_blend_in_dirty_rect_only(self):
+        """Test the blend is premultiplied "over" and only the overlay rectangles change"""
+        logo = np.zeros((40, 80, 4), dtype=np.uint8)
+        logo[10:30, 20:60] = (0, 0, 255, 128)  # half-transparent red, transparent border
+        layer = OverlayLayer(logo, anchor="top-left", scale=0.25, margin=0.0)
+        overlay = Overlay([layer, NameStrap("Phone A")])
+
+        frame = np.full((240, 320, 4), 200, dtype=np.uint8)
+        original = frame.copy()
+        assert overlay.composite(frame) is frame
+
+        x, y, premultiplied, _ = layer.render(320, 240)
+        assert (x, y) == (20, 10)  # cropped to the visible pixels
+        assert premultiplied.shape[:2] == (20, 40)
+        # 200 * (255 - 128) / 255 + premultiplied colour; alpha composites too
+        assert np.array_equal(frame[y + 5, x + 5], [100, 100, 228, 228])
+
+        changed = (frame != original).any(axis=2)
+        assert changed[y:y + 20, x:x + 40].all()
+        changed[y:y + 20, x:x + 40] = False
+        rows, cols = np.nonzero(changed)
+        strap = NameStrap("Phone A").render(320, 240)
+        assert rows.min() >= strap[1] and cols.max() < strap[0] + strap[2].shape[1]
+
+    def test_bgr_frames_and_cached_render(self):
+        """Test 3-channel frames are supported and renders are cached per size"""
+        logo = np.full((10, 10, 4), 255, dtype=np.uint8)
+        layer = OverlayLayer(logo, anchor="bottom-right", scale=0.1, margin=0.0)
+        frame = np.zeros((100, 100, 3), dtype=np.uint8)
+        Overlay([layer]).composite(frame)
+        assert np.all(frame[90:, 90:] == 255) and not frame[:90].any()
+        assert layer.render(100, 100) is layer.render(100, 100)
+
+
+class TestClipSource:
+    """Test memory-mapped clip playout"""
+
+    def test_mapped_formats(self, tmp_path):
+        """Test Y4M and raw clips map to zero-copy frame views in their NDI format"""
+        y4m = tmp_path / "bars.y4m"
+        with open(y4m, "wb") as f:
+            f.write(b"YUV4MPEG2 W8 H4 F25:1 Ip A1:1 C420jpeg\n")
+            for i in range(3):
+                f.write(b"FRAME\n" + bytes([i]) * 48)
+        clip = open_clip(str(y4m))
+        assert (clip.width, clip.height, clip.fps, clip.pixel_format) == (8, 4, 25.0, "I420")
+        assert clip.frame_count == 3 and clip.zero_copy
+        frame = clip.frame(4)  # wraps to frame 1
+        assert frame.size == 48 and np.all(frame == 1) and not frame.flags.writeable
+        del frame
+        clip.close()
+
+        raw = tmp_path / "sting_8x4@50.uyvy"
+        raw.write_bytes(bytes(8 * 4 * 2 * 2))
+        clip = open_clip(str(raw))
+        assert (clip.frame_count, clip.fps, clip.pixel_format) == (2, 50.0, "UYVY")
+        clip.close()
+
+    @pytest.mark.asyncio
+    async def test_loops_on_house_clock_ticks(self, tmp_path):
+        """Test each tick sends the next mapped frame, looping, with the tick timecode"""
+        raw = tmp_path / "count_4x2@25.bgra"
+        raw.write_bytes(b"".join(bytes([i]) * 32 for i in range(3)))
+        sender = Mock(initialize=AsyncMock(return_value=True), send_buffer=AsyncMock(return_value=True))
+        clock = Mock(fps=25.0, subscribe=Mock(return_value=1))
+        with patch("sources.clip_source.NDISender", return_value=sender):
+            source = ClipSource(str(raw), "MobileCam_Clip_count", house_clock=clock)
+            assert await source.start()
+        for tick in range(5):
+            await source._on_tick(tick, 100.0 + tick / 25.0)
+
+        sent = [int(call.args[0][0]) for call in sender.send_buffer.call_args_list]
+        assert sent == [0, 1, 2, 0, 1]
+        assert sender.send_buffer.call_args.kwargs["timecode"] == pytest.approx(100.16)
+        assert source.stats["loops"] == 1
+        await source.stop()
+        sender.close.assert_called_once()
+
+
+class TestReturnFeed:
+    """Test the program return feed's keyframe handling"""
+
+    def test_keyframe_requests(self):
+        """Test PLI and FIR for our SSRC are found in compound RTCP, others ignored"""
+        compound = build_empty_receiver_report(1) + build_pli(1, 0xCAFE)
+        assert is_keyframe_request(compound, 0xCAFE)
+        assert not is_keyframe_request(compound, 0xBEEF)
+        assert not is_keyframe_request(build_remb(1, 500000, [0xCAFE]), 0xCAFE)
+
+        fir = struct.pack("!BBHII", 0x80 | 4, 206, 4, 1, 0) + struct.pack("!IB3x", 0xCAFE, 7)
+        assert is_keyframe_request(fir, 0xCAFE)
+
+    def test_feedback_forces_keyframe(self):
+        """Test a PLI arriving on the feed's socket asks the encoder for a keyframe"""
+        feed = ReturnFeed("Program", "http://localhost:3001")
+        feed.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        feed.sock.bind(("127.0.0.1", 0))
+        feed.sock.setblocking(False)
+        feed._request_keyframe = Mock()
+        sender = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        try:
+            sender.sendto(build_pli(1, feed.ssrc), feed.sock.getsockname())
+            sender.sendto(build_pli(1, feed.ssrc ^ 1), feed.sock.getsockname())
+            time.sleep(0.05)
+            feed._read_feedback()
+        finally:
+            sender.close()
+            feed.sock.close()
+        feed._request_keyframe.assert_called_once()
+        assert feed.stats["keyframe_requests"] == 1
+
+
 class TestWebRTCConsumer:
     """Test WebRTC Consumer functionality"""
     
@@ -164,6 +642,633 @@ class TestStreamManager:
         assert "manager_stats" in stats
         assert "stream_stats" in stats
         assert "total_active_streams" in stats
+    
+    @pytest.mark.asyncio
+    async def test_whip_stream_lifecycle(self):
+        """Test a WHIP stream gets its own NDI output and stops without a mediasoup consumer"""
+        manager = StreamManager("ws://localhost:3001", "TestPrefix")
+        manager.audio_enabled = False
+        manager.webrtc_consumer.stop_stream = AsyncMock()
+        ndi_manager = Mock(initialize=AsyncMock(return_value=True), source_name="TestPrefix_OBS")
+        with patch("services.stream_manager.NDIManager", return_value=ndi_manager) as ndi_class:
+            assert await manager.start_whip_stream("whip-abc", "OBS", 1280, 720)
+        
+        assert ndi_class.call_args.kwargs["source_name"] == "TestPrefix_OBS"
+        assert (ndi_class.call_args.kwargs["width"], ndi_class.call_args.kwargs["height"]) == (1280, 720)
+        assert manager.active_streams["whip-abc"]["whip"]
+        assert await manager.stop_stream("whip-abc")
+        manager.webrtc_consumer.stop_stream.assert_not_called()
+        ndi_manager.close.assert_called_once()
+        assert "whip-abc" not in manager.pipelines
+    
+    @pytest.mark.asyncio
+    async def test_concurrent_starts_reserve_capacity(self):
+        """Test capacity is held while a start awaits the backend and given back when it fails"""
+        admission = AdmissionController(cpu_budget_percent=100, default_stream_cost=6.0, cpu_count=1)
+        manager = StreamManager("http://localhost:3001", admission=admission)
+        gate = asyncio.Event()
+        
+        async def rtp_capabilities():
+            await gate.wait()
+            return {"codecs": []}
+        
+        manager.signaling.request_rtp_capabilities = rtp_capabilities
+        manager.signaling.sio = Mock(call=AsyncMock(return_value={"success": False}))
+        stream = {"resolution": {"width": 640, "height": 360}, "fps": 15}
+        
+        first = asyncio.create_task(manager.start_stream({"id": "a", "producerId": "pa", **stream}))
+        await asyncio.sleep(0)
+        assert "a" in admission.streams
+        assert not await manager.start_stream({"id": "b", "producerId": "pb", **stream})
+        
+        gate.set()
+        assert not await first
+        assert admission.streams == {}
+    
+    def test_whip_device_name(self):
+        """Test WHIP publisher names are sanitized, with a per-session default"""
+        assert whip_device_name("Cam 2 <left>", "0123456789ab") == "Cam 2 left"
+        assert whip_device_name(None, "0123456789ab") == "WHIP_012345"
+        assert whip_device_name("Cam 2", "0123456789ab", taken=["Cam 2"]) == "Cam 2_012345"
+
+    @pytest.mark.asyncio
+    async def test_audio_only_stream_has_no_video_path(self):
+        """Test a mic-only phone gets an audio-only NDI source in small blocks"""
+        manager = StreamManager("http://localhost:3001")
+        manager.signaling.request_rtp_capabilities = AsyncMock(return_value={"codecs": []})
+        manager.signaling.sio = Mock(call=AsyncMock(return_value={"success": True}))
+        manager.webrtc_consumer.receive_audio = AsyncMock(return_value=True)
+        ndi_manager = Mock(initialize=AsyncMock(return_value=True), stop=AsyncMock())
+
+        with patch('services.stream_manager.NDIManager', return_value=ndi_manager) as factory:
+            assert await manager.start_stream({
+                "id": "mic-1", "producerId": "audio-1", "device_name": "Mic", "kind": "audio"
+            })
+
+        assert factory.call_args.kwargs["video"] is False
+        assert manager.active_streams["mic-1"]["audio_only"]
+        assert "mic-1" not in manager.pipelines
+        assert manager.admission.get_stats()["streams"].get("mic-1") is None
+        audio = manager.audio_pipelines["mic-1"]
+        assert audio.block_samples == manager.audio_only_block_samples
+        assert audio.house_clock is None
+        await audio.stop()
+
+class TestAdmissionController:
+    """Test admission control and load shedding"""
+    
+    def test_accepts_within_budget(self):
+        """Test stream accepted as requested when capacity remains"""
+        admission = AdmissionController(cpu_budget_percent=100, default_stream_cost=0.25, cpu_count=2)
+        requested = OutputProfile(1280, 720, 30)
+        
+        decision, profile, shed = admission.evaluate(requested)
+        assert decision == AdmissionDecision.ACCEPT
+        assert profile == requested
+        assert shed == []
+    
+    def test_downgrades_when_budget_tight(self):
+        """Test stream downgraded when requested profile does not fit"""
+        admission = AdmissionController(cpu_budget_percent=100, default_stream_cost=0.25, cpu_count=1)
+        admission.admit("a", OutputProfile(1280, 720, 30), OutputProfile(1280, 720, 30))
+        admission.record_cost("a", 0.8)
+        
+        decision, profile, shed = admission.evaluate(OutputProfile(1280, 720, 30))
+        assert decision == AdmissionDecision.DOWNGRADE
+        assert profile.pixel_rate < OutputProfile(1280, 720, 30).pixel_rate
+        assert admission.estimate_cost(profile) <= admission.remaining_capacity()
+    
+    def test_sheds_lower_priority_streams(self):
+        """Test high-priority stream admitted by lowering low-priority ones"""
+        admission = AdmissionController(cpu_budget_percent=100, default_stream_cost=0.25, cpu_count=1)
+        admission.admit("low", OutputProfile(1920, 1080, 30), OutputProfile(1920, 1080, 30), priority=0)
+        admission.record_cost("low", 1.0)
+        
+        decision, profile, shed = admission.evaluate(OutputProfile(1280, 720, 30), priority=1)
+        assert decision == AdmissionDecision.DOWNGRADE
+        assert shed and shed[0][0] == "low"
+        
+        # Equal priority streams are never lowered for a newcomer
+        decision, _, _ = admission.evaluate(OutputProfile(1280, 720, 30), priority=0)
+        assert decision == AdmissionDecision.REJECT
+    
+    def test_restores_shed_streams(self):
+        """Test lowered streams are raised back once capacity frees up"""
+        admission = AdmissionController(cpu_budget_percent=100, default_stream_cost=0.25, cpu_count=1)
+        requested = OutputProfile(1920, 1080, 30)
+        admission.admit("a", requested, OutputProfile(640, 360, 30))
+        admission.record_cost("a", 0.05)
+        admission.admit("b", requested, requested)
+        admission.record_cost("b", 0.9)
+        assert admission.plan_restoring() == []
+        
+        admission.release("b")
+        plan = dict(admission.plan_restoring())
+        assert plan["a"] == requested
+        for profile in admission._ladder_for(requested):
+            assert admission._next_higher(profile, requested) != profile
+    
+    def test_downgrade_stays_within_requested(self):
+        """Test 1080p60 is lowered to 1080p30, never to the larger 1440p30 step"""
+        admission = AdmissionController(cpu_budget_percent=100, default_stream_cost=0.25, cpu_count=1)
+        requested = OutputProfile(1920, 1080, 60)
+        assert OutputProfile(2560, 1440, 30) not in admission._ladder_for(requested)
+        
+        admission.admit("a", requested, requested)
+        admission.record_cost("a", 0.9)
+        assert admission.plan_shedding(0.1) == [("a", OutputProfile(1920, 1080, 30))]
+        assert admission._next_higher(OutputProfile(1920, 1080, 30), requested) == requested
+    
+    def test_processing_cost_is_cpu_time(self):
+        """Test time spent waiting on the sender is not counted as stream cost"""
+        mock_sender = Mock()
+        mock_sender.width = 1280
+        mock_sender.height = 720
+        
+        async def slow_send(frame):
+            await asyncio.sleep(0.05)
+            return True
+        
+        mock_sender.send_frame = slow_send
+        pipeline = StreamPipeline("test_stream", mock_sender)
+        pipeline._cost_sample = (time.monotonic(), 0.0)
+        frame = np.zeros((720, 1280, 3), dtype=np.uint8)
+        for i in range(4):
+            asyncio.run(pipeline._process_single_frame({
+                "frame": frame, "timestamp": i / 30, "queue_time": 0.0
+            }))
+        
+        pipeline._update_processing_cost(window=0.0)
+        assert pipeline.stats["processing_cost"] < 0.5
+    
+    def test_pipeline_output_profile(self):
+        """Test pipeline decimation and scaling to the admitted profile"""
+        mock_sender = Mock()
+        mock_sender.width = 640
+        mock_sender.height = 360
+        mock_sender.send_frame = AsyncMock(return_value=True)
+        pipeline = StreamPipeline("test_stream", mock_sender)
+        pipeline.set_output_profile(640, 360, 15)
+        
+        frame = np.zeros((720, 1280, 3), dtype=np.uint8)
+        for i in range(4):
+            asyncio.run(pipeline._process_single_frame({
+                "frame": frame, "timestamp": i / 30, "queue_time": 0.0
+            }))
+        
+        assert mock_sender.send_frame.call_count == 2
+        assert pipeline.stats["frames_decimated"] == 2
+        sent = mock_sender.send_frame.call_args[0][0]
+        assert sent.shape[:2] == (360, 640)
+
+
+class TestStreamSupervisor:
+    """Test worker sharding helpers"""
+    
+    def test_split_core_groups(self):
+        """Test cores split into contiguous groups"""
+        assert split_core_groups(3, list(range(8))) == [[0, 1, 2], [3, 4, 5], [6, 7]]
+        assert split_core_groups(4, [0, 1]) == [[0], [1]]
+    
+    def test_worker_effective_load(self):
+        """Test only streams the worker has not reported yet are added at the average cost"""
+        worker = WorkerHandle(worker_id=0, cores=[0, 1])
+        worker.streams = {"a": {"id": "a"}, "b": {"id": "b"}, "c": {"id": "c"}}
+        # "b" is reported but unmeasured: its admission estimate is already in the load
+        worker.stream_costs = {"a": 0.4}
+        worker.reported = {"a", "b"}
+        worker.load = 0.65
+        
+        assert worker.effective_load() == pytest.approx(1.05)
+
+    def test_workers_get_full_manager_setup(self):
+        """Test the shared factory applies the settings workers used to miss"""
+        settings = Settings(rtp_receiver="gstreamer", conversion_bands=6, max_streams=3, audio_enabled=False)
+        manager = create_stream_manager(settings, backend_url="ws://backend", admission=AdmissionController())
+        
+        assert manager.webrtc_consumer.receiver_mode == "gstreamer"
+        assert manager.conversion_bands == 6
+        assert manager.max_streams == 3
+        assert manager.audio_enabled is False
+
+    @staticmethod
+    def _live_worker(supervisor, worker_id, messages=()):
+        # Hosts with fewer cores than workers get fewer groups
+        worker = supervisor.workers.setdefault(worker_id, WorkerHandle(worker_id=worker_id, cores=[worker_id]))
+        worker.process = Mock(is_alive=Mock(return_value=True))
+        worker.conn = Mock()
+        worker.conn.poll.side_effect = [True] * len(messages) + [False]
+        worker.conn.recv.side_effect = list(messages)
+        worker.ready = True
+        return worker
+    
+    @pytest.mark.asyncio
+    async def test_rejected_stream_backs_off(self):
+        """Test a rejected stream is not re-placed on the next sync"""
+        supervisor = StreamSupervisor("ws://localhost:3001", worker_count=2)
+        worker = self._live_worker(supervisor, 0, [{"event": "rejected", "stream_id": "s1"}])
+        worker.streams["s1"] = {"id": "s1"}
+        supervisor.placement["s1"] = 0
+        
+        supervisor._on_worker_message(worker)
+        
+        assert not await supervisor.start_stream({"id": "s1"})
+        assert "s1" not in supervisor.placement
+    
+    @pytest.mark.asyncio
+    async def test_migration_waits_for_stop(self):
+        """Test the target only starts a stream once the source has stopped it"""
+        supervisor = StreamSupervisor("ws://localhost:3001", worker_count=2)
+        source = self._live_worker(supervisor, 0, [{"event": "stopped", "stream_id": "s1"}])
+        target = self._live_worker(supervisor, 1)
+        source.streams["s1"] = {"id": "s1"}
+        supervisor.placement["s1"] = 0
+        
+        migration = asyncio.create_task(supervisor.migrate_stream("s1", 1))
+        await asyncio.sleep(0)
+        assert "s1" not in target.streams
+        
+        supervisor._on_worker_message(source)
+        assert await migration
+        assert "s1" in target.streams
+        assert supervisor.placement["s1"] == 1
+
+
+class TestLayerSelector:
+    """Test simulcast/SVC layer selection"""
+    
+    def test_parse_scalability_mode(self):
+        """Test scalability mode parsing"""
+        assert parse_scalability_mode("L3T3") == (3, 3)
+        assert parse_scalability_mode("S2T1") == (2, 1)
+        assert parse_scalability_mode("L1T3_KEY") == (1, 3)
+        assert parse_scalability_mode(None) == (1, 1)
+    
+    def test_selects_smallest_sufficient_layers(self):
+        """Test a 360p/15fps output picks a low spatial and temporal layer"""
+        selector = LayerSelector(1920, 1080, 30, "L3T3", [
+            {"scaleResolutionDownBy": 4}, {"scaleResolutionDownBy": 2}, {"scaleResolutionDownBy": 1}
+        ])
+        
+        choice = selector.select(640, 360, 15)
+        assert (choice.spatial_layer, choice.temporal_layer) == (1, 1)
+        assert (choice.width, choice.height) == (960, 540)
+        
+        choice = selector.select(480, 270, 30)
+        assert (choice.spatial_layer, choice.temporal_layer) == (0, 2)
+    
+    def test_program_tally_takes_top_layers(self):
+        """Test sources on program always get the top layers"""
+        selector = LayerSelector(1280, 720, 30, "L2T3")
+        
+        choice = selector.select(320, 180, 7.5, on_program=True)
+        assert (choice.spatial_layer, choice.temporal_layer) == (1, 2)
+        assert not LayerSelector(1280, 720, 30, None).has_layers
+
+
+class TestCongestionFeedback:
+    """Test receiver-side loss/jitter tracking and REMB feedback"""
+    
+    def _packet(self, seq, timestamp=0):
+        return RtpPacket(96, seq & 0xFFFF, timestamp, 0x1234, False, b"x" * 100, [])
+    
+    def test_reception_stats_loss_and_wrap(self):
+        """Test loss accounting across a sequence number wrap"""
+        stats = ReceptionStats()
+        for seq in [65533, 65534, 65535, 0, 2, 3]:
+            stats.update(self._packet(seq), 0.0, 112)
+        
+        assert stats.extended_highest_sequence == 0x10000 + 3
+        assert stats.cumulative_lost == 1
+        fraction, fixed = stats.interval_report()
+        assert fraction == pytest.approx(1 / 7)
+        assert fixed == (1 << 8) // 7
+        assert stats.interval_report() == (0.0, 0)
+    
+    def test_controller_loss_jitter_and_cpu(self):
+        """Test the estimate backs off on loss, jitter and CPU overload"""
+        controller = BitrateController(start_bitrate=1_000_000, max_bitrate=2_000_000)
+        
+        assert controller.update(0.0, 5.0, incoming_bitrate=1_000_000) > 1_000_000
+        assert controller.update(0.2, 5.0) < 1_080_000
+        assert controller.last_reason == "loss"
+        
+        before = controller.bitrate
+        controller.update(0.0, 80.0)
+        assert controller.last_reason == "jitter"
+        assert controller.bitrate < before
+        
+        controller.update(0.0, 5.0, incoming_bitrate=800_000, cpu_load=2.0)
+        assert controller.last_reason == "cpu"
+        assert controller.bitrate <= 400_000
+    
+    def test_feedback_sends_rr_and_remb(self):
+        """Test feedback packets carry an RR and a REMB for the media SSRC"""
+        on_bitrate = Mock()
+        receiver = NativeRTPReceiver("test", "127.0.0.1", 20000, on_bitrate=on_bitrate)
+        receiver.sock = Mock()
+        
+        for seq in range(10):
+            receiver._on_datagram(self._packet(seq, seq * 3000).serialize())
+        bitrate = receiver.send_feedback()
+        
+        data = receiver.sock.sendto.call_args[0][0]
+        assert is_rtcp(data)
+        assert data[1] == 201 and data[33] == 206
+        assert data[32:] == build_remb(receiver.ssrc, bitrate, [0x1234])
+        on_bitrate.assert_called_once_with(bitrate)
+        assert receiver.get_stats()["packets_received"] == 10
+    
+    def test_kernel_timestamps_drive_jitter(self):
+        """Test jitter and frame spacing come from kernel arrival times"""
+        receiver = NativeRTPReceiver("test", "127.0.0.1", 20000)
+        receiver.sock = Mock()
+        receiver.decoder = Mock()
+        
+        # Handled in a burst, but the kernel saw a steady 30 fps
+        for seq in range(30):
+            receiver._on_datagram(self._packet(seq, seq * 3000).serialize(), None, 1000.0 + seq / 30)
+        
+        assert receiver.reception.jitter_ms < 0.01
+        assert receiver.get_stats()["timestamp_source"] == "kernel"
+        receiver.send_feedback()
+        assert receiver.get_stats()["frame_interarrival_max_ms"] == pytest.approx(1000 / 30)
+        receiver.decoder.set_latency.assert_called_once_with(20)
+    
+    @pytest.mark.asyncio
+    async def test_resume_drops_replayed_frames(self):
+        """Test the replayed GOP primes the decoder without reaching NDI"""
+        frames = []
+        receiver = NativeRTPReceiver("test", "127.0.0.1", 20000, on_frame=frames.append)
+        receiver.sock = Mock()
+        for seq, timestamp in enumerate((3000, 3000, 6000, 9000)):
+            header = 0x00 if seq == 0 else 0x01
+            packet = RtpPacket(96, seq, timestamp, 1, False, bytes([0x10, header, 0, 0]), [])
+            receiver._on_datagram(packet.serialize(), None, 1000.0 + seq / 30)
+        
+        decoder = Mock()
+        decoder.start = AsyncMock(return_value=True)
+        with patch.object(receiver, "_create_decoder", return_value=decoder):
+            assert await receiver.resume_decoding()
+        assert decoder.push_rtp.call_count == 4
+        
+        receiver._loop = asyncio.get_running_loop()
+        receiver.is_running = True
+        for index in range(4):
+            receiver._on_decoded(index)
+        await asyncio.sleep(0)
+        assert frames == [3]
+        assert receiver.get_stats()["replayed_frames_dropped"] == 3
+    
+    @pytest.mark.asyncio
+    async def test_decoded_frames_reach_pipeline_from_decoder_thread(self):
+        """Test frames decoded on GStreamer's thread are handed to the event loop"""
+        manager = StreamManager("http://localhost:3001")
+        pipeline = Mock(add_frame=AsyncMock())
+        manager.pipelines["test"] = pipeline
+        receiver = NativeRTPReceiver(
+            "test", "127.0.0.1", 20000,
+            on_frame=lambda frame: manager._on_frame_received("test", frame)
+        )
+        receiver._loop = asyncio.get_running_loop()
+        receiver.is_running = True
+        
+        frame = np.zeros((4, 4, 3), dtype=np.uint8)
+        decoder_thread = threading.Thread(target=receiver._on_decoded, args=(frame,))
+        decoder_thread.start()
+        decoder_thread.join()
+        for _ in range(3):
+            await asyncio.sleep(0)
+        
+        assert manager.stats["total_frames_processed"] == 1
+        pipeline.add_frame.assert_awaited_once_with(frame)
+
+
+class TestFecRecovery:
+    """Test RED/ULPFEC/FlexFEC packet recovery"""
+    
+    def _media(self, seq, size):
+        return RtpPacket(100, seq, 1000 + seq * 3000, 0xABCD, seq == 3, bytes(range(size)), [])
+    
+    def _xor_protection(self, packets):
+        """Bit strings XORed the way libwebrtc generates FEC"""
+        flags = bytearray(2)
+        length = timestamp = 0
+        payload = bytearray(max(len(p.serialize()) - 12 for p in packets))
+        for packet in packets:
+            raw = packet.serialize()
+            flags[0] ^= raw[0]
+            flags[1] ^= raw[1]
+            length ^= len(raw) - 12
+            timestamp ^= packet.timestamp
+            for index, value in enumerate(raw[12:]):
+                payload[index] ^= value
+        return bytes(flags), length, timestamp, bytes(payload)
+    
+    def _red(self, packet, block_pt, data):
+        return RtpPacket(99, packet.sequence_number, packet.timestamp, packet.ssrc, packet.marker,
+                         bytes([block_pt]) + data, [])
+    
+    def test_red_ulpfec_recovers_single_loss(self):
+        """Test a packet lost inside a ULPFEC group is rebuilt without retransmission"""
+        media = [self._media(seq, 40 + seq * 7) for seq in range(4)]
+        flags, length, timestamp, payload = self._xor_protection(media)
+        ulpfec = (
+            bytes([flags[0] & 0x3F, flags[1]]) + struct.pack("!HIH", 0, timestamp, length)
+            + struct.pack("!H", len(payload)) + bytes([0xF0, 0x00]) + payload
+        )
+        decoder = FecDecoder(red_pt=99, ulpfec_pt=98)
+        
+        output = []
+        for packet in media:
+            if packet.sequence_number != 2:
+                output += decoder.process(self._red(packet, 100, packet.payload))
+        fec_packet = RtpPacket(99, 4, 0, 0xABCD, False, bytes([98]) + ulpfec, [])
+        recovered = decoder.process(fec_packet)
+        
+        assert [p.sequence_number for p in output] == [0, 1, 3]
+        assert len(recovered) == 1
+        assert recovered[0].serialize() == media[2].serialize()
+        assert decoder.get_stats()["recovered"] == 1
+    
+    def test_flexfec_recovers_and_counts_unrecovered(self):
+        """Test FlexFEC recovery and that double losses are reported unrecovered"""
+        media = [self._media(seq, 30 + seq) for seq in range(4)]
+        flags, length, timestamp, payload = self._xor_protection(media)
+        flexfec = (
+            bytes([flags[0] & 0x3F, flags[1]]) + struct.pack("!HI", length, timestamp)
+            + bytes([1, 0, 0, 0]) + struct.pack("!IH", 0xABCD, 0) + struct.pack("!H", 0x8000 | 0x7800) + payload
+        )
+        decoder = FecDecoder(flexfec_pt=97, recovery_horizon=8)
+        
+        for packet in media[1:]:
+            decoder.process(packet)
+        recovered = decoder.process(RtpPacket(97, 0, 0, 0x5555, False, flexfec, []))
+        assert recovered[0].serialize() == media[0].serialize()
+        
+        # Two losses in one group cannot be rebuilt and expire as unrecovered
+        for seq in [4, 7] + list(range(8, 20)):
+            decoder.process(self._media(seq, 20))
+        assert decoder.get_stats()["unrecovered"] == 2
+    
+    def test_red_blocks_and_parameters(self):
+        """Test RED block parsing and FEC negotiation from RTP parameters"""
+        payload = struct.pack("!I", 0x80000000 | (100 << 24) | (5 << 10) | 2) + bytes([100]) + b"ab" + b"cde"
+        assert decapsulate_red(payload) == [(100, 5, b"ab"), (100, 0, b"cde")]
+        
+        assert FecDecoder.from_rtp_parameters({"codecs": [{"mimeType": "video/VP8", "payloadType": 101}]}) is None
+        decoder = FecDecoder.from_rtp_parameters({"codecs": [
+            {"mimeType": "video/VP8", "payloadType": 101},
+            {"mimeType": "video/red", "payloadType": 99},
+            {"mimeType": "video/ulpfec", "payloadType": 98}
+        ]})
+        assert (decoder.red_pt, decoder.ulpfec_pt, decoder.flexfec_pt) == (99, 98, None)
+
+
+class TestGopCache:
+    """Test GOP caching for instant decoder attach"""
+    
+    def _vp8(self, seq, timestamp, keyframe=False, start=True):
+        # Descriptor with S bit, then a payload header with the P bit
+        descriptor = 0x10 if start else 0x00
+        header = 0x00 if keyframe else 0x01
+        return RtpPacket(96, seq, timestamp, 1, False, bytes([descriptor, header, 0, 0]), [])
+    
+    def test_keyframe_detection(self):
+        """Test keyframe detection for VP8 and H264"""
+        assert is_keyframe_start("VP8", bytes([0x10, 0x00]))
+        assert not is_keyframe_start("VP8", bytes([0x10, 0x01]))
+        assert not is_keyframe_start("VP8", bytes([0x00, 0x00]))
+        # Extended descriptor with a 15-bit picture id
+        assert is_keyframe_start("VP8", bytes([0x90, 0x80, 0x81, 0x02, 0x00]))
+        assert is_keyframe_start("H264", bytes([0x67]))
+        assert is_keyframe_start("H264", bytes([0x7C, 0x85]))
+        assert not is_keyframe_start("H264", bytes([0x7C, 0x05]))
+    
+    def test_attach_replays_gop_then_live(self):
+        """Test a late consumer gets the GOP from the last keyframe on"""
+        cache = GopCache("VP8")
+        cache.add(self._vp8(1, 0))  # before any keyframe, not cached
+        cache.add(self._vp8(2, 3000, keyframe=True))
+        cache.add(self._vp8(3, 3000, start=False))
+        cache.add(self._vp8(4, 6000))
+        
+        received = []
+        subscription = cache.attach(received.append)
+        assert [RtpPacket.parse(p).sequence_number for p in received] == [2, 3, 4]
+        
+        cache.add(self._vp8(5, 9000, keyframe=True))
+        assert len(received) == 4
+        assert cache.snapshot() == [received[-1]]
+        
+        cache.detach(subscription)
+        cache.add(self._vp8(6, 12000))
+        assert len(received) == 4
+    
+    def test_overflow_invalidates_until_keyframe(self):
+        """Test an oversized GOP is dropped rather than replayed partially"""
+        cache = GopCache("VP8", max_bytes=40)
+        cache.add(self._vp8(1, 0, keyframe=True))
+        for seq in range(2, 6):
+            cache.add(self._vp8(seq, seq * 3000))
+        assert cache.snapshot() == []
+        assert cache.get_stats()["overflows"] == 1
+        
+        cache.add(self._vp8(6, 30000, keyframe=True))
+        assert len(cache.snapshot()) == 1
+
+
+class TestXdpIngest:
+    """Test the AF_XDP steering program and frame handling"""
+    
+    def test_steering_program_layout(self):
+        """Test jumps stay inside the program and the port range is baked in"""
+        program = build_steering_program(7, 20000, 20100)
+        insns = [struct.unpack_from("<BBhi", program, offset) for offset in range(0, len(program), 8)]
+        
+        assert insns[-1][0] == 0x95 and insns[-2] == (0xb7, 0, 0, 2)
+        for index, (code, _, off, _) in enumerate(insns):
+            if code & 0x07 == 0x05 and code not in (0x85, 0x95):
+                assert 0 < index + 1 + off < len(insns)
+        assert (0xa5, 5, insns[18][2], 20000) == insns[18]
+        assert (0x25, 5, insns[19][2], 20100) == insns[19]
+        assert insns[20][:2] == (0x18, 0x11) and insns[20][3] == 7
+    
+    def test_frame_recycled_after_delivery(self):
+        """Test UMEM views are released and their frame recycled after the callback"""
+        source = XdpPacketSource("lo")
+        cache = GopCache("VP8")
+        packet = RtpPacket(96, 1, 3000, 1, False, bytes([0x10, 0x00, 0, 0]), [])
+        umem = bytearray(packet.serialize())
+        
+        view = memoryview(umem)
+        source._deliver(lambda data, remote: cache.add(RtpPacket.parse(data), data), 4096, view, ("10.0.0.1", 20000))
+        
+        assert list(source._recycled) == [4096]
+        umem[:] = bytes(len(umem))  # frame reused by the kernel
+        assert RtpPacket.parse(cache.snapshot()[0]).sequence_number == 1
+    
+    def test_batches_delivered_or_released_on_stop(self):
+        """Test a poll's packets arrive in one batch and stop() releases undelivered ones"""
+        source = XdpPacketSource("lo")
+        received = []
+        callback = lambda data, remote: received.append(bytes(data))
+        view = memoryview(bytearray(range(16)))
+        remote = ("10.0.0.1", 10000)
+        
+        batch = [(callback, 0, view[0:4], remote), (callback, 2048, view[4:8], remote)]
+        source._in_flight.append(batch)
+        source._deliver_batch(batch)
+        assert received == [bytes([0, 1, 2, 3]), bytes([4, 5, 6, 7])]
+        assert list(source._recycled) == [0, 2048]
+        
+        pending = [(callback, 4096, view[8:12], remote)]
+        source._in_flight.append(pending)
+        source.stop()
+        source._deliver_batch(pending)
+        assert len(received) == 2
+        with pytest.raises(ValueError):
+            pending[0][2].tobytes()
+
+
+class TestBusyPoll:
+    """Test busy-poll ingest and kernel receive timestamps"""
+    
+    def test_kernel_timestamp(self):
+        """Test datagrams carry a kernel arrival time"""
+        receiver = open_rtp_socket()
+        sender = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        try:
+            sender.sendto(b"rtp", ("127.0.0.1", receiver.getsockname()[1]))
+            time.sleep(0.01)
+            data, _, arrival = receive_datagram(receiver)
+            assert data == b"rtp"
+            assert arrival is not None and 0 <= time.time() - arrival < 1.0
+            with pytest.raises(BlockingIOError):
+                receive_datagram(receiver)
+        finally:
+            receiver.close()
+            sender.close()
+    
+    def test_spin_then_block(self):
+        """Test the reader delivers on its thread and blocks once idle"""
+        reader = BusyPollReader(spin_budget_us=1000)
+        receiver = open_rtp_socket(busy_poll_us=50)
+        sender = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        received = []
+        reader.register(receiver, lambda data, addr, arrival: received.append((data, arrival)))
+        reader.start()
+        try:
+            for i in range(5):
+                sender.sendto(bytes([i]), ("127.0.0.1", receiver.getsockname()[1]))
+            time.sleep(0.05)
+            assert [data for data, _ in received] == [bytes([i]) for i in range(5)]
+            assert all(arrival is not None for _, arrival in received)
+            assert reader.stats["spins"] > 0 and reader.stats["blocks"] > 0
+        finally:
+            reader.stop()
+            receiver.close()
+            sender.close()
 
 
 class TestSettings: